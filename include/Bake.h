@@ -0,0 +1,77 @@
+#include <Arduino.h>
+#include "FileMap.h"
+
+#ifndef _BAKE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _BAKE_TYPES
+
+const uint32_t bakeMagic = 0x454B4142;  // "BAKE" file signature (little-endian)
+const uint16_t bakeVersion = 1;
+const uint8_t bakeMaxRun = 64;          // max pixels per run token
+const uint8_t bakeMinRepeat = 3;        // min identical pixels to use a repeat token instead of literals
+const uint8_t bakeMaxBpp = 4;           // max bytes per pixel
+
+  // run token types, stored in the upper 2 bits of each token byte (lower 6 bits are run length - 1)
+const uint8_t BAKE_LITERAL = 0x00;  // followed by (length * bytesPerPixel) pixel bytes
+const uint8_t BAKE_SKIP = 0x40;     // pixels unchanged from previous frame
+const uint8_t BAKE_REPEAT = 0x80;   // followed by one pixel value, repeated length times
+
+struct bakeHeaderStruct {
+  uint32_t magic;           // bakeMagic
+  uint16_t version;         // bakeVersion
+  uint8_t bytesPerPixel;    // e.g. 3 for RGB
+  uint8_t keyInterval;      // every keyInterval'th frame is encoded against a black frame (for seek)
+  uint32_t numPixels;       // pixels per frame
+  uint32_t numFrames;       // number of frames in the stream
+  uint32_t loopStart;       // first frame of loop
+  uint32_t loopEnd;         // last frame of loop (playback jumps to loopStart after this frame)
+};
+  // file layout: header, frame data, frame offset table (uint32_t per frame, relative to start of file)
+
+class bakeWriterClass {
+  Print *out;             // stream the baked frames are written to
+  uint8_t *prevFrame;     // pointer to dynamically-allocated copy of the previous frame
+  uint32_t *frameOffset;  // pointer to dynamically-allocated frame offset table
+  uint32_t numPixels;
+  uint8_t bpp;            // bytes per pixel
+  uint8_t keyInterval;
+  uint32_t numFrames;     // number of frames declared in begin()
+  uint32_t frameNum;      // number of frames written so far
+  uint32_t bytesWritten;  // current offset in the output stream
+  void writeToken(uint8_t type, uint8_t len, const uint8_t *pix);
+public:
+  bakeWriterClass() { prevFrame = NULL; frameOffset = NULL; out = NULL; }
+  bool begin(Print *stream, uint32_t numPix, uint8_t bytesPerPix, uint32_t frames, uint32_t loopFirst, uint32_t loopLast,
+      uint8_t keyInt);
+  void addFrame(const uint8_t *frame);
+  bool finish();
+};
+
+class bakePlayerClass {
+  const uint8_t *data;          // pointer to memory-mapped (or flash-resident) baked stream
+  const bakeHeaderStruct *hdr;
+  const uint32_t *frameOffset;  // pointer to frame offset table within the stream
+  uint8_t *decodeBuf;           // pointer to dynamically-allocated decoded frame, which is also the previous frame for SKIP tokens
+  uint32_t decodeSize;          // bytes allocated for decodeBuf
+  uint8_t *frameBuf;            // caller's output frame buffer (numPixels * bytesPerPixel)
+  uint32_t curFrame;            // next frame to be decoded
+#ifdef EFFECT_HOST_MMAP
+  fileMapClass mapping;         // file mapping created by load()
+#endif
+  bool decode(uint32_t frame);
+public:
+  bool loop;                    // if true, playback jumps from loopEnd back to loopStart
+  uint32_t lastDecodeUs;        // duration of the most recent frame decode (microseconds)
+  bakePlayerClass() { data = NULL; decodeBuf = NULL; decodeSize = 0; loop = true; lastDecodeUs = 0; }
+  ~bakePlayerClass() { delete [] decodeBuf; }
+  bool init(const uint8_t *bakedData, uint32_t size, uint8_t *outFrame);
+#ifdef EFFECT_HOST_MMAP
+  bool load(const char *path, uint8_t *outFrame);
+#endif
+  bool step();
+  void seek(uint32_t frame);
+  uint32_t frameCount() { return ((data != NULL) ? hdr->numFrames : 0); }
+  uint32_t frame() { return (curFrame); }
+  float bytesPerFrame();
+};
+
+#endif  // _BAKE_TYPES
@@ -0,0 +1,91 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Ramp.h"
+#include "Flow.h"
+#include "Wave.h"
+#include "Wavelet.h"
+#include "Droplet.h"
+#include "Pop.h"
+#include "Wipe.h"
+#include "Flicker.h"
+#include "Wait.h"
+#include "FileMap.h"
+
+#ifndef _CUE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _CUE_TYPES
+
+  // binary cue image (see Cue.cpp and tools/cue_compile.py); all fields are little-endian
+const uint32_t cueMagic = 0x31455543;   // "CUE1"
+const uint16_t cueVersion = 1;
+const uint8_t cueMaxSlots = 32;         // max number of effect slots in a show
+const uint8_t cueMaxParams = 6;
+
+  // cue operations; the start operations also identify the effect class that a slot holds
+enum cueOpEnum {CUE_RAMP, CUE_FLOW, CUE_WAVE, CUE_WAVELET, CUE_DROPLET, CUE_POP, CUE_WIPE, CUE_FLICKER, CUE_WAIT, CUE_STOP, 
+                CUE_NUM_OPS};
+
+struct cueHeaderStruct {
+  uint32_t magic;       // cueMagic
+  uint16_t version;     // cueVersion
+  uint16_t numSlots;
+  uint32_t numCues;
+  uint32_t slotOffset;  // byte offset of the slot type array (uint8_t per slot)
+  uint32_t cueOffset;   // byte offset of the cue array (4-byte aligned)
+  uint32_t imageSize;   // total size of the image (bytes)
+  float stepPeriod;     // step period (seconds) used to convert cue times to step numbers
+  uint32_t reserved;
+};
+
+struct cueStruct {    // 32 bytes
+  uint32_t step;      // step number at which the cue is executed; cues are sorted by step
+  uint8_t op;         // cueOpEnum
+  uint8_t slot;       // effect slot
+  uint8_t numParams;  // selects the start() overload where there is more than one (e.g. rampClass)
+  uint8_t reserved;
+  float param[cueMaxParams];  // start() parameters, in order
+};
+
+class cuePlayerClass {
+  const cueHeaderStruct *header;  // attached image, or NULL
+  const uint8_t *slotType;        // cueOpEnum of the effect class in each slot
+  const cueStruct *cue;
+  effect *slotFx[cueMaxSlots];    // effect bound to each slot
+  uint8_t boundType[cueMaxSlots]; // class of the effect bound to each slot (cueOpEnum), or CUE_NUM_OPS if unbound
+  uint32_t nextCue;     // index of the next cue to execute
+  uint32_t stepNum;     // current step of the show
+  uint32_t skipped;     // number of cues skipped because the slot wasn't bound to an effect of the right class
+  bool playing;
+  renderContextClass *ctx;  // context whose step period must match the image's (the context the slot effects are bound to)
+#ifdef EFFECT_HOST_MMAP
+  fileMapClass mapping; // file mapping created by load()
+#endif
+  void release();
+  bool periodMatches(const cueHeaderStruct *hdr);
+  void bindSlot(uint8_t slot, effect *fx, uint8_t type);
+  void execute(const cueStruct &c);
+public:
+  cuePlayerClass();
+  void bindContext(renderContextClass *context) { ctx = context; }
+  bool attach(const void *image, uint32_t size);
+#ifdef EFFECT_HOST_MMAP
+  bool load(const char *path);
+#endif
+  void bind(uint8_t slot, rampClass &fx) { bindSlot(slot, &fx, CUE_RAMP); }
+  void bind(uint8_t slot, flowClass &fx) { bindSlot(slot, &fx, CUE_FLOW); }
+  void bind(uint8_t slot, waveClass &fx) { bindSlot(slot, &fx, CUE_WAVE); }
+  void bind(uint8_t slot, waveletClass &fx) { bindSlot(slot, &fx, CUE_WAVELET); }
+  void bind(uint8_t slot, dropletClass &fx) { bindSlot(slot, &fx, CUE_DROPLET); }
+  void bind(uint8_t slot, popClass &fx) { bindSlot(slot, &fx, CUE_POP); }
+  void bind(uint8_t slot, wipeClass &fx) { bindSlot(slot, &fx, CUE_WIPE); }
+  void bind(uint8_t slot, flickerClass &fx) { bindSlot(slot, &fx, CUE_FLICKER); }
+  void bind(uint8_t slot, waitClass &fx) { bindSlot(slot, &fx, CUE_WAIT); }
+  uint8_t unboundSlots();
+  bool play();
+  void stop() { playing = false; }
+  void step();
+  bool done() { return (!playing); }
+  uint32_t currentStep() { return (stepNum); }
+  uint32_t skippedCues() { return (skipped); }
+};
+
+#endif  // _CUE_TYPES
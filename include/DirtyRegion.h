@@ -0,0 +1,46 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+
+#ifndef _DIRTY_REGION_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _DIRTY_REGION_TYPES
+
+const uint8_t changeCacheSize = 32;   // max number of effects whose changed() results are held by a changeCacheClass
+
+struct effectChangeStruct {   // result of effect::changed() in the current frame
+  effect *fx;
+  spanKindEnum kind;
+  float spanStart;
+  float spanEnd;
+};
+
+class changeCacheClass {    // changed() results of the current frame, shared by the dirty regions of several strips
+  effectChangeStruct entry[changeCacheSize];
+  uint8_t numEntries;
+public:
+  changeCacheClass() { numEntries = 0; }
+  void clear() { numEntries = 0; }
+  spanKindEnum query(effect &fx, float *spanStart, float *spanEnd);
+};
+
+class dirtyRegionClass {
+  uint16_t numPixels;   // number of pixels in the strip
+  float spacing;        // pixel spacing (mm)
+  float origin;         // position (mm) of pixel 0 in the effect's coordinates
+  uint16_t first;       // first dirty pixel
+  uint16_t last;        // last dirty pixel
+  bool dirty;           // true if any pixel is dirty
+  changeCacheClass *cache;  // shared changed() results (NULL if add() queries the effects directly)
+public:
+  dirtyRegionClass() { numPixels = 0; dirty = false; cache = NULL; }
+  void init(uint16_t numPix, float pixSpacing, float originPos, changeCacheClass *changeCache = NULL);
+  void clear() { dirty = false; }
+  bool add(effect &fx);
+  void addSpan(float spanStart, float spanEnd);
+  void addPixels(uint16_t firstPix, uint16_t lastPix);
+  void addAll() { addPixels(0, numPixels - 1); }
+  bool isDirty() { return (dirty); }
+  uint16_t firstPixel() { return (first); }
+  uint16_t lastPixel() { return (last); }
+};
+
+#endif  // _DIRTY_REGION_TYPES
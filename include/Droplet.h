@@ -21,16 +21,22 @@ class dropletClass : public effect {
   float accelDelta;   // acceleration: increase in deltaDist per step
   float headSlope;    // slope of head ramp (delta-value per mm)
   float tailSlope;    // slope of tail ramp (delta-value per mm)
+  float headRampLen;  // frame-constant terms cached by prepareFrame(): config->headRampLen
+  float headEnd;      //   distance from leading edge to end of head (config->headRampLen + config->headLength)
+  float tailPos;      //   position of the trailing edge of the tail
   bool completedFlag;  // becomes true when flow is completed
   dropletConfigStruct *config;  // pointer to structure containing configuration parameters
+  template <typename> friend struct pipeStage;  // fused per-pixel kernels (see Pipeline.h)
 public:
   float curPos;   // current position of flow leading edge (mm)
   dropletClass() { active = false; completedFlag = false; }
   void init(dropletConfigStruct *cfg) { config = cfg; }
   void start(float dist);
   void step();
+  void prepareFrame();
   float value(float offset);
   bool completed();
+  spanKindEnum changed(float *spanStart, float *spanEnd);
 };
 
 #endif  // _DROPLET_TYPES
@@ -1,23 +1,67 @@
 #include <Arduino.h>
+#include "RenderContext.h"
 
 #ifndef _EFFECT_UTIL_TYPES
 #define _EFFECT_UTIL_TYPES
 
-const float defaultStepPeriod = 0.01;   // default, overridden by call to SetStepPeriod()
+struct rampStepsStruct {    // step counts of a trapezoidal ramp, computed by effect::ComputeRampSteps()
+  uint16_t upSteps;     // steps in ramp-up phase (may be truncated based on total duration)
+  uint16_t holdSteps;   // steps in hold phase (0 specifies an infinite hold)
+  uint16_t downSteps;   // steps in ramp-down phase (may be truncated based on total duration)
+  float upDelta;        // change in value per ramp-up step, based on the non-truncated ramp-up duration
+};
+
+enum spanKindEnum {   // coordinates of the span reported by effect::changed()
+  SPAN_NONE = 0,      // output unchanged; span not meaningful
+  SPAN_LINEAR,        // position (offset) along a strip, e.g. flowClass, dropletClass (also the full span of any effect)
+  SPAN_RADIAL,        // distance from the effect's center, e.g. popClass
+  SPAN_LINE_DIST      // signed distance from the effect's line, e.g. wipeClass
+};
+
+class modulatorClass;       // defined in Modulator.h
+class rampModulatorClass;
+extern const modulatorClass unityModulator;
+
+/*
+  The modulator that scales the output of waveClass, swaveClass and flickerClass (see Modulator.cpp): a bound shared modulator, the
+  ramp allocated by the effect's setRamp(), or unityModulator. Copying the effect gives the copy its own copy of the allocated ramp.
+*/
+class outputRampClass {
+public:
+  const modulatorClass *mod;  // modulator in use: a bound shared modulator, own, or unityModulator
+  rampModulatorClass *own;    // ramp allocated by setRamp() (NULL if setRamp() hasn't been called)
+  outputRampClass() { mod = &unityModulator; own = NULL; }
+  outputRampClass(const outputRampClass &src);
+  outputRampClass &operator=(const outputRampClass &src);
+  ~outputRampClass();
+};
 
 /*
   A "core" class for the entire EffectUtils library, containing common data members and functions to be used by all derived classes
 */
 class effect {
+protected:
+  bool lastActive;            // value of active at the previous call to changed()
+  renderContextClass *ctx;    // context supplying the step period and random numbers
 public:
-  static float stepPeriod;    // duration of each effect step
   bool active;                // true during the specified duration of the effect
   uint16_t stepNum;           // current step number
   uint16_t effectSteps;       // total number of steps in the specified effect duration
+  effect() { lastActive = false; ctx = &defaultContext; }
     // Compute the number of effect steps in the specified duration
   uint16_t ComputeSteps(float duration); 
-    // Set the step period, which will be propagated to all derived classes/objects
-  static void SetStepPeriod(uint32_t periodMs) { stepPeriod = (float) periodMs / 1000; }
+    // Compute the step counts of a trapezoidal ramp (used by rampClass and envelopeBankClass)
+  rampStepsStruct ComputeRampSteps(float duration, float rampUpTime, float rampDownTime);
+    // Set the step period of defaultContext, which is used by all effects that haven't been bound to another context
+  static void SetStepPeriod(uint32_t periodMs) { defaultContext.setStepPeriod(periodMs); }
+    // Bind the effect (and any embedded effects) to a render context; overridden by classes with embedded effects
+  virtual void bindContext(renderContextClass *context) { ctx = context; }
+    // Update the effect for one step period; overridden by each derived class (allows effects to be stepped via an effect pointer)
+  virtual void step() {}
+    // Cache frame-constant terms used by the per-pixel value functions; called by derived classes at the end of start() and step()
+  virtual void prepareFrame() {}
+    // Report whether the effect output changed since the previous call, and over which span (SPAN_NONE if unchanged)
+  virtual spanKindEnum changed(float *spanStart, float *spanEnd);
 };
 
 
@@ -0,0 +1,40 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+
+#ifndef _ENVELOPE_BANK_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _ENVELOPE_BANK_TYPES
+
+const uint32_t envInfinite = 0xFFFFFFFF;  // hold/end step of an envelope with infinite duration
+
+class envelopeBankClass : public effect {
+  uint32_t numEnv;      // number of envelopes in the bank
+  uint32_t bankStep;    // number of steps since init()
+  uint32_t endStep;     // bankStep at which the last finite envelope ends
+  uint32_t nextFree;    // envelope at which startFree() begins its search
+  float rampUpTime;     // default ramp durations (seconds), set by setRamp()
+  float rampDownTime;
+    // per-envelope state (structure of arrays, dynamically allocated); hold and end steps are relative to the start step
+  uint32_t *startStep;  // bankStep at start()
+  uint32_t *holdEnd;    // step at which the hold phase ends (envInfinite for an infinite hold)
+  uint32_t *envEnd;     // step at which the envelope returns to 0 (envInfinite for an infinite hold)
+  float *upBias;        // value at step 0 of the ramp-up (1.0 if there is no ramp-up phase)
+  float *upDelta;       // change in value per ramp-up step
+  float *peak;          // hold value (less than 1.0 if the ramps were truncated)
+  float *downDelta;     // change in value per ramp-down step
+  void freeArrays();
+public:
+  float *val;           // current output value of each envelope (0 - 1)
+  envelopeBankClass() { numEnv = 0; active = false; rampUpTime = 0; rampDownTime = 0; startStep = NULL; holdEnd = NULL; envEnd = NULL;
+                        upBias = NULL; upDelta = NULL; peak = NULL; downDelta = NULL; val = NULL; }
+  ~envelopeBankClass() { freeArrays(); }
+  bool init(uint32_t numEnvelopes);
+  void setRamp(float rampUpDur, float rampDownDur);
+  void start(uint32_t env, float duration);
+  void start(uint32_t env, float duration, float rampUpDur, float rampDownDur);
+  int32_t startFree(float duration);
+  void stop(uint32_t env);
+  bool envActive(uint32_t env) { return ((env < numEnv) && ((bankStep - startStep[env]) < envEnd[env])); }
+  void step();
+};
+
+#endif  // _ENVELOPE_BANK_TYPES
@@ -0,0 +1,34 @@
+#include <Arduino.h>
+#include "ColorUtilsHsi.h"
+#include "EffectUtils.h"
+
+#ifndef _FADE_BANK_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _FADE_BANK_TYPES
+
+const uint16_t fadeNotListed = 0xFFFF;  // listPos[] value of a pixel that isn't in the active list
+
+class fadeBankClass : public effect {
+  hsiF *colors;         // caller's pixel color array, faded in place
+  uint16_t numPixels;
+  uint32_t bankStep;    // number of steps since init()
+  uint16_t numListed;   // number of pixels in activeList
+    // per-pixel fade state (structure of arrays, dynamically allocated)
+  uint32_t *startStep;  // bankStep at which the fade starts (later than the call to start() if a delay was specified)
+  float *invSteps;      // 1 / number of steps in the fade
+  float *startH, *startS, *startI;  // color at the start of the fade
+  float *distH, *distS, *distI;     // total change over the fade (hue distance includes the direction)
+  uint16_t *activeList; // pixels with a fade that is delayed or in progress; only these are written by step()
+  uint16_t *listPos;    // position of each pixel in activeList (fadeNotListed if not listed)
+  void freeArrays();
+public:
+  fadeBankClass() { colors = NULL; numPixels = 0; active = false; startStep = NULL; invSteps = NULL; startH = NULL; startS = NULL;
+                    startI = NULL; distH = NULL; distS = NULL; distI = NULL; activeList = NULL; listPos = NULL; numListed = 0; }
+  ~fadeBankClass() { freeArrays(); }
+  bool init(uint16_t numPix, hsiF *pixColors);
+  void start(uint16_t pixel, float duration, hsiF targetColor, float delay);
+  void start(uint16_t pixel, float duration, hsiF targetColor, float delay, bool useShortestDist, bool positiveDir);
+  void startAll(float duration, hsiF targetColor, float stagger);
+  void step();
+};
+
+#endif  // _FADE_BANK_TYPES
@@ -0,0 +1,23 @@
+#include <Arduino.h>
+
+#ifndef _FILE_MAP_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _FILE_MAP_TYPES
+
+  // File mappings are only available on host builds with POSIX mmap() (define EFFECT_HOST_MMAP); otherwise this module is empty
+#ifdef EFFECT_HOST_MMAP
+
+class fileMapClass {    // read-only memory mapping of a file, shared by the load() functions of the image-based classes
+  void *addr;           // start of the mapping (NULL if nothing is mapped)
+  size_t size;          // size of the mapping (bytes)
+public:
+  fileMapClass() { addr = NULL; size = 0; }
+  ~fileMapClass() { unmap(); }
+  bool map(const char *path, size_t minSize);
+  void unmap();
+  void adopt(fileMapClass &other);
+  const void *data() { return (addr); }
+  uint32_t length() { return ((uint32_t) size); }
+};
+
+#endif  // EFFECT_HOST_MMAP
+#endif  // _FILE_MAP_TYPES
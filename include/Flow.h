@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
+#include "PixelMask.h"
 
 
 #ifndef _FLOW_TYPES  // prevent duplicate type definitions when this file is included in multiple places
@@ -11,13 +12,17 @@ class flowClass : public effect {
   float rampSlope;  // slope of ramp (delta-value per mm)
   float rampWidth; // distance from flow leading edge to top of ramp (mm)
   bool completedFlag;  // becomes true when flow is completed
+  template <typename> friend struct pipeStage;  // fused per-pixel kernels (see Pipeline.h)
 public:
   float curPos;   // current position of flow leading edge (mm)
   flowClass() { active = false; completedFlag = false; }
   void start(float duration, float distance, float rampLen);
   void step();
   float val(float offset);
+  void render(float *out, const float *offset, uint32_t first, uint32_t count);
+  void render(float *out, const float *offset, pixelMaskClass &mask);
   bool completed();
+  spanKindEnum changed(float *spanStart, float *spanEnd);
 };
 
 #endif  // _FLOW_TYPES
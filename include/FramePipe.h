@@ -0,0 +1,79 @@
+#include <Arduino.h>
+#include "RenderContext.h"
+#if __has_include(<OctoWS2811.h>)
+#include <OctoWS2811.h>
+#endif
+
+#ifndef _FRAME_PIPE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _FRAME_PIPE_TYPES
+
+const uint8_t frameMaxBpp = 4;      // max bytes per pixel
+
+class frameSinkClass {    // output stage that transmits a completed frame; derived for each type of LED driver or mock output
+public:
+    // true while the previous frame is still being transmitted (its buffer must not be modified)
+  virtual bool busy() { return (false); }
+    // start transmitting a frame; the buffer remains untouched by the pipeline until busy() returns false
+  virtual void show(const uint8_t *frame, uint32_t numPixels, uint8_t bytesPerPixel) = 0;
+};
+
+class streamSinkClass : public frameSinkClass {   // writes each frame to a Print stream (e.g. a file or socket on a host build)
+  Print *out;
+  uint32_t frameNum;
+public:
+  streamSinkClass() { out = NULL; frameNum = 0; }
+  void init(Print *stream) { out = stream; frameNum = 0; }
+  void show(const uint8_t *frame, uint32_t numPixels, uint8_t bytesPerPixel);
+};
+
+#if __has_include(<OctoWS2811.h>)
+class octoSinkClass : public frameSinkClass {   // OctoWS2811 DMA output; transmission overlaps rendering of the next frame
+  OctoWS2811 *leds;
+  uint8_t *drawMem;     // drawing memory passed to the OctoWS2811 constructor (NULL: frames are copied with setPixel())
+public:
+  octoSinkClass() { leds = NULL; drawMem = NULL; }
+    // octo must already be constructed and begin() called; see octoSinkClass::show() for drawingMemory
+  void init(OctoWS2811 *octo, void *drawingMemory = NULL) { leds = octo; drawMem = (uint8_t *) drawingMemory; }
+  bool busy() { return (leds->busy()); }
+  void show(const uint8_t *frame, uint32_t numPixels, uint8_t bytesPerPixel);
+};
+#endif
+
+struct framePipeStatsStruct {
+  uint32_t frames;        // frames submitted
+  uint32_t lastRenderUs;  // time (us) spent rendering the last frame (from backBuffer() to submit())
+  uint32_t maxRenderUs;
+  uint32_t lastWaitUs;    // time (us) the last submit() waited for the sink to finish the previous frame
+  uint32_t maxWaitUs;
+  uint32_t lastLatencyUs; // time (us) from the start of rendering the last frame to the start of its output
+  uint32_t maxLatencyUs;
+  uint32_t periodUs;      // time (us) between the last two submit() calls
+  uint64_t totalRenderUs;
+  uint64_t totalWaitUs;
+};
+
+class framePipeClass {
+  uint8_t *buf[2];        // pointers to dynamically-allocated frame buffers
+  uint8_t back;           // index of the buffer being rendered; the other buffer belongs to the sink
+  uint32_t numPixels;
+  uint8_t bpp;            // bytes per pixel
+  frameSinkClass *sink;
+  renderContextClass *ctx;  // context whose step clock is advanced by submit()
+  uint32_t renderStart;   // micros() when rendering of the current back buffer started
+  uint32_t lastSubmit;    // micros() at the previous submit()
+  framePipeStatsStruct stats;
+public:
+  framePipeClass() { buf[0] = NULL; buf[1] = NULL; sink = NULL; ctx = &defaultContext; numPixels = 0; resetStats(); }
+  bool init(uint32_t numPix, uint8_t bytesPerPixel, frameSinkClass *outSink, renderContextClass *context = &defaultContext);
+  uint8_t *backBuffer();
+  void setPixel(uint32_t pixel, uint8_t r, uint8_t g, uint8_t b);
+  void submit();
+  void resetStats();
+  const framePipeStatsStruct &getStats() { return (stats); }
+  float framesPerSec();
+  float pixelsPerSec() { return (framesPerSec() * numPixels); }
+  float meanRenderUs();
+  float meanWaitUs();
+};
+
+#endif  // _FRAME_PIPE_TYPES
@@ -0,0 +1,65 @@
+#include <Arduino.h>
+#include "RenderContext.h"
+
+#ifndef _GOLDEN_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _GOLDEN_TYPES
+
+const uint8_t goldenMaxChannels = 16;   // max number of separately-tracked channels (e.g. one per effect)
+const uint32_t goldenMagic = 0x4E444C47;  // "GLDN" file signature (little-endian)
+const uint16_t goldenVersion = 1;
+const float goldenScale = 32767;        // baseline values are stored as int16, scaled from the range -1.0 to +1.0
+
+enum goldenModeEnum {GOLDEN_IDLE, GOLDEN_RECORD, GOLDEN_COMPARE};
+
+struct goldenHeaderStruct {
+  uint32_t magic;         // goldenMagic
+  uint16_t version;       // goldenVersion
+  uint8_t numChannels;    // number of channels per frame
+  uint8_t reserved;
+  uint32_t numFrames;     // number of frames in the baseline
+  uint32_t numSamples;    // total number of int16 samples following the header
+  uint32_t seed;          // random seed used to record the baseline
+};
+
+struct goldenStatsStruct {
+  float maxErr;           // maximum absolute error
+  float sumErr;           // sum of absolute errors (for mean)
+  uint32_t samples;       // number of samples compared
+  uint32_t failures;      // number of samples with error > tolerance
+  uint32_t firstFailFrame;  // frame number of first failure (valid if failures > 0)
+};
+
+class goldenClass {
+  goldenModeEnum mode;
+  uint8_t numChannels;    // number of channels (effects) being tracked
+  float tolerance;        // maximum allowed absolute error per sample
+  int16_t *baseline;      // pointer to dynamically-allocated baseline sample array
+  uint32_t capacity;      // number of samples allocated
+  uint32_t numSamples;    // number of samples recorded/loaded
+  uint32_t readPos;       // next baseline sample to compare (GOLDEN_COMPARE)
+  uint32_t frameNum;      // current frame number
+  uint32_t numFrames;     // number of frames recorded/loaded
+  uint32_t seed;          // random seed applied at start of record/compare
+  bool overflow;          // true if samples were dropped (record) or missing (compare)
+  renderContextClass *ctx;  // context whose random number stream is seeded
+  goldenStatsStruct stats[goldenMaxChannels];
+  void resetStats();
+  void accumulate(uint8_t channel, float err);
+public:
+  goldenClass() { baseline = NULL; mode = GOLDEN_IDLE; numChannels = 0; capacity = 0; numSamples = 0; numFrames = 0; readPos = 0; frameNum = 0; seed = 0; overflow = false; ctx = &defaultContext; }
+  ~goldenClass() { if (baseline != NULL) delete[] baseline; }
+  void bindContext(renderContextClass *context) { ctx = context; }
+  void init(uint8_t channels, uint32_t maxSamples, float tol);
+  void startRecord(uint32_t rndSeed);
+  void startCompare();
+  void sample(uint8_t channel, float value);
+  void compare(uint8_t channel, float refVal, float testVal);
+  void endFrame();
+  bool save(Print &out);
+  bool load(Stream &in);
+  bool passed();
+  void report(Print &out);
+  goldenStatsStruct *getStats(uint8_t channel);
+};
+
+#endif  // _GOLDEN_TYPES
@@ -0,0 +1,34 @@
+#include <Arduino.h>
+#include "ColorUtilsHsi.h"
+#include "PixelMask.h"
+
+#ifndef _INSTANCE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _INSTANCE_TYPES
+
+const uint8_t instanceMaxCopies = 64;   // max number of copies in an instance map
+
+struct instanceCopyStruct {
+  uint32_t srcFirst;    // first pixel of the rendered (canonical) span
+  uint32_t dstFirst;    // first pixel of the copy
+  uint32_t count;       // number of pixels
+  bool reverse;         // true if the copy is in reverse pixel order (e.g. a mirrored half or a strip wired in the other direction)
+};
+
+class instanceMapClass {
+  instanceCopyStruct copy[instanceMaxCopies];
+  uint8_t numCopies;
+  void applyBytes(uint8_t *buf, uint8_t elemSize);
+public:
+  instanceMapClass() { numCopies = 0; }
+  void clear() { numCopies = 0; }
+  bool addCopy(uint32_t srcFirst, uint32_t count, uint32_t dstFirst, bool reverse = false);
+  bool addStrips(uint32_t srcFirst, uint32_t stripLen, uint8_t numStrips, uint32_t stride, bool serpentine = false);
+  bool addMirror(uint32_t first, uint32_t count);
+  void addSources(pixelMaskClass &mask);
+  uint8_t copyCount() { return (numCopies); }
+  void apply(float *buf) { applyBytes((uint8_t *) buf, sizeof(float)); }   // scalar effect output
+  void apply(hsiF *buf) { applyBytes((uint8_t *) buf, sizeof(hsiF)); }     // HSI colors
+  void applyFrame(uint8_t *frame, uint8_t bytesPerPixel) { applyBytes(frame, bytesPerPixel); }   // e.g. framePipeClass back buffer
+};
+
+#endif  // _INSTANCE_TYPES
@@ -0,0 +1,29 @@
+#include <Arduino.h>
+#include "ColorUtilsHsi.h"
+
+#ifndef _KEYFRAME_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _KEYFRAME_TYPES
+
+class keyframeClass {
+  uint32_t numPixels;
+  uint8_t framesPerKey;   // output frames per keyframe
+  uint8_t frameNum;       // output frames since the last keyframe
+  bool color;             // true for hsiF pixels, false for scalar (float) pixels
+  bool primed;            // false until the first keyframe has been committed
+  float *keyF, *lastF, *deltaF;   // scalar mode: render target, last committed keyframe, change from previous keyframe
+  hsiF *keyC, *lastC, *deltaC;    // color mode: as above, with hue deltas wrapped to -0.5 to +0.5
+  float invFrames;        // 1 / framesPerKey
+  void freeArrays();
+public:
+  keyframeClass() { numPixels = 0; keyF = lastF = deltaF = NULL; keyC = lastC = deltaC = NULL; }
+  ~keyframeClass() { freeArrays(); }
+  bool init(uint32_t numPix, uint8_t outputFramesPerKey, bool hsiPixels);
+  bool keyDue() { return (frameNum == 0); }
+  float *scalarKey() { return (keyF); }
+  hsiF *colorKey() { return (keyC); }
+  void commitKey();
+  void output(float *out);
+  void output(hsiF *out);
+};
+
+#endif  // _KEYFRAME_TYPES
@@ -5,6 +5,7 @@
 #include "RampVar.h"
 #include "Flicker.h"
 #include "Randomizer.h"
+#include "PixelMask.h"
 
 #ifndef _LASER_TYPES  // prevent duplicate type definitions when this file is included in multiple places
 #define _LASER_TYPES
@@ -37,11 +38,18 @@ class laserClass : public effect {
   float emberScale;
   flickerClass emberFlicker[numEmberTypes];
   randomizerClass randomizer;
+  float invZapLen;      // frame-constant terms cached by prepareFrame(): 1 / zapLen
+  float beamTail;       //   position of the trailing edge of the beam
+  float emberI[numEmberTypes];  //   intensity scale for each ember type (flicker value * emberScale)
 public:
   void init(uint16_t numPix, float distance, const laserConfigStruct *configParams);
   void start(hsiF laserColor, float zapDur, float duration);
+  void bindContext(renderContextClass *context);
   void step();
+  void prepareFrame();
   hsiF colorVal(uint16_t pixel);
+  void render(hsiF *out, uint32_t first, uint32_t count);
+  void render(hsiF *out, pixelMaskClass &mask);
 };
 
 #endif    // _LASER_TYPES
\ No newline at end of file
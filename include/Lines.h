@@ -8,6 +8,12 @@ struct coordStruct {
   float y;
 };
 
+struct coord3Struct {
+  float x;
+  float y;
+  float z;
+};
+
 
 class movingLineClass {
   coordStruct point;  // reference point for line
@@ -20,4 +26,15 @@ public:
 };
 
 
+class movingPlaneClass {
+  float normX, normY, normZ;  // unit normal of plane Ax + By + Cz + D = 0, which is also the direction of travel
+  float coeffD;
+public:
+  void init(coord3Struct refPos, float azimuth, float elevation);
+  void step(float distance);
+  float distance(coord3Struct pos);
+  void distance(float *out, const float *x, const float *y, const float *z, uint32_t first, uint32_t count);
+};
+
+
 #endif    // _LINE_TYPES
\ No newline at end of file
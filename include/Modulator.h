@@ -0,0 +1,34 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Ramp.h"
+#include "Sine.h"
+#include "Flicker.h"
+
+#ifndef _MODULATOR_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _MODULATOR_TYPES
+
+class modulatorClass {
+  rampClass *ramp;        // source effect (only one of these is non-NULL)
+  sineClass *sine;
+  flickerClass *flicker;
+public:
+  float val;              // source output, updated once per step
+  modulatorClass() { ramp = NULL; sine = NULL; flicker = NULL; val = 1.0; }
+  void init(rampClass *src);
+  void init(sineClass *src);
+  void init(flickerClass *src);
+  void step();
+};
+
+class rampModulatorClass : public modulatorClass {  // modulator that owns its source ramp; allocated by an effect's setRamp()
+public:
+  rampClass ramp;
+  rampModulatorClass() { init(&ramp); }
+  rampModulatorClass(const rampModulatorClass &src) : modulatorClass(src), ramp(src.ramp) { init(&ramp); val = src.val; }
+  rampModulatorClass &operator=(const rampModulatorClass &src) { ramp = src.ramp; init(&ramp); val = src.val; return (*this); }
+  void start(float duration) { ramp.start(duration); init(&ramp); }   // start the ramp, and update val before the first step
+};
+
+extern const modulatorClass unityModulator;   // shared default modulator; never stepped, so val is always 1.0
+
+#endif  // _MODULATOR_TYPES
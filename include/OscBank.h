@@ -0,0 +1,40 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+
+#ifndef _OSC_BANK_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _OSC_BANK_TYPES
+
+const uint8_t oscTableBits = 10;    // sine table has (1 << oscTableBits) entries per cycle
+const uint16_t oscTableSize = (1 << oscTableBits);
+const uint8_t oscFracBits = (32 - oscTableBits);  // bits of phase below the table index, used for interpolation
+
+class oscBankClass : public effect {
+  static float sineTable[oscTableSize + 1];  // one cycle of sin(), plus a guard entry for interpolation (shared by all banks)
+  static bool tableReady;
+  uint32_t numChan;       // number of channels (oscillators) in the bank
+  uint32_t numRamping;    // number of channels with a parameter ramp in progress
+    // per-channel state (structure of arrays, dynamically allocated)
+  uint32_t *phase;        // phase angle (full cycle = 2^32)
+  uint32_t *phaseInc;     // phase change per step
+  float *freq, *offset, *amplitude;   // current parameters (see sineClass)
+  float *freqEnd, *offsetEnd, *amplEnd;   // parameter values at the end of a ramp
+  float *freqDelta, *offsetDelta, *amplDelta;   // parameter change per ramp step
+  uint16_t *rampSteps;    // remaining steps in parameter ramp (0 if not ramping)
+  uint8_t *chanActive;    // 1 if the channel has been started and not terminated
+  void freeArrays();
+  uint32_t freqToInc(float frequency);
+public:
+  float *val;             // current output value of each channel, clipped to 0 - 1 (0 if inactive)
+  oscBankClass() { numChan = 0; active = false; phase = NULL; phaseInc = NULL; freq = NULL; offset = NULL; amplitude = NULL; freqEnd = NULL;
+                   offsetEnd = NULL; amplEnd = NULL; freqDelta = NULL; offsetDelta = NULL; amplDelta = NULL; rampSteps = NULL;
+                   chanActive = NULL; val = NULL; }
+  ~oscBankClass() { freeArrays(); }
+  bool init(uint32_t numChannels);
+  void update(uint32_t chan, float frequency, float level, float ampl, float rampDur);
+  void updateAll(float frequency, float level, float ampl, float rampDur);
+  void setPhase(uint32_t chan, float phaseFrac);
+  void randomizePhase();
+  void step();
+};
+
+#endif  // _OSC_BANK_TYPES
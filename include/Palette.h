@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include "ColorUtilsHsi.h"
+
+#ifndef _PALETTE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _PALETTE_TYPES
+
+const uint16_t paletteSize = 256;     // number of palette entries (8-bit indexes)
+const uint8_t paletteMaxStops = 16;   // max number of gradient stops
+const uint16_t levelChunkSize = 64;   // pixels per call of a levelFuncPtr (size of the float scratch buffer on the stack)
+
+  // renders effect values (0 - 1) for pixels first to (first + count - 1) into out[0] to out[count - 1]
+typedef void (*levelFuncPtr)(void *arg, float *out, uint32_t first, uint32_t count);
+
+struct paletteStopStruct {
+  float pos;      // position of the stop in the palette (0 - 1)
+  hsiF color;
+};
+
+class paletteClass {
+  hsiF entry[paletteSize];        // palette colors, before hue rotation
+  uint8_t lut[paletteSize][3];    // resolved RGB lookup table
+  float hueShift;                 // hue rotation applied by resolve() (0 - 1)
+  uint8_t cycleOffset;            // index rotation applied by resolve()
+  float brightness;               // intensity scale applied by resolve() (0 - 1)
+  bool dirty;                     // true if the lookup table must be resolved again
+public:
+  paletteClass();
+  void setEntry(uint8_t index, hsiF color);
+  void setGradient(const paletteStopStruct *stops, uint8_t numStops, bool shortestHue = true);
+  void setHueShift(float shift);
+  void setCycle(uint8_t offset);
+  void setBrightness(float level);
+  void resolve();
+  const uint8_t *rgb(uint8_t index) { return (lut[index]); }
+  static void HsiToRgb(hsiF color, uint8_t *rgbOut);
+};
+
+class indexedFrameClass {
+  uint8_t *index;       // palette index of each pixel (dynamically allocated)
+  uint32_t numPixels;
+  void quantize(const float *level, uint32_t first, uint32_t count);
+public:
+  indexedFrameClass() { index = NULL; numPixels = 0; }
+  ~indexedFrameClass() { delete [] index; }
+  bool init(uint32_t numPix);
+  uint8_t *indexes() { return (index); }
+  void setLevel(uint32_t pixel, float level);
+  void setLevels(const float *level, uint32_t first, uint32_t count);
+  void renderLevels(levelFuncPtr renderFunc, void *arg);
+  void output(uint8_t *frame, uint8_t bytesPerPixel, paletteClass &pal);
+};
+
+#endif  // _PALETTE_TYPES
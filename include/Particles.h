@@ -0,0 +1,50 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Droplet.h"
+
+#ifndef _PARTICLE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _PARTICLE_TYPES
+
+const uint16_t particleNone = 0xFFFF;     // returned by the emit functions when the pool is full
+const uint16_t particleNoLimit = 0xFFFF;  // stepsLeft of a particle with no time limit
+
+enum particleKindEnum {PARTICLE_DROPLET, PARTICLE_POP};
+
+class particlePoolClass : public effect {
+  uint16_t capacity;    // max number of live particles
+  uint16_t numLive;     // number of live particles
+  uint16_t *live;       // indices of live particles (dense, in no particular order)
+  uint16_t numFree;
+  uint16_t *freeList;   // stack of free particle indices
+    // per-particle state (structure of arrays, dynamically allocated)
+  uint8_t *kind;        // particleKindEnum
+  float *pos;           // droplet: position (mm) of leading edge; pop: radius (mm)
+  float *vel;           // change in pos per step (mm/step)
+  float *acc;           // change in vel per step (mm/step/step)
+  float *origin;        // droplet: start position (mm); pop: center position (mm)
+  float *endPos;        // droplet: position at which the tail has passed the end; pop: unused
+  float *rampLen;       // droplet: head ramp length; pop: ramp width (mm)
+  float *headLen;       // droplet: head length (mm); pop: unused
+  float *tailLen;       // droplet: tail length (mm); pop: unused
+  float *level;         // output scale factor (0 - 1)
+  float *fade;          // decrease in level per step
+  uint16_t *stepsLeft;  // remaining steps (particleNoLimit if the particle ends by position only)
+  void freeArrays();
+  uint16_t alloc();
+public:
+  particlePoolClass() { capacity = 0; numLive = 0; numFree = 0; active = false; live = NULL; freeList = NULL; kind = NULL; pos = NULL;
+                        vel = NULL; acc = NULL; origin = NULL; endPos = NULL; rampLen = NULL; headLen = NULL; tailLen = NULL; level = NULL;
+                        fade = NULL; stepsLeft = NULL; }
+  ~particlePoolClass() { freeArrays(); }
+  bool init(uint16_t maxParticles);
+  uint16_t emitDroplet(const dropletConfigStruct *cfg, float startPos, float dist);
+  uint16_t emitPop(float center, float distance, float duration, float rampWidth);
+  void setFade(uint16_t particle, float fadeTime);
+  void kill(uint16_t particle);
+  void clear();
+  uint16_t liveCount() { return (numLive); }
+  void step();
+  void render(float *out, uint16_t numPix, float spacing, float firstPos);
+};
+
+#endif  // _PARTICLE_TYPES
@@ -0,0 +1,144 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Ramp.h"
+#include "Flow.h"
+#include "Wave.h"
+#include "Droplet.h"
+#include "Modulator.h"
+#include "PixelMask.h"
+
+#ifndef _PIPELINE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _PIPELINE_TYPES
+
+/*
+  Header-only template layer that fuses the per-pixel math of several 1-dimensional effects into a single inlined loop. For example,
+  the hand-written loop
+
+    for (p = 0; p < numPixels; p++)
+      out[p] = wave.value(pos[p]) * flow.val(pos[p]) * ramp.val;
+
+  makes three out-of-line calls per pixel, which prevents the compiler from inlining or vectorizing across them. The equivalent
+
+    pipeline<pipeMultiply, waveClass, flowClass, rampClass> pipe;
+    pipe.load(wave, flow, ramp);    // once per frame, after step()
+    pipe.render(out, pos, numPixels);
+
+  copies the frame-constant state of each effect into a pipeStage<> once per frame, and then evaluates all of the stages for each
+  pixel in one inlined kernel. Stage results are combined left-to-right with the operator (pipeMultiply, pipeAdd, pipeMax, pipeMin).
+  Each pipeStage<> must produce the same result as the corresponding effect's value function.
+*/
+
+  // operators used to combine stage values
+struct pipeMultiply { static inline float apply(float a, float b) { return a * b; } };
+struct pipeAdd { static inline float apply(float a, float b) { return a + b; } };
+struct pipeMax { static inline float apply(float a, float b) { return (a > b) ? a : b; } };
+struct pipeMin { static inline float apply(float a, float b) { return (a < b) ? a : b; } };
+
+template <typename fxType> struct pipeStage;   // specialized for each supported effect class
+
+template <> struct pipeStage<flowClass> {   // equivalent to flowClass::val()
+  float curPos, rampSlope, gain;
+  void load(const flowClass &fx) {
+    curPos = fx.curPos;
+    rampSlope = fx.rampSlope;
+    gain = fx.active ? 1.0 : 0.0;
+  }
+  inline float eval(float offset) const {
+    float v = (curPos - offset) * rampSlope;
+    v = (v < 0) ? 0 : ((v > 1) ? 1 : v);
+    return ((offset < 0) ? 0 : (v * gain));
+  }
+};
+
+template <> struct pipeStage<waveClass> {   // equivalent to waveClass::value()
+  float phaseAngle, phasePerMm, gain;
+  void load(const waveClass &fx) {
+    phaseAngle = fx.phaseAngle;
+    phasePerMm = fx.phasePerMm;
+    gain = fx.active ? (fx.amplitude * fx.outRamp.mod->val) : 0.0;
+  }
+  inline float eval(float position) const { return (sinf(phaseAngle + (phasePerMm * position)) * gain); }
+};
+
+template <> struct pipeStage<dropletClass> {    // equivalent to dropletClass::value()
+  float curPos, tailPos, headRampLen, headEnd, headSlope, tailSlope;
+  bool active;
+  void load(const dropletClass &fx) {
+    active = fx.active;
+    curPos = fx.curPos;
+    headRampLen = fx.headRampLen;
+    headEnd = fx.headEnd;
+    tailPos = fx.tailPos;
+    headSlope = fx.headSlope;
+    tailSlope = fx.tailSlope;
+  }
+  inline float eval(float offset) const {
+    float relHead = curPos - offset;
+    float relTail = tailPos - offset;
+    if (!active || (relHead <= 0) || (offset < 0) || (relTail > 0))
+      return (0);
+    if (relHead < headRampLen)
+      return (relHead * headSlope);
+    return ((relHead < headEnd) ? 1.0 : (-relTail * tailSlope));
+  }
+};
+
+template <> struct pipeStage<rampClass> {   // position-independent scale factor (rampClass::val)
+  float val;
+  void load(const rampClass &fx) { val = fx.val; }
+  inline float eval(float) const { return (val); }
+};
+
+template <> struct pipeStage<modulatorClass> {  // position-independent scale factor (modulatorClass::val)
+  float val;
+  void load(const modulatorClass &mod) { val = mod.val; }
+  inline float eval(float) const { return (val); }
+};
+
+template <typename opType, typename... fxTypes> struct pipeChain;   // recursive list of stages
+
+template <typename opType, typename fxType> struct pipeChain<opType, fxType> {
+  pipeStage<fxType> stage;
+  void load(const fxType &fx) { stage.load(fx); }
+  inline float eval(float pos) const { return (stage.eval(pos)); }
+};
+
+template <typename opType, typename fxType, typename... restTypes> struct pipeChain<opType, fxType, restTypes...> {
+  pipeStage<fxType> stage;
+  pipeChain<opType, restTypes...> rest;
+  void load(const fxType &fx, const restTypes &... restFx) {
+    stage.load(fx);
+    rest.load(restFx...);
+  }
+  inline float eval(float pos) const { return (opType::apply(stage.eval(pos), rest.eval(pos))); }
+};
+
+template <typename opType, typename... fxTypes> class pipeline {
+  pipeChain<opType, fxTypes...> chain;
+public:
+    // copy the frame-constant state of each effect; call once per frame after the effects have been stepped
+  void load(const fxTypes &... fx) { chain.load(fx...); }
+    // value at a single position (mm)
+  inline float value(float pos) const { return (chain.eval(pos)); }
+    // render count pixels at arbitrary positions (mm)
+  void render(float *out, const float *pos, uint16_t count) const {
+    for (uint16_t p = 0; p < count; p++)
+      out[p] = chain.eval(pos[p]);
+  }
+    // render pixels first to (first + count - 1), indexing out and pos by pixel number like the effects' batch render() functions
+  void render(float *out, const float *pos, uint32_t first, uint32_t count) const {
+    for (uint32_t p = first; p < (first + count); p++)
+      out[p] = chain.eval(pos[p]);
+  }
+    // render only the pixels in a mask (see PixelMask.cpp); pixels outside the mask are not written
+  void render(float *out, const float *pos, pixelMaskClass &mask) const {
+    mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, pos, first, count); });
+  }
+    // render count equally-spaced pixels, starting at firstPos (mm)
+  void render(float *out, float firstPos, float spacing, uint16_t count) const {
+    for (uint16_t p = 0; p < count; p++)
+      out[p] = chain.eval(firstPos + (spacing * p));
+  }
+};
+
+#endif  // _PIPELINE_TYPES
@@ -0,0 +1,36 @@
+#include <Arduino.h>
+
+#ifndef _PIXEL_GRID_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _PIXEL_GRID_TYPES
+
+const uint16_t gridMaxCells = 16384;    // max number of cells; cell size is increased if necessary to stay within this limit
+
+class pixelGridClass {
+  const float *xCoord;    // caller's pixel coordinate arrays (mm)
+  const float *yCoord;
+  uint16_t numPixels;
+  float minX, minY;       // lower-left corner of the grid
+  float cellSize;         // width and height of each cell (mm)
+  float invCellSize;
+  uint16_t cols, rows;
+  uint16_t *cellStart;    // index in cellPixels of the first pixel in each cell (numCells + 1 entries)
+  uint16_t *cellPixels;   // pixel numbers, sorted by cell
+  uint16_t *result;       // pixel numbers found by the last query
+  uint16_t numResults;
+  void freeArrays();
+  void addCell(uint16_t cell);
+  uint16_t cellOf(float px, float py);
+public:
+  pixelGridClass() { numPixels = 0; cols = 0; rows = 0; numResults = 0; cellStart = NULL; cellPixels = NULL; result = NULL; }
+  ~pixelGridClass() { freeArrays(); }
+  bool init(const float *x, const float *y, uint16_t numPix, float cell);
+  uint16_t queryAnnulus(float cx, float cy, float rIn, float rOut);
+  uint16_t queryDisc(float cx, float cy, float r) { return (queryAnnulus(cx, cy, -1, r)); }
+  uint16_t queryRect(float x0, float y0, float x1, float y1);
+  const uint16_t *results() { return (result); }
+  uint16_t resultCount() { return (numResults); }
+  float x(uint16_t pixel) { return (xCoord[pixel]); }
+  float y(uint16_t pixel) { return (yCoord[pixel]); }
+};
+
+#endif  // _PIXEL_GRID_TYPES
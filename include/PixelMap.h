@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#include "Lines.h"
+#include "FileMap.h"
+
+#ifndef _PIXEL_MAP_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _PIXEL_MAP_TYPES
+
+class stripMgrClass;
+
+  // binary pixel map image (see PixelMap.cpp and tools/pixmap_convert.py); all fields are little-endian
+const uint32_t pixmapMagic = 0x314D5850;  // "PXM1"
+const uint16_t pixmapVersion = 1;
+
+struct pixmapHeaderStruct {
+  uint32_t magic;       // pixmapMagic
+  uint16_t version;     // pixmapVersion
+  uint16_t dims;        // 2 or 3
+  uint32_t numPixels;
+  uint32_t xOffset;     // byte offsets of the float coordinate arrays from the start of the image (4-byte aligned)
+  uint32_t yOffset;
+  uint32_t zOffset;     // 0 if dims == 2
+  uint32_t imageSize;   // total size of the image (bytes)
+  uint32_t reserved;
+};
+
+class pixelMapClass {
+  uint16_t capacity;    // max number of pixels that can be added (0 for an attached image)
+  uint16_t numPixels;   // number of pixels defined
+  const float *xCoord;  // pixel coordinates (mm), structure of arrays
+  const float *yCoord;
+  const float *zCoord;
+  float *xStore;        // coordinate arrays allocated by init()
+  float *yStore;
+  float *zStore;
+#ifdef EFFECT_HOST_MMAP
+  fileMapClass mapping; // file mapping created by load()
+#endif
+  void freeArrays();
+public:
+  pixelMapClass();
+  ~pixelMapClass() { freeArrays(); }
+  bool init(uint16_t maxPixels);
+  void clear() { if (capacity > 0) numPixels = 0; }   // an attached image can't be cleared
+  bool addPixel(coord3Struct pos);
+  bool addStrip(stripMgrClass &strip, uint16_t numPix, float z = 0);
+  bool addLine(coord3Struct startPos, float azimuth, float elevation, float spacing, uint16_t numPix);
+  bool addGrid(coord3Struct origin, uint16_t nx, uint16_t ny, uint16_t nz, float spacing);
+  bool attach(const void *image, uint32_t size);
+#ifdef EFFECT_HOST_MMAP
+  bool load(const char *path);
+#endif
+  uint16_t count() { return (numPixels); }
+  const float *x() { return (xCoord); }
+  const float *y() { return (yCoord); }
+  const float *z() { return (zCoord); }
+};
+
+#endif  // _PIXEL_MAP_TYPES
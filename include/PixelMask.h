@@ -0,0 +1,45 @@
+#include <Arduino.h>
+
+#ifndef _PIXEL_MASK_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _PIXEL_MASK_TYPES
+
+struct segmentDefStruct;    // defined in StripMgr.h
+
+struct pixelRunStruct {   // a run of consecutive pixels
+  uint32_t first;
+  uint32_t count;
+};
+
+class pixelMaskClass {
+  uint32_t numPixels;
+  uint32_t *bits;         // one bit per pixel (dynamically allocated)
+  pixelRunStruct *run;    // runs of set pixels, rebuilt from bits when needed (dynamically allocated)
+  uint32_t numRuns;
+  uint32_t maxRuns;       // allocated size of run[]
+  bool runsValid;         // false if bits has changed since the runs were built
+  bool buildRuns();
+public:
+  pixelMaskClass() { numPixels = 0; bits = NULL; run = NULL; numRuns = 0; maxRuns = 0; runsValid = false; }
+  ~pixelMaskClass() { delete [] bits; delete [] run; }
+  bool init(uint32_t numPix);
+  void clear();
+  void setAll();
+  void invert();
+  void addRange(uint32_t first, uint32_t count);
+  void removeRange(uint32_t first, uint32_t count);
+  void addSegments(const segmentDefStruct *segments, uint8_t firstSeg, uint8_t lastSeg);
+  void addWhere(const float *x, const float *y, bool (*inside)(float x, float y, void *arg), void *arg = NULL);
+  bool test(uint32_t pixel) { return ((pixel < numPixels) && ((bits[pixel >> 5] & (1UL << (pixel & 31))) != 0)); }
+  uint32_t count();
+  uint32_t runCount();
+  const pixelRunStruct *runs();
+    // calls f(first, count) for each run of consecutive set pixels, in increasing pixel order; the batch render() functions of the
+    // effects use this to render only the pixels in a mask
+  template <class F> void forEachRun(F f) {
+    const pixelRunStruct *r = runs();
+    for (uint32_t n = 0; n < numRuns; n++)
+      f(r[n].first, r[n].count);
+  }
+};
+
+#endif  // _PIXEL_MASK_TYPES
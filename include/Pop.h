@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Lines.h"
+#include "PixelGrid.h"
+#include "PixelMask.h"
 
 
 #ifndef _POP_TYPES  // prevent duplicate type definitions when this file is included in multiple places
@@ -9,7 +11,9 @@
 
 class popClass : public effect {
   coordStruct center;
+  float centerZ;    // z coordinate of center, used only by the 3D functions (0 for a 2D pop)
   float radius;
+  float lastRadius;   // radius at previous call to changed()
   float deltaRadius;  // amount to increase pop radius per step (mm)
   uint8_t phase;
   uint16_t phaseStep; 
@@ -18,16 +22,25 @@ class popClass : public effect {
   float a1, v1, d1;
   float v2;
   float rampWidth; // distance from pop radius to top of ramp (mm)
+  float invRampWidth;   // 1 / rampWidth, cached by prepareFrame()
   bool linear;
   bool completedFlag;  // becomes true when pop is completed
 public:
   popClass() { active = false; completedFlag = false; }
   void start(float duration, coordStruct pos, float distance, float rampLen);
   void start(float duration, coordStruct pos, float distance, float ramplen, float accel0, float distFrac0, float accel1);
+  void startSphere(float duration, coord3Struct pos, float distance, float rampLen);
   void step();
+  void prepareFrame();
   float value(coordStruct pos);
+  float value3D(coord3Struct pos);
+  void render(float *out, const float *x, const float *y, uint32_t first, uint32_t count);
+  void render(float *out, const float *x, const float *y, pixelMaskClass &mask);
+  uint16_t render(float *out, pixelGridClass &grid);
+  void render(float *out, const float *x, const float *y, const float *z, uint32_t first, uint32_t count);
   float distP2P(coordStruct p1, coordStruct p2);
   bool completed();
+  spanKindEnum changed(float *spanStart, float *spanEnd);
 };
 
 #endif  // _POP_TYPES
@@ -12,17 +12,19 @@ class rampClass : public effect {    // derived from base class "effect" defined
   uint16_t holdSteps;   // number of steps in hold period
   phaseEnum phase;      // current ramp phase  
   float rampDelta;      // added to val each ramp step
+  float lastVal;        // val at previous call to changed()
 public:
   float rampUpTime;       // nominal ramp up duration as set by start() or setRamp()
   float rampDownTime;     // nominal ramp down duration as set by start() or setRamp()
   float val;      // current output value of ramp function (0 - 1)
-  rampClass() { rampUpTime = 0; rampDownTime = 0; active = false; }
+  rampClass() { rampUpTime = 0; rampDownTime = 0; active = false; val = 0; lastVal = 0; }
   void start(float duration);
   void start(float duration, float rampDur);
   void start(float duration, float rampUpDur, float rampDownDur);
   void setRamp(float rampDur);
   void setRamp(float rampUpDur, float rampDownDur);
   void step();
+  spanKindEnum changed(float *spanStart, float *spanEnd);
 };
 
 #endif  // _RAMP_TYPES
@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include "RenderContext.h"
 
 #ifndef _RANDOMIZER_TYPES   // prevent duplicate type definitions when this file is included in multiple places
 #define _RANDOMIZER_TYPES
@@ -8,8 +9,10 @@ class randomizerClass {
   uint8_t numTypes;     // number of different pixel types to be randomly assigned (0 - (numTypes-1))
   uint8_t *pixType;     // pointer to dynamically-allocated pixel array
   float type0Prob;      // probability of each pixel being assigned type=0 (type0Prob=0 disables this feature)
+  renderContextClass *ctx;  // context supplying the random numbers
 public:
-  randomizerClass() { pixType = NULL; }
+  randomizerClass() { pixType = NULL; ctx = &defaultContext; }
+  void bindContext(renderContextClass *context) { ctx = context; }
   void init(uint16_t numPix, uint8_t numTyp, float t0Prob);
   void randomize();
   uint8_t getPixType(uint16_t pixel);
@@ -0,0 +1,26 @@
+#include <Arduino.h>
+
+#ifndef _RENDER_CONTEXT_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _RENDER_CONTEXT_TYPES
+
+const float defaultStepPeriod = 0.01;   // default, overridden by call to SetStepPeriod() or renderContextClass::setStepPeriod()
+
+class renderContextClass {
+  uint32_t rngState;    // state of the private random number stream (0 if using the global Arduino random() stream)
+  uint32_t steps;       // number of steps (frames) since the clock was reset
+public:
+  float stepPeriod;     // duration (seconds) of each effect step
+  renderContextClass() { stepPeriod = defaultStepPeriod; rngState = 0; steps = 0; }
+  void setStepPeriod(uint32_t periodMs) { stepPeriod = (float) periodMs / 1000; }
+  void seed(uint32_t rndSeed);
+  uint32_t random(uint32_t howBig);
+  int32_t random(int32_t howSmall, int32_t howBig);
+  void tick() { steps++; }    // advance the clock by one step; called once per frame by framePipeClass::submit()
+  void resetClock() { steps = 0; }   // called by framePipeClass::init()
+  uint32_t stepCount() { return steps; }
+  float time() { return (steps * stepPeriod); }   // elapsed time (seconds) since the clock was reset
+};
+
+extern renderContextClass defaultContext;   // context used by effects that haven't been bound to another context
+
+#endif  // _RENDER_CONTEXT_TYPES
@@ -0,0 +1,51 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+
+#ifndef _SCHEDULER_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _SCHEDULER_TYPES
+
+const uint16_t schedMaxCues = 256;      // max number of pending cues
+const uint8_t schedMaxRunning = 64;     // max number of effects in the step set
+const uint8_t schedWheelBits = 6;       // each wheel level has (1 << schedWheelBits) slots
+const uint16_t schedWheelSize = (1 << schedWheelBits);
+const uint16_t schedNoCue = 0xFFFF;     // end-of-list marker
+
+typedef void (*cueFuncPtr)(void *arg);  // cue/completion callback; arg is the pointer supplied when the cue was scheduled
+
+struct cueStruct {
+  uint32_t trigger;   // step number at which the cue fires
+  cueFuncPtr func;    // function called when the cue fires
+  void *arg;          // argument passed to func
+  uint16_t next;      // index of next cue in the same wheel slot (or free list)
+};
+
+struct runningStruct {
+  effect *fx;         // effect being stepped by the scheduler
+  cueFuncPtr doneFunc;  // function called when the effect becomes inactive (may be NULL)
+  void *doneArg;      // argument passed to doneFunc
+};
+
+class schedulerClass {
+  cueStruct cue[schedMaxCues];
+  uint16_t freeCue;     // head of free cue list
+  uint16_t wheel0[schedWheelSize];  // inner wheel: one slot per step
+  uint16_t wheel1[schedWheelSize];  // outer wheel: one slot per schedWheelSize steps
+  runningStruct running[schedMaxRunning];   // step set
+  uint8_t numRunning;
+  uint32_t curStep;     // current step number
+  uint32_t openStep;    // earliest step whose cues haven't been fired yet (curStep, or curStep + 1 once its cues have fired)
+  renderContextClass *ctx;  // context supplying the step period used by after()
+  void insert(uint16_t c);
+public:
+  schedulerClass() { ctx = &defaultContext; init(); }
+  void init();
+  void bindContext(renderContextClass *context) { ctx = context; }
+  bool at(uint32_t step, cueFuncPtr func, void *arg);
+  bool after(float delay, cueFuncPtr func, void *arg);
+  bool run(effect *fx, cueFuncPtr doneFunc, void *doneArg);
+  bool remove(effect *fx);
+  void step();
+  uint32_t stepCount() { return curStep; }
+};
+
+#endif  // _SCHEDULER_TYPES
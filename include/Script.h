@@ -0,0 +1,93 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Scheduler.h"
+
+#ifndef _SCRIPT_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _SCRIPT_TYPES
+
+  // Coroutine scripts require C++20 (e.g. build_flags = -std=gnu++20 -fcoroutines); otherwise this module is empty
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define EFFECT_SCRIPTS
+#include <coroutine>
+
+const uint16_t scriptFrameSize = 192;   // max size (bytes) of each coroutine frame; larger scripts fail to start
+const uint16_t scriptPoolSize = 64;     // max number of concurrently-running scripts
+const uint8_t scriptMaxAll = 8;         // max number of effects in a single allDone() (one bit each in allDoneAwaiter::waiting)
+static_assert(scriptMaxAll <= 8, "scriptMaxAll must fit the allDoneAwaiter::waiting bit mask");
+
+class scriptClass {   // return type of a script coroutine, e.g. scriptClass myShow(scriptRunnerClass &run) { ... }
+public:
+  struct promise_type {
+    scriptClass get_return_object() { return scriptClass(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    static scriptClass get_return_object_on_allocation_failure() { return scriptClass(std::coroutine_handle<promise_type>()); }
+    std::suspend_always initial_suspend() noexcept { return {}; }   // script runs when started by scriptRunnerClass::start()
+    std::suspend_always final_suspend() noexcept { return {}; }     // frame is released by the runner
+    void return_void() {}
+    void unhandled_exception() {}
+    static void *operator new(size_t size) noexcept;    // frames are allocated from a fixed pool
+    static void operator delete(void *ptr);
+  };
+  std::coroutine_handle<promise_type> handle;
+  scriptClass(std::coroutine_handle<promise_type> h) { handle = h; }
+};
+
+struct scriptAwaitBase {    // common awaiter state
+  schedulerClass *sched;
+  std::coroutine_handle<> handle;   // suspended script
+  static void resume(void *arg);
+};
+
+struct untilDoneAwaiter : scriptAwaitBase {
+  effect *fx;
+  bool ok;    // result of co_await: false if the effect could not be added to the step set
+  bool await_ready() { ok = true; return (!fx->active); }
+  bool await_suspend(std::coroutine_handle<> h);
+  bool await_resume() { return ok; }
+  static void retry(void *arg);
+};
+
+struct waitForAwaiter : scriptAwaitBase {
+  float delay;
+  bool ok;    // result of co_await: false if the resume cue could not be scheduled
+  bool await_ready() { ok = true; return (delay <= 0); }
+  bool await_suspend(std::coroutine_handle<> h);
+  bool await_resume() { return ok; }
+};
+
+struct allDoneAwaiter : scriptAwaitBase {
+  effect *fx[scriptMaxAll];
+  uint8_t count;        // number of effects
+  uint8_t remaining;    // number of active effects not yet completed (whether or not they are in the step set yet)
+  uint8_t waiting;      // bit mask of active effects not yet added to the step set (which was full)
+  bool ok;    // result of co_await: false if the effects could not all be added to the step set
+  bool await_ready();
+  bool await_suspend(std::coroutine_handle<> h);
+  bool await_resume() { return ok; }
+  bool addWaiting();
+  void cancel();
+  static void done(void *arg);
+  static void retry(void *arg);
+};
+
+class scriptRunnerClass {
+  schedulerClass *sched;    // scheduler that steps awaited effects and resumes scripts
+public:
+  scriptRunnerClass() { sched = NULL; }
+  void init(schedulerClass *scheduler) { sched = scheduler; }
+  bool start(scriptClass script);
+  untilDoneAwaiter untilDone(effect &fx);
+  waitForAwaiter waitFor(float seconds);
+  template <typename... fxTypes> allDoneAwaiter allDone(fxTypes &... fxList) {
+    static_assert(sizeof...(fxList) <= scriptMaxAll, "too many effects in allDone() (see scriptMaxAll)");
+    effect *list[] = {&fxList...};
+    allDoneAwaiter aw;
+    aw.sched = sched;
+    aw.count = sizeof...(fxList);
+    for (uint8_t n = 0; n < aw.count; n++)
+      aw.fx[n] = list[n];
+    return (aw);
+  }
+};
+
+#endif  // __cpp_impl_coroutine
+#endif  // _SCRIPT_TYPES
@@ -0,0 +1,64 @@
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Lines.h"
+#include "PixelMask.h"
+
+#ifndef _SHAPE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _SHAPE_TYPES
+
+const uint8_t shapeMaxParts = 8;      // max number of primitives in a shape
+const uint16_t shapeBlockSize = 64;   // number of pixels evaluated together by render()
+
+enum shapeTypeEnum {SHAPE_CIRCLE, SHAPE_LINE, SHAPE_RECT, SHAPE_POLYGON, SHAPE_RING};
+enum shapeOpEnum {SHAPE_UNION, SHAPE_INTERSECT, SHAPE_SUBTRACT};
+
+struct shapePartStruct {
+  uint8_t type;     // shapeTypeEnum
+  uint8_t op;       // shapeOpEnum; how the part is combined with the parts before it
+  float a, b, c, d; // circle: cx, cy, radius; line: A, B, C (Ax + By + C = 0); rect: cx, cy, half width, half height;
+                    // ring: cx, cy, radius, half thickness
+  const coordStruct *points;  // polygon vertices (referenced, not copied)
+  uint8_t numPoints;
+};
+
+class sdfShapeClass {
+  shapePartStruct part[shapeMaxParts];
+  uint8_t numParts;
+  coordStruct offset;   // shape transform: translation (mm), rotation and scale factor
+  float angle;
+  float scale;
+  float cosA, sinA, invScale;   // cached by setTransform()
+  bool addPart(uint8_t type, uint8_t op, float a, float b, float c, float d);
+  void partDistance(const shapePartStruct &pt, const float *x, const float *y, float *dist, uint16_t count);
+public:
+  sdfShapeClass() { clear(); }
+  void clear();
+  bool addCircle(coordStruct center, float radius, uint8_t op = SHAPE_UNION);
+  bool addLine(coordStruct refPos, float lineAngle, uint8_t op = SHAPE_UNION);
+  bool addRect(coordStruct center, float width, float height, uint8_t op = SHAPE_UNION);
+  bool addRing(coordStruct center, float radius, float thickness, uint8_t op = SHAPE_UNION);
+  bool addPolygon(const coordStruct *points, uint8_t numPoints, uint8_t op = SHAPE_UNION);
+  void setTransform(coordStruct pos, float rotation, float scaleFactor);
+  float distance(coordStruct pos);
+  void render(float *out, const float *x, const float *y, uint32_t first, uint32_t count, float rampWidth);
+};
+
+class shapeEffectClass : public effect {
+  sdfShapeClass *shape;
+  coordStruct pos, deltaPos;    // current transform and change per step
+  float angle, deltaAngle;
+  float scale, deltaScale;
+  float rampWidth;    // distance inside the shape edge to top of ramp (mm)
+  bool completedFlag;
+public:
+  shapeEffectClass() { active = false; completedFlag = false; shape = NULL; }
+  void start(float duration, sdfShapeClass *shp, coordStruct pos0, float angle0, float scale0, coordStruct pos1, float angle1, 
+              float scale1, float rampLen);
+  void step();
+  float value(coordStruct p);
+  void render(float *out, const float *x, const float *y, uint32_t first, uint32_t count);
+  void render(float *out, const float *x, const float *y, pixelMaskClass &mask);
+  bool completed();
+};
+
+#endif  // _SHAPE_TYPES
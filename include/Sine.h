@@ -1,22 +1,30 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
-#include "RampVar.h"
 
 #ifndef _SINE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
 #define _SINE_TYPES
 
+class modulatorClass;   // defined in Modulator.h
+
 class sineClass : public effect {    // derived from "effect" class defined in EffectUtils.h
+  const modulatorClass *freqMod;       // shared modulators used instead of the parameter ramps (NULL if not bound)
+  const modulatorClass *offsetMod;
+  const modulatorClass *amplitudeMod;
+  float freqModScale;   // frequency (Hz) when freqMod->val == 1.0
+  uint16_t rampSteps;   // remaining steps in the parameter ramp started by update() (0 if not ramping)
+  float freqDelta, offsetDelta, amplDelta;  // parameter change per ramp step
+  float freqEnd, offsetEnd, amplEnd;        // parameter values at the end of the ramp (avoids rounding errors)
 public:
   float offset;        // positive offset of sine wave baseline from 0 (0 - 1)
   float amplitude;      // absolute value of sine wave amplitude relative to offset baseline (0 - 1)
   float frequency;     // sine frequency (Hz)
   float phaseAngle;      // current wave phase angle (radians)
   float phaseDelta;      // phase angle change (radians) per step
-  rampVarClass freqRamp;       // embedded rampVar object to ramp frequency
-  rampVarClass offsetRamp;    // embedded rampVar object to ramp offset
-  rampVarClass amplitudeRamp; // embedded rampVar object to ramp amplitude
-  sineClass() { active = false; }   // object constructor
+  sineClass() { active = false; rampSteps = 0; freqMod = NULL; offsetMod = NULL; amplitudeMod = NULL; }   // object constructor
   void update(float freq, float level,  float ampl, float rampDur);
+  void bindFrequency(const modulatorClass *mod, float maxFreq);
+  void bindOffset(const modulatorClass *mod);
+  void bindAmplitude(const modulatorClass *mod);
   void step();
   float value();  // current value of sine wave function
   float value(float phaseOffsetFrac);  // current value of sine wave function at a specified phase offset
@@ -0,0 +1,46 @@
+#ifdef EFFECT_HOST_THREADS   // standard headers must precede the min()/max() macros defined by Arduino.h
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#endif
+#include <Arduino.h>
+
+#ifndef _SPANPOOL_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _SPANPOOL_TYPES
+
+  // The thread pool is only available on host builds with std::thread (define EFFECT_HOST_THREADS); otherwise this module is empty
+#ifdef EFFECT_HOST_THREADS
+
+const uint8_t spanMaxThreads = 64;      // max number of threads (including the calling thread)
+const uint32_t spanDefaultChunk = 1024; // default number of pixels per work item
+
+typedef void (*spanFuncPtr)(void *arg, uint32_t first, uint32_t count);   // renders pixels first to (first + count - 1)
+
+class spanPoolClass {
+  std::thread worker[spanMaxThreads];
+  uint8_t numWorkers;             // number of worker threads (excluding the calling thread)
+  std::mutex lock;
+  std::condition_variable startCv;  // signals workers that a new frame is ready
+  std::condition_variable doneCv;   // signals the calling thread that all workers are done
+  uint32_t generation;            // incremented for each run(), so workers can detect new work
+  uint8_t workersDone;            // number of workers finished with the current run()
+  bool quit;                      // tells workers to exit
+  spanFuncPtr func;               // current render function
+  void *funcArg;                  // argument passed to func
+  uint32_t numPixels;             // pixels in the current run()
+  uint32_t chunkSize;             // pixels per work item
+  std::atomic<uint32_t> nextChunk;  // shared atomic chunk counter: next work item to be claimed
+  void workerLoop(uint32_t lastGeneration);
+  void renderChunks();
+public:
+  spanPoolClass() { numWorkers = 0; generation = 0; quit = false; }
+  ~spanPoolClass() { end(); }
+  void init(uint8_t threads);
+  void run(spanFuncPtr renderFunc, void *arg, uint32_t pixels, uint32_t chunk = spanDefaultChunk);
+  void end();
+  uint8_t threads() { return (numWorkers + 1); }
+};
+
+#endif  // EFFECT_HOST_THREADS
+#endif  // _SPANPOOL_TYPES
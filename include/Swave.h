@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
-#include "Ramp.h"
 
 #ifndef _SWAVE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
 #define _SWAVE_TYPES
@@ -10,11 +9,13 @@ class swaveClass : public effect {    // derived from "effect" class defined in
   float waveLength;     // wavelength in mm
   float phaseAngle;      // current wave phase angle
   float phaseDelta;      // phase angle change per step
-  rampClass ramp;       // embedded ramp object in each wave instance
+  outputRampClass outRamp;  // modulator that scales the output
 public:
   swaveClass() { active = false; }   // object constructor
   void start(float duration, float wavelen, float freq, float ampl);
   void setRamp(float rampDur);
+  void bindRamp(const modulatorClass *mod);
+  void bindContext(renderContextClass *context);
   void step();
   float value(float position);  // value of wave function (-amplitude to +amplitude) at specified offset from origin (mm)
 };
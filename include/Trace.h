@@ -0,0 +1,68 @@
+#include <Arduino.h>
+
+#ifndef _TRACE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
+#define _TRACE_TYPES
+
+const uint16_t traceBufSize = 512;    // number of events held in the ring buffer (must be a power of 2)
+const uint16_t traceLibId = 0;        // trace id used by events recorded inside this library; callers should use ids >= 1
+
+enum traceCatEnum {TRACE_FRAME, TRACE_START, TRACE_STEP, TRACE_RENDER, TRACE_LAUNCH, TRACE_NUM_CATS};
+enum tracePhaseEnum {TRACE_BEGIN, TRACE_END};
+
+struct traceEventStruct {
+  uint32_t time;      // timestamp (CPU cycles where available, otherwise microseconds)
+  uint16_t id;        // caller-defined id (e.g. effect instance number), exported as the Chrome trace "tid"
+  uint8_t category;   // traceCatEnum
+  uint8_t phase;      // tracePhaseEnum
+};
+
+class traceClass {
+  traceEventStruct buf[traceBufSize];   // ring buffer of recorded events
+  uint32_t head;            // total number of events recorded (producer index; published with release ordering)
+  uint32_t tail;            // total number of events drained (consumer index; only used by the consumer)
+  uint32_t lost;            // number of events overwritten before they could be drained
+public:
+  bool enabled;             // recording is skipped when false
+  traceClass() { head = 0; tail = 0; lost = 0; enabled = true; }
+    // record an event; inline so that the cost is a timestamp read, four stores and two barriers
+  inline void record(uint8_t cat, uint8_t phase, uint16_t id) {
+    traceEventStruct *ev;
+    uint32_t h;
+    if (enabled) {
+      h = head;   // only the producer writes head
+      __atomic_thread_fence(__ATOMIC_RELEASE);    // previous head update is visible before this slot is overwritten
+      ev = &buf[h & (traceBufSize - 1)];
+      ev->time = timestamp();
+      ev->id = id;
+      ev->category = cat;
+      ev->phase = phase;
+      __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);   // publish the event after its contents
+    }
+  }
+  void begin(uint8_t cat, uint16_t id) { record(cat, TRACE_BEGIN, id); }
+  void end(uint8_t cat, uint16_t id) { record(cat, TRACE_END, id); }
+  uint16_t drain(traceEventStruct *dest, uint16_t maxEvents);
+  void exportJson(Print &out);
+  uint32_t lostEvents() { return lost; }
+  static inline uint32_t timestamp() {
+#if defined(ARM_DWT_CYCCNT)
+    return ARM_DWT_CYCCNT;    // free-running cycle counter (single register read)
+#else
+    return micros();
+#endif
+  }
+  static float ticksPerUs();
+};
+
+extern traceClass effectTrace;    // global trace buffer used by the TRACE_BEGIN()/TRACE_END() macros
+
+  // Trace points compile to nothing unless EFFECT_TRACE is defined (e.g. -D EFFECT_TRACE in platformio.ini build_flags)
+#ifdef EFFECT_TRACE
+#define TRACE_BEGIN(cat, id) effectTrace.begin((cat), (id))
+#define TRACE_END(cat, id) effectTrace.end((cat), (id))
+#else
+#define TRACE_BEGIN(cat, id)
+#define TRACE_END(cat, id)
+#endif
+
+#endif  // _TRACE_TYPES
@@ -1,6 +1,6 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
-#include "Ramp.h"
+#include "PixelMask.h"
 
 #ifndef _WAVE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
 #define _WAVE_TYPES
@@ -9,19 +9,26 @@ class waveClass : public effect {    // derived from "effect" class defined in E
   float amplitude;      // maximum amplitude of sine wave (0 - 1)
   float phaseAngle;      // current sine wave phase angle at wave "origin"
   float phaseDelta;      // phase angle change per step
-  rampClass ramp;       // embedded ramp object in each wave instance
+  outputRampClass outRamp;  // modulator that scales the output
+  float phasePerMm;     // (TWO_PI / waveLength), cached by setWaveLength() and step()
+  template <typename> friend struct pipeStage;  // fused per-pixel kernels (see Pipeline.h)
 public:
-  float waveLength;   // wavelength supplied in start() for reference by calling functions
-  waveClass() { active = false; }   // object constructor
+  float waveLength;     // wavelength (mm) supplied in start() or setWaveLength(), for reference by calling functions
+  waveClass() { active = false; setWaveLength(1); }   // object constructor
   void start(float duration, float frequency, float ampl);
   void start(float duration, float wavelen, float speed, float ampl);
   void setFrequency(float frequency);
   void setAmplitude(float ampl);
+  void setWaveLength(float wavelen);
   void setRamp(float rampDur);
+  void bindRamp(const modulatorClass *mod);
+  void bindContext(renderContextClass *context);
   void step();
   float value(float position);  // value of wave function (-amplitude to +amplitude) at specified offset from origin (mm)
   float val(float offset);  // value of wave function (0 - amplitude) at specified offset (fraction of wavelength)
   float val();  // value of wave function (0 - amplitude) at wave origin
+  void render(float *out, const float *position, uint32_t first, uint32_t count);  // value() for a range of pixels
+  void render(float *out, const float *position, pixelMaskClass &mask);   // value() for the pixels in a mask
 };
 
 #endif  // _WAVE_TYPES
@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Lines.h"
+#include "PixelMask.h"
 
 
 #ifndef _WIPE_TYPES  // prevent duplicate type definitions when this file is included in multiple places
@@ -9,15 +10,23 @@
 
 class wipeClass : public effect {
   movingLineClass line;   // moving line representing the leading edge of the wipe effect
+  movingPlaneClass plane; // moving plane representing the leading edge, used by the 3D functions
+  bool volume;      // true if started with a plane; the 2D functions then use the plane at z = 0
   float deltaDist;  // distance to move wipe line per step (mm), in direction perpendicular to line
   float rampWidth; // distance from flow leading edge to top of ramp (mm)
   bool completedFlag;  // becomes true when flow is completed
 public:
-  wipeClass() { active = false; completedFlag = false; }
+  wipeClass() { active = false; completedFlag = false; volume = false; }
   void start(float duration, coordStruct refPos, float angle, float distance, float rampLen);
+  void start(float duration, coord3Struct refPos, float azimuth, float elevation, float distance, float rampLen);
   void step();
   float value(coordStruct pos);
+  float value3D(coord3Struct pos);
+  void render(float *out, const float *x, const float *y, uint32_t first, uint32_t count);
+  void render(float *out, const float *x, const float *y, pixelMaskClass &mask);
+  void render(float *out, const float *x, const float *y, const float *z, uint32_t first, uint32_t count);
   bool completed();
+  spanKindEnum changed(float *spanStart, float *spanEnd);
 };
 
 #endif  // _WIPE_TYPES
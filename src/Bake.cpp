@@ -0,0 +1,349 @@
+/* BAKE.CPP
+    This module defines classes to "bake" a deterministic scene into a compact frame stream, and to play it back with almost no CPU
+    load, leaving the CPU free for live/interactive layers.
+
+    bakeWriterClass takes rendered frames (bytesPerPixel bytes per pixel, e.g. RGB as sent to the LEDs) and writes them to a
+    Print-derived stream. Each frame is encoded against the previous frame as a sequence of run tokens: SKIP (pixels unchanged),
+    REPEAT (one pixel value repeated), and LITERAL (pixel values copied as-is). Every keyInterval'th frame is a "key" frame that is
+    encoded against a black frame, so that playback can seek without decoding from the beginning of the stream. A (4-byte aligned) table
+    of frame offsets is written at the end of the stream.
+
+    bakePlayerClass plays the stream directly from memory: a const array in flash on the device (which is memory-mapped on Teensy),
+    or (on host builds with EFFECT_HOST_MMAP defined) a memory-mapped file opened with load(). No part of the stream is copied to
+    RAM. Each frame is decoded into a private frame buffer, which serves as the "previous frame" for SKIP tokens, and then copied to
+    the caller's frame buffer, so the caller may freely draw live layers over the played frame. The header and frame offset table
+    are validated once by init(), and the decoder checks each token against the bounds of its frame, so a corrupt or truncated
+    stream can't cause a read or write outside the stream or the frame buffers. Playback loops between the loopStart and loopEnd frames stored in the
+    stream header, and may be repositioned with seek().
+*/
+#include <Arduino.h>
+#include "Bake.h"
+
+
+/* bakeWriterClass::begin()
+    Writes the stream header and prepares to encode frames
+  Parameters:
+    Print *stream: Stream to write to (e.g. a File)
+    uint32_t numPix: Number of pixels per frame
+    uint8_t bytesPerPix: Number of bytes per pixel (1 - bakeMaxBpp)
+    uint32_t frames: Number of frames that will be added with addFrame()
+    uint32_t loopFirst: First frame of the playback loop
+    uint32_t loopLast: Last frame of the playback loop
+    uint8_t keyInt: Key frame interval (frames). Smaller values make seek() faster but the stream larger
+  Returns:
+    bool: True if memory allocation succeeded and the parameters are valid
+*/
+bool bakeWriterClass::begin(Print *stream, uint32_t numPix, uint8_t bytesPerPix, uint32_t frames, uint32_t loopFirst,
+    uint32_t loopLast, uint8_t keyInt) {
+  bakeHeaderStruct hdr;
+
+  if ((bytesPerPix == 0) || (bytesPerPix > bakeMaxBpp) || (frames == 0) || (keyInt == 0))
+    return (false);
+  out = stream;
+  numPixels = numPix;
+  bpp = bytesPerPix;
+  numFrames = frames;
+  keyInterval = keyInt;
+  if (prevFrame != NULL)
+    delete[] prevFrame;
+  if (frameOffset != NULL)
+    delete[] frameOffset;
+  prevFrame = new uint8_t [numPixels * bpp];
+  frameOffset = new uint32_t [numFrames];
+  if ((prevFrame == NULL) || (frameOffset == NULL))
+    return (false);
+  hdr.magic = bakeMagic;
+  hdr.version = bakeVersion;
+  hdr.bytesPerPixel = bpp;
+  hdr.keyInterval = keyInterval;
+  hdr.numPixels = numPixels;
+  hdr.numFrames = numFrames;
+  hdr.loopStart = min(loopFirst, numFrames - 1);
+  hdr.loopEnd = constrain(loopLast, hdr.loopStart, numFrames - 1);
+  bytesWritten = out->write((const uint8_t *) &hdr, sizeof(hdr));
+  frameNum = 0;
+  return (true);
+}
+
+
+/* bakeWriterClass::writeToken()
+    Writes a single run token and any pixel data that follows it
+  Parameters:
+    uint8_t type: BAKE_LITERAL, BAKE_SKIP or BAKE_REPEAT
+    uint8_t len: Number of pixels in the run (1 - bakeMaxRun)
+    const uint8_t *pix: Pointer to the first pixel of the run
+  Returns: None
+*/
+void bakeWriterClass::writeToken(uint8_t type, uint8_t len, const uint8_t *pix) {
+  bytesWritten += out->write((uint8_t) (type | (len - 1)));
+  if (type == BAKE_LITERAL)
+    bytesWritten += out->write(pix, len * bpp);
+  else if (type == BAKE_REPEAT)
+    bytesWritten += out->write(pix, bpp);
+}
+
+
+/* bakeWriterClass::addFrame()
+    Encodes the next frame and writes it to the stream. Frames beyond the number declared in begin() are ignored.
+  Parameters:
+    const uint8_t *frame: Pointer to the rendered frame (numPixels * bytesPerPixel bytes)
+  Returns: None
+*/
+void bakeWriterClass::addFrame(const uint8_t *frame) {
+  uint32_t p, n;
+  uint8_t len;
+
+  if ((prevFrame == NULL) || (frameNum >= numFrames))
+    return;
+  if ((frameNum % keyInterval) == 0)  // if key frame
+    memset(prevFrame, 0, numPixels * bpp);  // encode against a black frame
+  frameOffset[frameNum] = bytesWritten;
+  p = 0;
+  while (p < numPixels) {
+      // count pixels unchanged from the previous frame
+    for (n = p; (n < numPixels) && ((n - p) < bakeMaxRun) && (memcmp(&frame[n * bpp], &prevFrame[n * bpp], bpp) == 0); n++);
+    if (n > p) {
+      writeToken(BAKE_SKIP, n - p, NULL);
+      p = n;
+      continue;
+    }
+      // count pixels identical to this one
+    for (n = p + 1; (n < numPixels) && ((n - p) < bakeMaxRun) && (memcmp(&frame[n * bpp], &frame[p * bpp], bpp) == 0); n++);
+    if ((n - p) >= bakeMinRepeat) {
+      writeToken(BAKE_REPEAT, n - p, &frame[p * bpp]);
+      p = n;
+      continue;
+    }
+      // literal run ends at an unchanged pixel or at the start of a repeat run
+    len = 1;
+    while (((p + len) < numPixels) && (len < bakeMaxRun)) {
+      n = p + len;
+      if (memcmp(&frame[n * bpp], &prevFrame[n * bpp], bpp) == 0)
+        break;
+      if (((n + bakeMinRepeat) <= numPixels) && (memcmp(&frame[n * bpp], &frame[(n + 1) * bpp], bpp) == 0) &&
+          (memcmp(&frame[n * bpp], &frame[(n + 2) * bpp], bpp) == 0))
+        break;
+      len++;
+    }
+    writeToken(BAKE_LITERAL, len, &frame[p * bpp]);
+    p += len;
+  }
+  memcpy(prevFrame, frame, numPixels * bpp);
+  frameNum++;
+}
+
+
+/* bakeWriterClass::finish()
+    Writes the frame offset table at the end of the stream and releases the memory allocated by begin()
+  Parameters: None
+  Returns:
+    bool: True if the number of frames added matches the number declared in begin()
+*/
+bool bakeWriterClass::finish() {
+  bool retVal;
+
+  if (frameOffset == NULL)
+    return (false);
+  retVal = (frameNum == numFrames);
+  while (frameNum < numFrames) {   // keep the stream valid if frames are missing (repeat the last frame)
+    frameOffset[frameNum++] = bytesWritten;
+    for (uint32_t p = 0; p < numPixels; p += bakeMaxRun)
+      writeToken(BAKE_SKIP, min(numPixels - p, (uint32_t) bakeMaxRun), NULL);
+  }
+  while ((bytesWritten % sizeof(uint32_t)) != 0)  // align the offset table
+    bytesWritten += out->write((uint8_t) 0);
+  out->write((const uint8_t *) frameOffset, numFrames * sizeof(uint32_t));
+  delete[] prevFrame;
+  delete[] frameOffset;
+  prevFrame = NULL;
+  frameOffset = NULL;
+  return (retVal);
+}
+
+
+/* bakePlayerClass::init()
+    Validates a baked stream, allocates the private decode buffer, and prepares to play the stream from the start. Every frame offset
+    is checked against the stream size once here, so that decode() only needs to check tokens against the bounds of their frame.
+  Parameters:
+    const uint8_t *bakedData: Pointer to the baked stream (4-byte aligned) in flash or in a memory-mapped file
+    uint32_t size: Total size of the stream (bytes)
+    uint8_t *outFrame: Frame buffer that frames are copied into (numPixels * bytesPerPixel bytes)
+  Returns:
+    bool: True if the stream is valid and memory allocation succeeded
+*/
+bool bakePlayerClass::init(const uint8_t *bakedData, uint32_t size, uint8_t *outFrame) {
+  const bakeHeaderStruct *h;
+  const uint32_t *offsets;
+  uint32_t tableStart;    // offset of the frame offset table (end of the frame data)
+  uint32_t frameSize;
+
+  data = NULL;
+#ifdef EFFECT_HOST_MMAP
+  mapping.unmap();
+#endif
+  h = (const bakeHeaderStruct *) bakedData;
+  if ((bakedData == NULL) || (outFrame == NULL) || (((uintptr_t) bakedData & 3) != 0) || ((size & 3) != 0) ||
+      (size < sizeof(bakeHeaderStruct)))
+    return (false);
+  if ((h->magic != bakeMagic) || (h->version != bakeVersion) || (h->numFrames == 0) || (h->keyInterval == 0) ||
+      (h->bytesPerPixel == 0) || (h->bytesPerPixel > bakeMaxBpp) || (h->numPixels == 0) ||
+      (h->numPixels > (UINT32_MAX / h->bytesPerPixel)) || (h->loopStart > h->loopEnd) || (h->loopEnd >= h->numFrames))
+    return (false);
+  if (h->numFrames > ((size - sizeof(bakeHeaderStruct)) / sizeof(uint32_t)))   // offset table doesn't fit
+    return (false);
+  tableStart = size - (h->numFrames * sizeof(uint32_t));
+  offsets = (const uint32_t *) (bakedData + tableStart);
+  for (uint32_t f = 0; f < h->numFrames; f++) {   // frames must lie between the header and the table, in order
+    if ((offsets[f] < sizeof(bakeHeaderStruct)) || (offsets[f] >= tableStart) || ((f > 0) && (offsets[f] < offsets[f - 1])))
+      return (false);
+  }
+  frameSize = h->numPixels * h->bytesPerPixel;
+  if (frameSize > decodeSize) {
+    delete [] decodeBuf;
+    decodeBuf = new uint8_t [frameSize];
+    decodeSize = (decodeBuf != NULL) ? frameSize : 0;
+    if (decodeBuf == NULL)
+      return (false);
+  }
+  data = bakedData;
+  hdr = h;
+  frameOffset = offsets;
+  frameBuf = outFrame;
+  curFrame = 0;
+  return (true);
+}
+
+
+#ifdef EFFECT_HOST_MMAP
+/* bakePlayerClass::load()
+    Host builds only: memory-maps a baked stream file (read-only) and prepares to play it with init(). The mapping is released by a
+    subsequent init() or load().
+  Parameters:
+    const char *path: Path of the baked stream file
+    uint8_t *outFrame: Frame buffer that frames are copied into (numPixels * bytesPerPixel bytes)
+  Returns:
+    bool: False if the file can't be mapped or isn't a valid stream
+*/
+bool bakePlayerClass::load(const char *path, uint8_t *outFrame) {
+  fileMapClass file;
+
+  if (!file.map(path, sizeof(bakeHeaderStruct)) || !init((const uint8_t *) file.data(), file.length(), outFrame))
+    return (false);   // file is unmapped when it goes out of scope
+  mapping.adopt(file);  // adopted after init(), which releases any previous mapping
+  return (true);
+}
+#endif  // EFFECT_HOST_MMAP
+
+
+/* bakePlayerClass::decode()
+    Decodes a single frame into the private decode buffer. Except for key frames, the buffer must contain the previous frame. The
+    frame's tokens must lie between its own offset and the next frame's offset (or the offset table), and must cover exactly
+    numPixels pixels.
+  Parameters:
+    uint32_t frame: Frame number
+  Returns:
+    bool: False if the frame data is invalid (the buffer contents are then undefined)
+*/
+bool bakePlayerClass::decode(uint32_t frame) {
+  const uint8_t *src;
+  const uint8_t *srcEnd;
+  uint8_t *dst;
+  uint8_t *end;
+  uint8_t token;
+  uint32_t runBytes;
+  uint8_t bpp;
+
+  bpp = hdr->bytesPerPixel;
+  src = data + frameOffset[frame];
+  srcEnd = (frame < (hdr->numFrames - 1)) ? (data + frameOffset[frame + 1]) : (const uint8_t *) frameOffset;
+  dst = decodeBuf;
+  end = decodeBuf + (hdr->numPixels * bpp);
+  if ((frame % hdr->keyInterval) == 0)  // if key frame
+    memset(decodeBuf, 0, hdr->numPixels * bpp);
+  while (dst < end) {
+    if (src >= srcEnd)
+      return (false);
+    token = *src++;
+    runBytes = ((token & 0x3F) + 1) * bpp;
+    if (runBytes > (uint32_t) (end - dst))  // run extends past the end of the frame
+      return (false);
+    switch (token & 0xC0) {
+      case BAKE_SKIP:
+        dst += runBytes;
+      break;
+      case BAKE_REPEAT:
+        if (bpp > (srcEnd - src))
+          return (false);
+        for (uint32_t n = 0; n < runBytes; n += bpp)
+          memcpy(dst + n, src, bpp);
+        dst += runBytes;
+        src += bpp;
+      break;
+      case BAKE_LITERAL:
+        if (runBytes > (uint32_t) (srcEnd - src))
+          return (false);
+        memcpy(dst, src, runBytes);
+        dst += runBytes;
+        src += runBytes;
+      break;
+      default:    // invalid token
+        return (false);
+    }
+  }
+  return (true);
+}
+
+
+/* bakePlayerClass::step()
+    Called once per step period (frame) to decode the next frame and copy it to the caller's frame buffer. When the loop end frame
+    has been decoded, playback continues at the loop start frame (if loop == true) or stops.
+  Parameters: None
+  Returns:
+    bool: True if a frame was decoded; false at the end of a non-looping stream, or if the frame data is invalid
+*/
+bool bakePlayerClass::step() {
+  uint32_t startTime;
+
+  if (data == NULL)
+    return (false);
+  if (curFrame > hdr->loopEnd) {
+    if (!loop)
+      return (false);
+    seek(hdr->loopStart);
+  }
+  startTime = micros();
+  if (!decode(curFrame++))
+    return (false);   // frame buffer is left unchanged
+  memcpy(frameBuf, decodeBuf, hdr->numPixels * hdr->bytesPerPixel);
+  lastDecodeUs = micros() - startTime;
+  return (true);
+}
+
+
+/* bakePlayerClass::seek()
+    Positions playback so that the next call to step() decodes the specified frame. Decodes from the preceding key frame up to
+    (but not including) the specified frame.
+  Parameters:
+    uint32_t frame: Frame number (0 - (frameCount() - 1))
+  Returns: None
+*/
+void bakePlayerClass::seek(uint32_t frame) {
+  if (data == NULL)
+    return;
+  frame = min(frame, hdr->numFrames - 1);
+  for (curFrame = frame - (frame % hdr->keyInterval); curFrame < frame; curFrame++)
+    decode(curFrame);
+}
+
+
+/* bakePlayerClass::bytesPerFrame()
+    Returns the average encoded size of each frame
+  Parameters: None
+  Returns:
+    float: Average bytes per frame
+*/
+float bakePlayerClass::bytesPerFrame() {
+  if (data == NULL)
+    return (0);
+  return ((float) ((const uint8_t *) frameOffset - (data + frameOffset[0])) / hdr->numFrames);
+}
@@ -0,0 +1,271 @@
+/* CUE.CPP
+    This module defines the cuePlayerClass, which plays a show described by a binary cue image instead of hand-coded calls to each
+    effect's start() function. A cue image is generated from a text description by the host tool tools/cue_compile.py, and contains:
+      - a cueHeaderStruct
+      - a slot table, giving the effect class (cueOpEnum) expected in each effect slot
+      - an array of fixed-size cueStruct records sorted by step number, each of which starts (or stops) the effect in one slot with
+        literal start() parameters
+    The image is interpreted in place: attach() only validates it, and step() reads the cue records directly, so a show can be
+    placed in flash (as a const PROGMEM array generated by the compiler) or memory-mapped from a file on a host build with
+    EFFECT_HOST_MMAP defined (see load()), with no heap allocation or parse step. Switching shows only requires attaching a
+    different image; the slot bindings are kept.
+
+    Typical use:
+      cues.bind(0, flow);     // effect objects are bound to slots once
+      cues.bind(1, pop);
+      cues.attach(myShow, sizeof(myShow));
+      cues.play();
+      ...
+      cues.step();            // once per frame, before the effects are stepped
+      flow.step();
+      pop.step();
+
+    Cues whose slot isn't bound to an effect of the class in the slot table are skipped (and counted by skippedCues()). Droplet cues
+    require the dropletClass to have been configured with dropletClass::init().
+
+    Cue times are compiled to step numbers using the step period declared in the image, so attach() and play() reject an image whose
+    step period doesn't match the player's render context (defaultContext unless bindContext() is used; it should be the context
+    that the slot effects are bound to). Otherwise the show would run at the wrong speed, relative to the effect durations.
+*/
+#include <Arduino.h>
+#include "Cue.h"
+
+
+/* cuePlayerClass::cuePlayerClass()
+    Constructor: no image attached and no slots bound
+*/
+cuePlayerClass::cuePlayerClass() {
+  header = NULL;
+  slotType = NULL;
+  cue = NULL;
+  for (uint8_t s = 0; s < cueMaxSlots; s++) {
+    slotFx[s] = NULL;
+    boundType[s] = CUE_NUM_OPS;
+  }
+  nextCue = 0;
+  stepNum = 0;
+  skipped = 0;
+  playing = false;
+  ctx = &defaultContext;
+}
+
+
+/* cuePlayerClass::periodMatches()
+    Checks the step period of a cue image against the player's render context
+  Parameters:
+    const cueHeaderStruct *hdr: Image header
+  Returns:
+    bool: True if the step periods are equal (within float rounding)
+*/
+bool cuePlayerClass::periodMatches(const cueHeaderStruct *hdr) {
+  return (fabs(hdr->stepPeriod - ctx->stepPeriod) <= (ctx->stepPeriod * 0.0001));
+}
+
+
+/* cuePlayerClass::release()
+    Stops the show and detaches the image, releasing any mapping created by load()
+  Parameters: None
+  Returns: None
+*/
+void cuePlayerClass::release() {
+  playing = false;
+  header = NULL;
+  slotType = NULL;
+  cue = NULL;
+#ifdef EFFECT_HOST_MMAP
+  mapping.unmap();
+#endif
+}
+
+
+/* cuePlayerClass::attach()
+    Attaches a cue image, which must be 4-byte aligned and remain valid while attached. Any show that was playing is stopped.
+  Parameters:
+    const void *image: Start of the image
+    uint32_t size: Size of the image (bytes)
+  Returns:
+    bool: False if the image is invalid, or its step period doesn't match the render context (no image is then attached)
+*/
+bool cuePlayerClass::attach(const void *image, uint32_t size) {
+  const cueHeaderStruct *hdr;
+  const cueStruct *c;
+  const uint8_t *types;
+
+  release();
+  hdr = (const cueHeaderStruct *) image;
+  if ((image == NULL) || (((uintptr_t) image & 3) != 0) || (size < sizeof(cueHeaderStruct)))
+    return (false);
+  if ((hdr->magic != cueMagic) || (hdr->version != cueVersion) || (hdr->imageSize > size) || (hdr->numSlots > cueMaxSlots))
+    return (false);
+  if (!periodMatches(hdr))
+    return (false);
+    // the slot table and cue array must fit within the image; compared against (imageSize - offset) so that a huge offset can't
+    // wrap around
+  if ((hdr->slotOffset > hdr->imageSize) || (hdr->numSlots > (hdr->imageSize - hdr->slotOffset)) || ((hdr->cueOffset & 3) != 0) ||
+      (hdr->cueOffset > hdr->imageSize) || (hdr->numCues > ((hdr->imageSize - hdr->cueOffset) / sizeof(cueStruct))))
+    return (false);
+  types = (const uint8_t *) image + hdr->slotOffset;
+  c = (const cueStruct *) ((const uint8_t *) image + hdr->cueOffset);
+  for (uint32_t n = 0; n < hdr->numCues; n++) {    // validate cues, so that step() doesn't need to
+    if ((c[n].op >= CUE_NUM_OPS) || (c[n].slot >= hdr->numSlots) || (c[n].numParams > cueMaxParams))
+      return (false);
+    if ((c[n].op != CUE_STOP) && (c[n].op != types[c[n].slot]))
+      return (false);
+    if ((n > 0) && (c[n].step < c[n - 1].step))
+      return (false);
+  }
+  header = hdr;
+  slotType = types;
+  cue = c;
+  nextCue = 0;
+  stepNum = 0;
+  return (true);
+}
+
+
+#ifdef EFFECT_HOST_MMAP
+/* cuePlayerClass::load()
+    Host builds only: memory-maps a cue image file (read-only) and attaches it. The mapping is released by a subsequent attach() or
+    load().
+  Parameters:
+    const char *path: Path of the image file
+  Returns:
+    bool: False if the file can't be mapped or isn't a valid image
+*/
+bool cuePlayerClass::load(const char *path) {
+  fileMapClass file;
+
+  release();
+  if (!file.map(path, sizeof(cueHeaderStruct)) || !attach(file.data(), file.length()))
+    return (false);   // file is unmapped when it goes out of scope
+  mapping.adopt(file);  // adopted after attach(), which releases any previous mapping
+  return (true);
+}
+#endif  // EFFECT_HOST_MMAP
+
+
+/* cuePlayerClass::bindSlot()
+    Binds an effect object to a slot (called by the bind() overloads)
+  Parameters:
+    uint8_t slot: Slot number
+    effect *fx: Effect object
+    uint8_t type: Class of the effect (cueOpEnum)
+  Returns: None
+*/
+void cuePlayerClass::bindSlot(uint8_t slot, effect *fx, uint8_t type) {
+  if (slot >= cueMaxSlots)
+    return;
+  slotFx[slot] = fx;
+  boundType[slot] = type;
+}
+
+
+/* cuePlayerClass::unboundSlots()
+    Checks the slot bindings against the slot table of the attached image
+  Parameters: None
+  Returns:
+    uint8_t: Number of slots that aren't bound to an effect of the class required by the image
+*/
+uint8_t cuePlayerClass::unboundSlots() {
+  uint8_t count = 0;
+
+  if (header == NULL)
+    return (0);
+  for (uint8_t s = 0; s < header->numSlots; s++) {
+    if (boundType[s] != slotType[s])
+      count++;
+  }
+  return (count);
+}
+
+
+/* cuePlayerClass::play()
+    Starts (or restarts) the attached show from step 0. The step period is checked again, in case the render context's step period
+    has changed since the image was attached.
+  Parameters: None
+  Returns:
+    bool: False if no image is attached, or its step period doesn't match the render context (the show is then not playing)
+*/
+bool cuePlayerClass::play() {
+  nextCue = 0;
+  stepNum = 0;
+  skipped = 0;
+  playing = (header != NULL) && periodMatches(header);
+  return (playing);
+}
+
+
+/* cuePlayerClass::step()
+    Called once per step period (frame) to execute the cues for the current step, if playing. The show is done after the last cue.
+  Parameters: None
+  Returns: None
+*/
+void cuePlayerClass::step() {
+  if (!playing)
+    return;
+  while ((nextCue < header->numCues) && (cue[nextCue].step <= stepNum))
+    execute(cue[nextCue++]);
+  stepNum++;
+  if (nextCue >= header->numCues)
+    playing = false;
+}
+
+
+/* cuePlayerClass::execute()
+    Executes a single cue
+  Parameters:
+    const cueStruct &c: Cue
+  Returns: None
+*/
+void cuePlayerClass::execute(const cueStruct &c) {
+  const float *p = c.param;
+  effect *fx;
+
+  fx = slotFx[c.slot];
+  if ((fx == NULL) || (boundType[c.slot] != slotType[c.slot])) {
+    skipped++;
+    return;
+  }
+  switch (c.op) {
+    case CUE_RAMP:
+      if (c.numParams >= 3)
+        ((rampClass *) fx)->start(p[0], p[1], p[2]);
+      else if (c.numParams == 2)
+        ((rampClass *) fx)->start(p[0], p[1]);
+      else
+        ((rampClass *) fx)->start(p[0]);
+      break;
+    case CUE_FLOW:
+      ((flowClass *) fx)->start(p[0], p[1], p[2]);
+      break;
+    case CUE_WAVE:
+      if (c.numParams >= 4)   // travelling wave: duration, wavelength, speed, amplitude
+        ((waveClass *) fx)->start(p[0], p[1], p[2], p[3]);
+      else    // duration, frequency, amplitude
+        ((waveClass *) fx)->start(p[0], p[1], p[2]);
+      break;
+    case CUE_WAVELET:
+      ((waveletClass *) fx)->start(p[0], p[1], p[2], p[3], p[4], p[5]);
+      break;
+    case CUE_DROPLET:
+      ((dropletClass *) fx)->start(p[0]);
+      break;
+    case CUE_POP:
+      ((popClass *) fx)->start(p[0], {p[1], p[2]}, p[3], p[4]);
+      break;
+    case CUE_WIPE:
+      ((wipeClass *) fx)->start(p[0], {p[1], p[2]}, p[3], p[4], p[5]);
+      break;
+    case CUE_FLICKER:
+      ((flickerClass *) fx)->start(p[0], p[1], p[2], p[3]);
+      break;
+    case CUE_WAIT:
+      ((waitClass *) fx)->start(p[0]);
+      break;
+    case CUE_STOP:
+      fx->active = false;
+      break;
+    default:
+      skipped++;
+  }
+}
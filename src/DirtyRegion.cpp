@@ -0,0 +1,151 @@
+/* DIRTYREGION.CPP
+    This module defines the dirtyRegionClass, which accumulates the range of pixels in a linear strip whose output has changed in the
+    current frame, based on the spans reported by effect::changed() for the effects rendered into the strip. The output stage can
+    then re-render only pixels firstPixel() - lastPixel(), and skip transmitting the strip entirely when isDirty() is false.
+
+    Typical use, once per frame after all effects have been stepped:
+      region.clear();
+      region.add(flow);
+      region.add(wave);
+      if (region.isDirty()) { render pixels region.firstPixel() to region.lastPixel(), then show the strip }
+
+    effect::changed() reports the change since its previous call, so it must be called only once per frame for each effect. When
+    the same effect is rendered into several strips, their regions share a changeCacheClass (passed to init()), which calls
+    changed() for the first region that adds the effect in a frame and returns the same result to the others:
+      cache.clear();
+      regionA.clear();
+      regionB.clear();
+      regionA.add(flow);    // calls flow.changed()
+      regionB.add(flow);    // same span, from the cache
+
+    add() only converts spans expressed as a position along the strip (SPAN_LINEAR: e.g. flowClass, dropletClass, rampClass). A span
+    in other coordinates (SPAN_RADIAL: popClass distance from center; SPAN_LINE_DIST: wipeClass distance from the wipe line) can't be
+    converted here, so add() rejects the span and marks the whole strip dirty instead. For a tighter region, the caller can query such
+    an effect with changed() itself, convert the span, and pass it to addSpan() or addPixels().
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "DirtyRegion.h"
+#include <float.h>
+
+
+/* changeCacheClass::query()
+    Returns the result of effect::changed() for an effect in the current frame, calling changed() only the first time the effect is
+    queried after clear(). If the cache is full, changed() isn't called and the entire span is reported; the effect's next call
+    to changed() then reports the change over both frames.
+  Parameters:
+    effect &fx: Effect to query
+    float *spanStart: Set to the start of the changed span (see effect::changed())
+    float *spanEnd: Set to the end of the changed span
+  Returns:
+    spanKindEnum: Coordinates of the span, or SPAN_NONE if the output didn't change
+*/
+spanKindEnum changeCacheClass::query(effect &fx, float *spanStart, float *spanEnd) {
+  effectChangeStruct *e;
+
+  for (uint8_t n = 0; n < numEntries; n++) {
+    if (entry[n].fx == &fx) {
+      *spanStart = entry[n].spanStart;
+      *spanEnd = entry[n].spanEnd;
+      return (entry[n].kind);
+    }
+  }
+  if (numEntries >= changeCacheSize) {
+    *spanStart = -FLT_MAX;
+    *spanEnd = FLT_MAX;
+    return (SPAN_LINEAR);
+  }
+  e = &entry[numEntries++];
+  e->fx = &fx;
+  e->kind = fx.changed(&e->spanStart, &e->spanEnd);
+  *spanStart = e->spanStart;
+  *spanEnd = e->spanEnd;
+  return (e->kind);
+}
+
+
+/* dirtyRegionClass::init()
+    Defines the strip geometry used to convert effect spans to pixel numbers
+  Parameters:
+    uint16_t numPix: Number of pixels in the strip
+    float pixSpacing: Distance between pixels (mm)
+    float originPos: Position (mm) of pixel 0, in the coordinates used by the effects
+    changeCacheClass *changeCache: changed() results shared with the regions of other strips that show the same effects, or
+      NULL (default) if add() calls effect::changed() directly
+  Returns: None
+*/
+void dirtyRegionClass::init(uint16_t numPix, float pixSpacing, float originPos, changeCacheClass *changeCache) {
+  numPixels = numPix;
+  spacing = max(pixSpacing, 0.001);
+  origin = originPos;
+  dirty = false;
+  cache = changeCache;
+}
+
+
+/* dirtyRegionClass::add()
+    Queries an effect with effect::changed() (through the shared changeCacheClass, if one was passed to init()), and adds the
+    changed span (if any) to the dirty region. Without a cache, an effect should be added to only one region per frame, since
+    changed() compares with the state at the previous call. A span that isn't a position along the strip
+    (anything other than SPAN_LINEAR) is rejected, and the whole strip is marked dirty.
+  Parameters:
+    effect &fx: Effect rendered into the strip
+  Returns:
+    bool: True if the effect output changed
+*/
+bool dirtyRegionClass::add(effect &fx) {
+  float spanStart, spanEnd;
+  spanKindEnum kind;
+
+  kind = (cache != NULL) ? cache->query(fx, &spanStart, &spanEnd) : fx.changed(&spanStart, &spanEnd);
+  if (kind == SPAN_NONE)
+    return (false);
+  if (kind == SPAN_LINEAR)
+    addSpan(spanStart, spanEnd);
+  else    // radial or line-distance span: not convertible to strip pixels
+    addAll();
+  return (true);
+}
+
+
+/* dirtyRegionClass::addSpan()
+    Adds a span of positions to the dirty region. The span is extended to include the pixels on either side of each end.
+  Parameters:
+    float spanStart: Start of the changed span (mm)
+    float spanEnd: End of the changed span (mm)
+  Returns: None
+*/
+void dirtyRegionClass::addSpan(float spanStart, float spanEnd) {
+  float firstPix, lastPix;
+
+  if ((numPixels == 0) || (spanEnd < spanStart))
+    return;
+  firstPix = floor((spanStart - origin) / spacing);
+  lastPix = ceil((spanEnd - origin) / spacing);
+  if ((lastPix < 0) || (firstPix > (numPixels - 1)))   // span doesn't overlap the strip
+    return;
+  addPixels((uint16_t) max(firstPix, 0), (uint16_t) min(lastPix, numPixels - 1));
+}
+
+
+/* dirtyRegionClass::addPixels()
+    Adds a range of pixels to the dirty region
+  Parameters:
+    uint16_t firstPix: First pixel in the range
+    uint16_t lastPix: Last pixel in the range (inclusive)
+  Returns: None
+*/
+void dirtyRegionClass::addPixels(uint16_t firstPix, uint16_t lastPix) {
+  if ((numPixels == 0) || (lastPix < firstPix))
+    return;
+  lastPix = min(lastPix, numPixels - 1);
+  if (!dirty) {
+    first = firstPix;
+    last = lastPix;
+    dirty = true;
+  }
+  else {
+    first = min(first, firstPix);
+    last = max(last, lastPix);
+  }
+}
@@ -11,16 +11,18 @@
   Returns: None
 */
 void dropletClass::start(float dist) {
-  deltaDist = config->initVelocity * stepPeriod;    // convert initial velocity to distance per step (mm/step)
-  accelDelta = config->acceleration * pow(stepPeriod, 2);  // convert accel (mm/sec^2) to (mm/step^2)
-  tailLength = random(config->minTailLength, config->maxTailLength);  // compute random tail length
+  deltaDist = config->initVelocity * ctx->stepPeriod;    // convert initial velocity to distance per step (mm/step)
+  accelDelta = config->acceleration * pow(ctx->stepPeriod, 2);  // convert accel (mm/sec^2) to (mm/step^2)
+  tailLength = ctx->random(config->minTailLength, config->maxTailLength);  // compute random tail length
     // compute total distance for leading edge to travel so that the tail goes "off the end"
   distance = dist + config->headRampLen + config->headLength + tailLength;
   headSlope = 1 / config->headRampLen;      // droplet value() goes from 0 to 1 in length of head ramp
   tailSlope = 1 / tailLength;               // droplet value9) goes from 1 to 0 in length of tail ramp
   curPos = 0;
   completedFlag = false;
+  lastActive = false;   // report the full span as changed after a (re)start
   active = true;
+  prepareFrame();
 }
 
 
@@ -37,11 +39,23 @@ void dropletClass::step() {
       completedFlag = true;
       active = false;
     }
-
+    prepareFrame();
   }
 }
 
 
+/* dropletClass::prepareFrame()
+    Caches the frame-constant terms used by value(), so that the per-pixel path doesn't re-read the config structure
+  Parameters: None
+  Returns: None
+*/
+void dropletClass::prepareFrame() {
+  headRampLen = config->headRampLen;
+  headEnd = config->headRampLen + config->headLength;
+  tailPos = curPos - headEnd - tailLength;
+}
+
+
 /* droletClass::value()
     Returns the value of the flow (linear ramp) function (in range 0 - 1) at a specified offset from the flow origin, in the direction 
     of the flow. If the offset is greater than the current position of the ramp leading edge, a value of 0 is returned. If the offset
@@ -59,12 +73,12 @@ float dropletClass::value(float offset) {
   relOffsetHead = curPos - offset;  // find distance from leading edge (curPos) to specified offset
   if ((relOffsetHead <= 0) || (offset < 0))   // if the droplet leading edge hasn't reached the offset position
     return (0);
-  relOffsetTail = (curPos - config->headRampLen - config->headLength - tailLength) - offset;  // find distance from trailing edge to offset
+  relOffsetTail = tailPos - offset;  // find distance from trailing edge to offset
   if (relOffsetTail > 0)    // if the droplet tail has fully passed the offset position
     return (0);
-  if (relOffsetHead < config->headRampLen)    // if offset is within leading edge ramp
+  if (relOffsetHead < headRampLen)    // if offset is within leading edge ramp
     return (relOffsetHead * headSlope);       // return value based on leading edge ramp slope
-  if (relOffsetHead < (config->headLength + config->headRampLen))   // if offset is within droplet head
+  if (relOffsetHead < headEnd)   // if offset is within droplet head
     return (1.0);      // value() is 1.0 within head
   else              // else offset is witin the tail
     return (-relOffsetTail * tailSlope);
@@ -85,4 +99,24 @@ bool dropletClass::completed() {
   retVal = completedFlag;
   completedFlag = false;
   return retVal;
+}
+
+
+/* dropletClass::changed()
+    Reports the span of offsets where value() may have changed since the previous call (see effect::changed()): from the previous
+    position of the tail to the current position of the head.
+  Parameters:
+    float *spanStart: Set to the start of the changed span (mm)
+    float *spanEnd: Set to the end of the changed span (mm)
+  Returns:
+    spanKindEnum: SPAN_LINEAR, or SPAN_NONE if the output didn't change
+*/
+spanKindEnum dropletClass::changed(float *spanStart, float *spanEnd) {
+  if (active && lastActive) {
+      // distance moved in the last step is (deltaDist - accelDelta), since deltaDist is updated after curPos
+    *spanStart = tailPos - (deltaDist - accelDelta);
+    *spanEnd = curPos;
+    return (SPAN_LINEAR);
+  }
+  return (effect::changed(spanStart, spanEnd));
 }
\ No newline at end of file
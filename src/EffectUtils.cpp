@@ -1,22 +1,82 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
-
-  // static member of effect class, declared here and initialized to default that can be overridden with call to
-  //  effect::SetStepPeriod()
-float effect::stepPeriod = defaultStepPeriod;
-
+#include <float.h>
 
 /* effect::ComputeSteps()
-    Computes the number of effect steps (based on stepPeriod) in a specified duration
+    Computes the number of effect steps (based on the step period of the effect's render context) in a specified duration
     Parameters:
       float duration: 
     Returns:
-      uint16_t: Number of stepPeriod steps in duration. Returns 0 if (duration == 0); otherwise return value is >= 1
+      uint16_t: Number of step periods in duration. Returns 0 if (duration == 0); otherwise return value is >= 1
 */
 uint16_t effect::ComputeSteps(float duration) { 
   if (duration < 0.01)  // if duration is very close to 0
     return 0; 
   else
-    return (uint16_t) ceil(duration / stepPeriod); 
+    return (uint16_t) ceil(duration / ctx->stepPeriod); 
 } 
 
+
+/* effect::ComputeRampSteps()
+    Computes the number of steps in each phase of a trapezoidal ramp function. If the duration is too short to accommodate the full
+    ramp-up and ramp-down, both ramps are truncated at the time where they intersect, and the ramp peaks below 1.0.
+    Parameters:
+      float duration: Total duration of the ramp function (seconds), including all three phases. 0 specifies a ramp-up phase followed
+                      by an infinite-duration hold phase
+      float rampUpTime: Nominal duration of the ramp-up phase (seconds)
+      float rampDownTime: Nominal duration of the ramp-down phase (seconds)
+    Returns:
+      rampStepsStruct: Step counts and ramp-up slope
+*/
+rampStepsStruct effect::ComputeRampSteps(float duration, float rampUpTime, float rampDownTime) {
+  rampStepsStruct steps;
+  float rampTime;    // potentially-constrained ramp time
+
+  if (duration == 0) {  // if ramp has infinite duration
+    steps.upSteps = ComputeSteps(rampUpTime);  // number of steps in ramp-up
+    steps.holdSteps = 0;  // hold phase has infinite duration after ramp up
+    steps.downSteps = 0;
+  }
+  else {  // finite duration ramp
+    if (duration < (rampUpTime + rampDownTime)) {   // if duration is to short to accommodate full ramp-up/down
+        // compute time at intersection of up and down ramps, constrained by total duration
+      rampTime = ((-1/rampDownTime) * duration) / ((-1/rampDownTime) - (1/rampUpTime));
+      steps.upSteps = ComputeSteps(rampTime);   // truncated ramp-up duration (steps)
+      steps.downSteps = ComputeSteps(duration - rampTime);  // remaining time used for down ramp
+      steps.holdSteps = 1;  // bare-minimum hold phase, to avoid implementing infinite hold (holdSteps == 0)
+    }
+    else {  // duration is long enough to accommodate full ramp up/down
+      steps.upSteps = ComputeSteps(rampUpTime);
+      steps.downSteps = ComputeSteps(rampDownTime);
+      steps.holdSteps = max(ComputeSteps(duration - rampUpTime - rampDownTime), 1);   // ensure at least 1 hold step
+    }
+  }
+  steps.upDelta = (steps.upSteps == 0) ? 0 : (1.0 / (float) ComputeSteps(rampUpTime)); // slope based on non-truncated duration
+  return (steps);
+}
+
+
+/* effect::changed()
+    Reports whether the effect output may have changed since the previous call to changed(), which is normally called once per frame
+    after step(). The output stage can use this to skip re-rendering and re-transmitting pixels whose values haven't changed. This
+    default implementation reports the entire span whenever the effect is active, and once more when it becomes inactive. Derived
+    classes whose output changes over a limited span (e.g. flowClass) or only occasionally (e.g. rampClass) override it, and report
+    the coordinates of the span with the return value. The entire span is reported as SPAN_LINEAR, since it covers every position in
+    any coordinates.
+    Parameters:
+      float *spanStart: Set to the start of the changed span, in the units of the effect's value function (e.g. mm)
+      float *spanEnd: Set to the end of the changed span
+    Returns:
+      spanKindEnum: Coordinates of the span (e.g. SPAN_LINEAR), or SPAN_NONE (0) if the output didn't change, in which case
+        *spanStart and *spanEnd are not meaningful
+*/
+spanKindEnum effect::changed(float *spanStart, float *spanEnd) {
+  bool retVal;
+
+  retVal = active || lastActive;  // output changes while active, and when it returns to 0
+  lastActive = active;
+  *spanStart = -FLT_MAX;
+  *spanEnd = FLT_MAX;
+  return (retVal ? SPAN_LINEAR : SPAN_NONE);
+}
+
@@ -0,0 +1,220 @@
+/* ENVELOPEBANK.CPP
+    This module defines the envelopeBankClass, which implements a bank of independent trapezoidal envelopes with the same behavior as
+    rampClass (ramp-up, hold, ramp-down, with both ramps truncated when the duration is too short, and an infinite hold when the
+    duration is 0). It is intended for effects that need thousands of short envelopes, such as per-pixel sparkles or triggered
+    "notes", where an array of rampClass objects would be stepped through a switch on each object's phase.
+
+    The phase durations are computed by effect::ComputeRampSteps(), the same function used by rampClass::start(). The state of each
+    envelope is held in separate arrays, and step() evaluates each envelope in closed form from the number of steps k since it was
+    started, in a single loop with no per-envelope branches:
+      up = upBias + (k * upDelta)
+      down = peak - (max(k - holdEnd, 0) * downDelta)
+      val = (k < envEnd) ? constrain(min(up, down), 0, peak) : 0
+    The result matches the step-by-step accumulation in rampClass::step() to within float rounding.
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "EnvelopeBank.h"
+#include "Trace.h"
+
+
+/* envelopeBankClass::freeArrays()
+    Frees the per-envelope arrays allocated by init()
+  Parameters: None
+  Returns: None
+*/
+void envelopeBankClass::freeArrays() {
+  delete [] startStep;
+  delete [] holdEnd;
+  delete [] envEnd;
+  delete [] upBias;
+  delete [] upDelta;
+  delete [] peak;
+  delete [] downDelta;
+  delete [] val;
+  startStep = NULL;
+  holdEnd = NULL;
+  envEnd = NULL;
+  upBias = NULL;
+  upDelta = NULL;
+  peak = NULL;
+  downDelta = NULL;
+  val = NULL;
+}
+
+
+/* envelopeBankClass::init()
+    Allocates the per-envelope state. All envelopes are initially inactive, with val = 0.
+  Parameters:
+    uint32_t numEnvelopes: Number of envelopes in the bank
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool envelopeBankClass::init(uint32_t numEnvelopes) {
+  freeArrays();
+  numEnv = numEnvelopes;
+  bankStep = 0;
+  endStep = 0;
+  nextFree = 0;
+  active = false;
+  startStep = new uint32_t [numEnv];
+  holdEnd = new uint32_t [numEnv];
+  envEnd = new uint32_t [numEnv];
+  upBias = new float [numEnv];
+  upDelta = new float [numEnv];
+  peak = new float [numEnv];
+  downDelta = new float [numEnv];
+  val = new float [numEnv];
+  if ((startStep == NULL) || (holdEnd == NULL) || (envEnd == NULL) || (upBias == NULL) || (upDelta == NULL) || (peak == NULL) ||
+      (downDelta == NULL) || (val == NULL)) {
+    freeArrays();
+    numEnv = 0;
+    return (false);
+  }
+  for (uint32_t n = 0; n < numEnv; n++) {
+    startStep[n] = 0;
+    holdEnd[n] = 0;
+    envEnd[n] = 0;    // inactive
+    upBias[n] = 0;
+    upDelta[n] = 0;
+    peak[n] = 0;
+    downDelta[n] = 0;
+    val[n] = 0;
+  }
+  return (true);
+}
+
+
+/* envelopeBankClass::setRamp()
+    Sets the default ramp-up and ramp-down durations used by start(env, duration) and startFree()
+  Parameters:
+    float rampUpDur: Duration of the ramp-up phase (seconds)
+    float rampDownDur: Duration of the ramp-down phase (seconds)
+  Returns: None
+*/
+void envelopeBankClass::setRamp(float rampUpDur, float rampDownDur) {
+  rampUpTime = max(0, rampUpDur);
+  rampDownTime = max(0, rampDownDur);
+}
+
+
+/* envelopeBankClass::start()
+    Starts (or restarts) one envelope
+  Parameters:
+    uint32_t env: Envelope number
+    float duration: Total duration of the envelope, including all three phases. 0 specifies a ramp-up phase followed by an
+                    infinite-duration hold phase (until stop() is called)
+    float rampUpDur: Duration of the ramp-up phase (seconds)
+    float rampDownDur: Duration of the ramp-down phase (seconds)
+  Returns: None
+*/
+void envelopeBankClass::start(uint32_t env, float duration, float rampUpDur, float rampDownDur) {
+  rampStepsStruct steps;
+
+  if (env >= numEnv)
+    return;
+  steps = ComputeRampSteps(duration, max(0, rampUpDur), max(0, rampDownDur));
+  startStep[env] = bankStep;
+  if (steps.upSteps == 0) {   // if no ramp-up phase, start at the hold value
+    upBias[env] = 1.0;
+    upDelta[env] = 0;
+    peak[env] = 1.0;
+  }
+  else {
+    upBias[env] = 0;
+    upDelta[env] = steps.upDelta;
+    peak[env] = min(steps.upSteps * steps.upDelta, 1.0);  // value reached at the end of a (possibly truncated) ramp-up
+  }
+  if (steps.holdSteps == 0) {   // if infinite hold
+    holdEnd[env] = envInfinite;
+    envEnd[env] = envInfinite;
+    downDelta[env] = 0;
+  }
+  else {
+    holdEnd[env] = steps.upSteps + steps.holdSteps;
+    envEnd[env] = holdEnd[env] + steps.downSteps;
+    downDelta[env] = (steps.downSteps == 0) ? 0 : (1.0 / (float) steps.downSteps);
+    endStep = max(endStep, bankStep + envEnd[env]);
+  }
+  val[env] = upBias[env];
+  active = true;
+}
+
+
+/* envelopeBankClass::start() [Overload]
+    Starts (or restarts) one envelope, using the ramp durations set by setRamp()
+  Parameters:
+    uint32_t env: Envelope number
+    float duration: Total duration of the envelope (0 for infinite hold)
+  Returns: None
+*/
+void envelopeBankClass::start(uint32_t env, float duration) {
+  start(env, duration, rampUpTime, rampDownTime);
+}
+
+
+/* envelopeBankClass::startFree()
+    Starts the next inactive envelope (searching round-robin from the envelope after the one last started by this function), using
+    the ramp durations set by setRamp(). Used to trigger short "notes" without tracking which envelopes are in use.
+  Parameters:
+    float duration: Total duration of the envelope (0 for infinite hold)
+  Returns:
+    int32_t: Envelope number, or -1 if all envelopes are active
+*/
+int32_t envelopeBankClass::startFree(float duration) {
+  uint32_t env;
+
+  for (uint32_t n = 0; n < numEnv; n++) {
+    env = (nextFree + n) % numEnv;
+    if (!envActive(env)) {
+      start(env, duration);
+      nextFree = (env + 1) % numEnv;
+      return ((int32_t) env);
+    }
+  }
+  return (-1);
+}
+
+
+/* envelopeBankClass::stop()
+    Immediately terminates an envelope (e.g. one with an infinite hold), setting its value to 0
+  Parameters:
+    uint32_t env: Envelope number
+  Returns: None
+*/
+void envelopeBankClass::stop(uint32_t env) {
+  if (env < numEnv) {
+    envEnd[env] = 0;
+    val[env] = 0;
+  }
+}
+
+
+/* envelopeBankClass::step()
+    Called once per step period (frame) to update the value of every envelope, if any envelope is active
+  Parameters: None
+  Returns: None
+*/
+void envelopeBankClass::step() {
+  uint32_t k;
+  float up, down, v;
+  bool infinite;
+
+  if (active) {
+    TRACE_BEGIN(TRACE_STEP, traceLibId);
+    bankStep++;
+    infinite = false;
+    for (uint32_t n = 0; n < numEnv; n++) {
+      k = bankStep - startStep[n];    // steps since start
+      up = upBias[n] + ((float) k * upDelta[n]);
+      down = peak[n] - ((float) ((k > holdEnd[n]) ? (k - holdEnd[n]) : 0) * downDelta[n]);
+      v = (up < down) ? up : down;
+      v = (v < 0) ? 0 : ((v > peak[n]) ? peak[n] : v);
+      val[n] = (k < envEnd[n]) ? v : 0;
+      infinite |= (envEnd[n] == envInfinite);
+    }
+    if (!infinite && ((int32_t) (bankStep - endStep) >= 0))  // if all envelopes are done
+      active = false;
+    TRACE_END(TRACE_STEP, traceLibId);
+  }
+}
@@ -0,0 +1,210 @@
+/* FADEBANK.CPP
+    This module defines the fadeBankClass, which performs independent linear HSI fades on every pixel of an array of hsiF colors.
+    It replaces an array of fadeClass objects (one per pixel), and follows the same rules: a fade from "off" (i < 0.1) is in
+    brightness only, using the hue and saturation of the target color, and a fade to "off" keeps the hue and saturation of the
+    current color.
+
+    The fade state of each pixel is held in separate arrays (start color, total change, start step and 1/steps), and step()
+    evaluates each fading pixel in closed form from the bank step count:
+      frac = min((bankStep - startStep) / steps, 1)
+      color = start + (dist * frac), with the hue wrapped to 0 - 1 (excluding 1.0) by conditional selects
+    Each pixel may be given a delay before its fade starts, so fades can be staggered across the array. Pixels with a delayed or
+    in-progress fade are held in an active list, and step() only visits those: a pixel is written from the step its fade starts to
+    the step it finishes (when it is removed from the list), so idle pixels cost nothing and are never overwritten.
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "FadeBank.h"
+#include "Trace.h"
+
+
+/* fadeBankClass::freeArrays()
+    Frees the per-pixel arrays allocated by init()
+  Parameters: None
+  Returns: None
+*/
+void fadeBankClass::freeArrays() {
+  delete [] startStep;
+  delete [] invSteps;
+  delete [] startH;
+  delete [] startS;
+  delete [] startI;
+  delete [] distH;
+  delete [] distS;
+  delete [] distI;
+  delete [] activeList;
+  delete [] listPos;
+  startStep = NULL;
+  invSteps = NULL;
+  startH = NULL;
+  startS = NULL;
+  startI = NULL;
+  distH = NULL;
+  distS = NULL;
+  distI = NULL;
+  activeList = NULL;
+  listPos = NULL;
+  numListed = 0;
+}
+
+
+/* fadeBankClass::init()
+    Allocates the per-pixel fade state for an array of colors. Each pixel initially holds its current color.
+  Parameters:
+    uint16_t numPix: Number of pixels in the array
+    hsiF *pixColors: Pointer to the array of colors to be faded
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool fadeBankClass::init(uint16_t numPix, hsiF *pixColors) {
+  freeArrays();
+  colors = pixColors;
+  numPixels = numPix;
+  active = false;
+  bankStep = 0;
+  startStep = new uint32_t [numPixels];
+  invSteps = new float [numPixels];
+  startH = new float [numPixels];
+  startS = new float [numPixels];
+  startI = new float [numPixels];
+  distH = new float [numPixels];
+  distS = new float [numPixels];
+  distI = new float [numPixels];
+  activeList = new uint16_t [numPixels];
+  listPos = new uint16_t [numPixels];
+  if ((startStep == NULL) || (invSteps == NULL) || (startH == NULL) || (startS == NULL) || (startI == NULL) || (distH == NULL) ||
+      (distS == NULL) || (distI == NULL) || (activeList == NULL) || (listPos == NULL)) {
+    freeArrays();
+    numPixels = 0;
+    return (false);
+  }
+  for (uint16_t p = 0; p < numPixels; p++) {
+    startStep[p] = 0;
+    invSteps[p] = 1.0;
+    startH[p] = colors[p].h;
+    startS[p] = colors[p].s;
+    startI[p] = colors[p].i;
+    distH[p] = 0;
+    distS[p] = 0;
+    distI[p] = 0;
+    listPos[p] = fadeNotListed;
+  }
+  return (true);
+}
+
+
+/* fadeBankClass::start()
+    Starts a fade of one pixel from its current color to a target color
+  Parameters:
+    uint16_t pixel: Pixel number
+    float duration: Duration of the fade (seconds)
+    hsiF targetColor: The desired color at the end of the fade
+    float delay: Time (seconds) before the fade starts
+    bool useShortestDist: If true, the hue fades in the direction of the shortest distance to the target hue (see fadeClass::start())
+    bool positiveDir: If useShortestDist is false, and positiveDir is true, the hue fades in the positive direction
+  Returns: None
+*/
+void fadeBankClass::start(uint16_t pixel, float duration, hsiF targetColor, float delay, bool useShortestDist, bool positiveDir) {
+  hsiF curColor;
+  uint16_t steps;
+
+  if (pixel >= numPixels)
+    return;
+  curColor = colors[pixel];
+  if (curColor.i < 0.1) {   // if pixel is currently off (or very close to off)
+    curColor.h = targetColor.h;   // then this is a brightness-only fade-in to targetColor
+    curColor.s = targetColor.s;
+  }
+  else if (targetColor.i < 0.1) {   // if target color is off (or very close to off)
+    targetColor.h = curColor.h;   // then this is a brightness-only fade-out
+    targetColor.s = curColor.s;
+  }
+  steps = max(ComputeSteps(duration), 1);
+  startStep[pixel] = bankStep + ComputeSteps(delay);
+  invSteps[pixel] = 1.0 / steps;
+  startH[pixel] = curColor.h;
+  startS[pixel] = curColor.s;
+  startI[pixel] = curColor.i;
+  distH[pixel] = HueDistance(curColor.h, targetColor.h, useShortestDist, positiveDir);
+  distS[pixel] = targetColor.s - curColor.s;
+  distI[pixel] = targetColor.i - curColor.i;
+  if (listPos[pixel] == fadeNotListed) {  // a pixel that is already fading is restarted in place
+    listPos[pixel] = numListed;
+    activeList[numListed++] = pixel;
+  }
+  active = true;
+}
+
+
+/* fadeBankClass::start() [Overload]
+    Starts a fade of one pixel, using the shortest hue distance
+  Parameters:
+    uint16_t pixel: Pixel number
+    float duration: Duration of the fade (seconds)
+    hsiF targetColor: The desired color at the end of the fade
+    float delay: Time (seconds) before the fade starts
+  Returns: None
+*/
+void fadeBankClass::start(uint16_t pixel, float duration, hsiF targetColor, float delay) {
+  start(pixel, duration, targetColor, delay, true, false);
+}
+
+
+/* fadeBankClass::startAll()
+    Starts a fade of every pixel to the same target color, with the start of each fade staggered along the array
+  Parameters:
+    float duration: Duration of each pixel's fade (seconds)
+    hsiF targetColor: The desired color at the end of the fade
+    float stagger: Delay (seconds) of the last pixel's fade relative to the first; 0 starts all pixels together
+  Returns: None
+*/
+void fadeBankClass::startAll(float duration, hsiF targetColor, float stagger) {
+  float delayPerPixel;
+
+  delayPerPixel = (numPixels > 1) ? (stagger / (numPixels - 1)) : 0;
+  for (uint16_t p = 0; p < numPixels; p++)
+    start(p, duration, targetColor, delayPerPixel * p, true, false);
+}
+
+
+/* fadeBankClass::step()
+    Called once per step period (frame) to update the color of each pixel whose fade has started, and to remove the pixels whose
+    fade has finished from the active list
+  Parameters: None
+  Returns: None
+*/
+void fadeBankClass::step() {
+  float frac, h;
+  uint16_t n, p;
+
+  if (active) {
+    TRACE_BEGIN(TRACE_STEP, traceLibId);
+    bankStep++;
+    n = 0;
+    while (n < numListed) {
+      p = activeList[n];
+      frac = (float) (int32_t) (bankStep - startStep[p]) * invSteps[p];
+      if (frac < 0) {   // fade is delayed: leave the pixel untouched
+        n++;
+        continue;
+      }
+      frac = (frac > 0.99999) ? 1.0 : frac;   // absorb the rounding of steps * (1 / steps); (steps - 1) / steps is always lower
+      h = startH[p] + (distH[p] * frac);
+      h -= (h >= 1.0) ? 1.0 : 0;  // wrap to 0 - 1, excluding 1.0 (compiles to a conditional select, not a branch)
+      h += (h < 0) ? 1.0 : 0;
+      colors[p].h = h;
+      colors[p].s = startS[p] + (distS[p] * frac);
+      colors[p].i = startI[p] + (distI[p] * frac);
+      if (frac == 1.0) {  // fade is done: move the last listed pixel into this position (don't increment n)
+        activeList[n] = activeList[--numListed];
+        listPos[activeList[n]] = n;
+        listPos[p] = fadeNotListed;   // after the move, in case p was the last listed pixel
+      }
+      else
+        n++;
+    }
+    if (numListed == 0)   // if all fades are done
+      active = false;
+    TRACE_END(TRACE_STEP, traceLibId);
+  }
+}
@@ -0,0 +1,81 @@
+/* FILEMAP.CPP
+    This module defines the fileMapClass, a read-only memory mapping of a file. It is used by the host-only load() functions of the
+    classes that use a binary image in place (bakePlayerClass, pixelMapClass and cuePlayerClass), so that an image file is played
+    or attached exactly as a const array in flash would be on the device, with no read or parse step. It is only compiled when
+    EFFECT_HOST_MMAP is defined.
+
+    A load() function maps the file into a local fileMapClass, attaches the mapped image, and only then takes ownership of the
+    mapping with adopt(), since attaching an image releases any previous mapping. If the image is invalid, the local mapping is
+    released when it goes out of scope.
+*/
+#include <Arduino.h>
+#include "FileMap.h"
+
+#ifdef EFFECT_HOST_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/* fileMapClass::map()
+    Memory-maps a file (read-only), releasing any previous mapping
+  Parameters:
+    const char *path: Path of the file
+    size_t minSize: Minimum valid file size (bytes), e.g. the size of the image header
+  Returns:
+    bool: False if the file can't be opened or mapped, or is smaller than minSize
+*/
+bool fileMapClass::map(const char *path, size_t minSize) {
+  struct stat info;
+  void *a;
+  int fd;
+
+  unmap();
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return (false);
+  if ((fstat(fd, &info) != 0) || (info.st_size < (off_t) max(minSize, (size_t) 1)) || (info.st_size > (off_t) UINT32_MAX)) {
+    close(fd);
+    return (false);
+  }
+  a = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping remains valid after the file is closed
+  if (a == MAP_FAILED)
+    return (false);
+  addr = a;
+  size = info.st_size;
+  return (true);
+}
+
+
+/* fileMapClass::unmap()
+    Releases the mapping (if any)
+  Parameters: None
+  Returns: None
+*/
+void fileMapClass::unmap() {
+  if (addr != NULL)
+    munmap(addr, size);
+  addr = NULL;
+  size = 0;
+}
+
+
+/* fileMapClass::adopt()
+    Takes ownership of another object's mapping, releasing any previous mapping of this object
+  Parameters:
+    fileMapClass &other: Object whose mapping is transferred (it is left empty)
+  Returns: None
+*/
+void fileMapClass::adopt(fileMapClass &other) {
+  if (&other == this)
+    return;
+  unmap();
+  addr = other.addr;
+  size = other.size;
+  other.addr = NULL;
+  other.size = 0;
+}
+
+#endif  // EFFECT_HOST_MMAP
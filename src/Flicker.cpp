@@ -4,42 +4,68 @@
     The flicker is applied at a constant (specified) frequency where target flicker output level is randomly chosen for each cycle.
     A specified filter value constrains the maximum per-cycle change from the current level in the direction of the new target level,
     enabling control over the "smoothness" of the flciker effect. The flickerClass::val() can be used to modulate the brightness of 
-    one or more LEDs, or can be used to control the number of consecutive LEDs in a strip that are turned on. The flicker effect includes
-    an embedded ramp function that can be used to fade in/out the flicker effect. 
+    one or more LEDs, or can be used to control the number of consecutive LEDs in a strip that are turned on. The flicker effect can
+    be faded in/out by a ramp function, which is allocated by the first call to setRamp(), or by a shared modulator bound with
+    bindRamp() (see Modulator.cpp).
 */
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Flicker.h"
+#include "Modulator.h"
 
 
 /* setRamp()
-    Sets the duration of the embedded ramp function (set Ramp.cpp) that is used to gradually increase, hold, and then decrease
-    the flicker effect output (based on flickVal) over the duration of the effect.
+    Sets the duration of the ramp function (set Ramp.cpp) that is used to gradually increase, hold, and then decrease the flicker
+    effect output (based on flickVal) over the duration of the effect. The ramp is allocated by the first call, and is used unless a
+    shared modulator is bound.
   Parameters: 
     float rampUpDur: duration of each of the ramp-up phases (seconds)
     float rampDownDur: duration of each of the ramp-down phases (seconds)
   Returns: None
 */
 void flickerClass::setRamp(float rampUpDur, float rampDownDur) {
-  ramp.setRamp(rampUpDur, rampDownDur);
+  if (outRamp.own == NULL) {
+    outRamp.own = new rampModulatorClass;
+    if (outRamp.own == NULL)
+      return;
+    outRamp.own->ramp.bindContext(ctx);
+    if (outRamp.mod == &unityModulator)
+      outRamp.mod = outRamp.own;
+  }
+  outRamp.own->ramp.setRamp(rampUpDur, rampDownDur);
 }
 
 
 /* setRamp() [Overload]
-    Sets the duration of the embedded ramp function (set Ramp.cpp) that is used to gradually increase, hold, and then decrease
-    the flicker effect output (based on flickVal) over the duration of the effect.
+    Sets the duration of the ramp function (set Ramp.cpp) that is used to gradually increase, hold, and then decrease the flicker
+    effect output (based on flickVal) over the duration of the effect.
   Parameters: 
     float rampDur: duration of each of the ramp-up and ramp-down phases (seconds)
   Returns: None
 */
 void flickerClass::setRamp(float rampDur) {
-  ramp.setRamp(rampDur);
+  setRamp(rampDur, rampDur);
+}
+
+
+/* bindRamp()
+    Binds a shared modulator (see Modulator.cpp) to be used instead of the ramp set by setRamp(). The ramp is not stepped while a
+    modulator is bound.
+  Parameters: 
+    const modulatorClass *mod: Pointer to the shared modulator, or NULL to restore the ramp set by setRamp() (or no ramp)
+  Returns: None
+*/
+void flickerClass::bindRamp(const modulatorClass *mod) {
+  if (mod != NULL)
+    outRamp.mod = mod;
+  else
+    outRamp.mod = (outRamp.own != NULL) ? (const modulatorClass *) outRamp.own : &unityModulator;
 }
 
 
 /* start()
-    Starts the flicker effect with the specified parameters. The embedded ramp function is also started, but this will have no effect
-      unless setRamp() has been called with a non-zero rampTime.
+    Starts the flicker effect with the specified parameters. The ramp function (if allocated by setRamp()) is also started, unless a
+      shared modulator is bound.
   Parameters: 
     float duration: Total effect duration (seconds). Duration = 0 specifies an infinite duration
     float frequency: Frequency of the flicker (Hz)
@@ -57,11 +83,25 @@ void flickerClass::start(float duration, float frequency, float filter, float mi
   stepNum = 0;
   cycleStepNum = 0;
   flickVal = minVal + ((1 - minVal) / 2);   // start at 50% full scale
-  ramp.start(duration);   // start the embedded ramp
+  if ((outRamp.own != NULL) && (outRamp.mod == outRamp.own))
+    outRamp.own->start(duration);   // start the ramp
   active = true;
 }
 
 
+/* bindContext()
+    Binds the effect and its ramp (if any) to a render context, which supplies the step period and random numbers
+  Parameters:
+    renderContextClass *context: Pointer to the context
+  Returns: None
+*/
+void flickerClass::bindContext(renderContextClass *context) {
+  ctx = context;
+  if (outRamp.own != NULL)
+    outRamp.own->ramp.bindContext(context);
+}
+
+
 /* step()
     Called once per step period to update the flicker effect (if active).
   Parameters: None
@@ -72,7 +112,7 @@ void flickerClass::step() {
 
   if (active) {
     if (cycleStepNum == 0) {  // if beginning of new cycle
-      targetVal = (float) random(minTarget, 101) / 100;  // get random value between 0.0 and 1.0
+      targetVal = (float) ctx->random(minTarget, 101) / 100;  // get random value between 0.0 and 1.0
     }
     delta = targetVal - flickVal;  
     if (delta > 0) {                      // new targetVal is > current flickVal
@@ -81,7 +121,8 @@ void flickerClass::step() {
     else if (delta < 0) {   // new targetVal < current flickVal
       flickVal += max(delta, -maxDelta);  // add (negative) delta, constrained by -maxDelta
     }
-    ramp.step();    // update the embedded ramp function
+    if ((outRamp.own != NULL) && (outRamp.mod == outRamp.own))  // shared modulator (if bound) is stepped by its owner
+      outRamp.own->step();    // update the ramp function
     cycleStepNum++;
     if (cycleStepNum >= cycleSteps) {   // if cycle is done
       cycleStepNum = 0; // start new cycle in next step
@@ -97,14 +138,14 @@ void flickerClass::step() {
 }
 
 /* val()
-    Returns the current flickerVal, scaled by the embedded ramp function value (if enabled).
+    Returns the current flickerVal, scaled by the ramp function or bound modulator value (if any).
   Parameters: None
   Returns: 
     float: Ramp-modulated flicker function output
 */
 float flickerClass::val() {
   if (active) {
-    return (flickVal * ramp.val);
+    return (flickVal * outRamp.mod->val);
   }
   else 
     return (0);
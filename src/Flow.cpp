@@ -8,6 +8,7 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Flow.h"
+#include "Trace.h"
 
 
 /* flowClass::start()
@@ -26,6 +27,7 @@ void flowClass::start(float duration, float distance, float rampLen) {
   curPos = 0;
   completedFlag = false;
   stepNum = 0;
+  lastActive = false;   // report the full span as changed after a (re)start
   active = true;
 }
 
@@ -84,4 +86,64 @@ bool flowClass::completed() {
   retVal = completedFlag;
   completedFlag = false;
   return retVal;
-}
\ No newline at end of file
+}
+
+
+/* flowClass::changed()
+    Reports the span of offsets where val() may have changed since the previous call (see effect::changed()). While the flow is
+    moving, only the ramp region (plus the distance moved in the last step) changes; offsets behind the ramp stay at 1.0.
+  Parameters:
+    float *spanStart: Set to the start of the changed span (mm)
+    float *spanEnd: Set to the end of the changed span (mm)
+  Returns:
+    spanKindEnum: SPAN_LINEAR, or SPAN_NONE if the output didn't change
+*/
+spanKindEnum flowClass::changed(float *spanStart, float *spanEnd) {
+  if (active && lastActive) {
+    *spanStart = max(curPos - deltaDist - rampWidth, 0);
+    *spanEnd = curPos;
+    return (SPAN_LINEAR);
+  }
+  return (effect::changed(spanStart, spanEnd));
+}
+
+
+/* flowClass::render()
+    Batch version of val() for a range of pixels. Only reads the flow state, so disjoint pixel ranges may be rendered concurrently
+    (e.g. by spanPoolClass).
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *offset: Array of pixel positions (mm) relative to the flow origin
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void flowClass::render(float *out, const float *offset, uint32_t first, uint32_t count) {
+  float rampPos;
+
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  for (uint32_t p = first; p < (first + count); p++) {
+    rampPos = curPos - offset[p];
+    if (!active || (rampPos <= 0) || (offset[p] < 0))
+      out[p] = 0.0f;
+    else if (rampPos >= rampWidth)
+      out[p] = 1.0f;
+    else
+      out[p] = rampPos * rampSlope;
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+
+/* flowClass::render() [Overload]
+    Masked version of render(): renders only the pixels in a mask, one run at a time (see PixelMask.cpp). Pixels outside the mask
+    are neither computed nor written.
+  Parameters:
+    float *out: Output array, indexed by pixel number
+    const float *offset: Array of pixel positions (mm) relative to the flow origin
+    pixelMaskClass &mask: Pixels to render
+  Returns: None
+*/
+void flowClass::render(float *out, const float *offset, pixelMaskClass &mask) {
+  mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, offset, first, count); });
+}
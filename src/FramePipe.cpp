@@ -0,0 +1,227 @@
+/* FRAMEPIPE.CPP
+    This module defines the framePipeClass, which overlaps the rendering of frame N+1 with the transmission of frame N. Two frame
+    buffers are allocated; the application renders into the back buffer while the output sink transmits the front buffer (e.g. by
+    DMA). submit() waits only until the sink has finished the previous frame, then swaps the buffers and hands the completed frame to
+    the sink. No copy or lock is needed: the swap is a single index change, and the sink's busy() flag is the only synchronization.
+
+    Typical loop, once per step period:
+      uint8_t *frame = pipe.backBuffer();   // marks the start of rendering (for latency statistics)
+      ... step effects and render pixels into frame (or with pipe.setPixel()) ...
+      pipe.submit();
+
+    Output is done by a class derived from frameSinkClass. octoSinkClass (available when the OctoWS2811 library is installed) drives
+    LED strips by DMA; streamSinkClass writes each frame to any Print stream, and can be used to capture frames to a file or socket
+    on a host build. Render time, wait time, latency and throughput are measured with micros() and reported by getStats().
+
+    The pipe also drives the step clock of a render context (defaultContext unless another is passed to init()): init() resets the
+    clock, and each submit() advances it by one step, so that renderContextClass::stepCount() and time() give the number of frames
+    and the elapsed effect time of the installation that the pipe outputs.
+*/
+#include <Arduino.h>
+#include "FramePipe.h"
+#include "Trace.h"
+
+
+/* streamSinkClass::show()
+    Writes a frame to the stream: a 4-byte frame number, a 4-byte pixel count (both little-endian), then the pixel bytes
+  Parameters:
+    const uint8_t *frame: Pointer to the frame buffer
+    uint32_t numPixels: Number of pixels in the frame
+    uint8_t bytesPerPixel: Bytes per pixel
+  Returns: None
+*/
+void streamSinkClass::show(const uint8_t *frame, uint32_t numPixels, uint8_t bytesPerPixel) {
+  if (out == NULL)
+    return;
+  out->write((const uint8_t *) &frameNum, sizeof(frameNum));
+  out->write((const uint8_t *) &numPixels, sizeof(numPixels));
+  out->write(frame, numPixels * bytesPerPixel);
+  frameNum++;
+}
+
+
+#if __has_include(<OctoWS2811.h>)
+/* octoSinkClass::show()
+    Copies a frame into the OctoWS2811 buffer and starts the DMA transfer. Called by framePipeClass::submit() only when busy() is
+    false, so the copy never disturbs a transfer in progress. On Teensy 4.x, the OctoWS2811 drawing memory holds plain pixel bytes
+    in the strips' color order (3 bytes per pixel, or 4 for RGBW), so if the drawing memory was supplied to init() the frame is
+    copied with a single memcpy(). The frame must then already be in the strips' color order (e.g. GRB), and bytesPerPixel must
+    match the OctoWS2811 configuration. Otherwise (or on Teensy 3.x, whose drawing memory is bit-transposed) each pixel is copied
+    with setPixel(), which also applies the color order.
+  Parameters:
+    const uint8_t *frame: Pointer to the frame buffer (RGB or RGBW byte order)
+    uint32_t numPixels: Number of pixels in the frame
+    uint8_t bytesPerPixel: Bytes per pixel (3 or 4)
+  Returns: None
+*/
+void octoSinkClass::show(const uint8_t *frame, uint32_t numPixels, uint8_t bytesPerPixel) {
+  const uint8_t *pix;
+
+  if (leds == NULL)
+    return;
+  numPixels = min(numPixels, (uint32_t) leds->numPixels());
+#if defined(__IMXRT1062__)
+  if (drawMem != NULL) {
+    memcpy(drawMem, frame, numPixels * bytesPerPixel);
+    leds->show();
+    return;
+  }
+#endif
+  for (uint32_t p = 0; p < numPixels; p++) {
+    pix = frame + (p * bytesPerPixel);
+    if (bytesPerPixel == 4)
+      leds->setPixel(p, pix[0], pix[1], pix[2], pix[3]);
+    else
+      leds->setPixel(p, pix[0], pix[1], pix[2]);
+  }
+  leds->show();
+}
+#endif
+
+
+/* framePipeClass::init()
+    Allocates the two frame buffers (cleared to 0), sets the output sink, and resets the step clock of the render context
+  Parameters:
+    uint32_t numPix: Number of pixels in each frame
+    uint8_t bytesPerPixel: Bytes per pixel (1 - 4)
+    frameSinkClass *outSink: Pointer to the output sink
+    renderContextClass *context: Context of the effects rendered into this pipe, whose clock is advanced by submit()
+  Returns:
+    bool: False if memory allocation failed or a parameter is invalid
+*/
+bool framePipeClass::init(uint32_t numPix, uint8_t bytesPerPixel, frameSinkClass *outSink, renderContextClass *context) {
+  if ((numPix == 0) || (bytesPerPixel == 0) || (bytesPerPixel > frameMaxBpp) || (outSink == NULL) || (context == NULL))
+    return (false);
+  numPixels = numPix;
+  bpp = bytesPerPixel;
+  sink = outSink;
+  ctx = context;
+  ctx->resetClock();
+  for (uint8_t b = 0; b < 2; b++) {
+    if (buf[b] != NULL)
+      delete [] buf[b];
+    buf[b] = new uint8_t[numPixels * bpp];
+    if (buf[b] == NULL)
+      return (false);
+    memset(buf[b], 0, numPixels * bpp);
+  }
+  back = 0;
+  resetStats();
+  renderStart = micros();
+  lastSubmit = renderStart;
+  return (true);
+}
+
+
+/* framePipeClass::backBuffer()
+    Returns the buffer into which the next frame is to be rendered, and marks the start of rendering for the latency statistics (and
+    the start of a TRACE_FRAME event, which ends in submit()). The buffer still contains the frame rendered two frames earlier.
+  Parameters: None
+  Returns:
+    uint8_t *: Pointer to (numPixels * bytesPerPixel) bytes
+*/
+uint8_t *framePipeClass::backBuffer() {
+  TRACE_BEGIN(TRACE_FRAME, traceLibId);
+  renderStart = micros();
+  return (buf[back]);
+}
+
+
+/* framePipeClass::setPixel()
+    Sets a pixel in the back buffer (the 4th byte of an RGBW pixel is not changed)
+  Parameters:
+    uint32_t pixel: Pixel number
+    uint8_t r, g, b: Color components, stored in that order
+  Returns: None
+*/
+void framePipeClass::setPixel(uint32_t pixel, uint8_t r, uint8_t g, uint8_t b) {
+  uint8_t *pix;
+
+  if ((pixel >= numPixels) || (bpp < 3))
+    return;
+  pix = buf[back] + (pixel * bpp);
+  pix[0] = r;
+  pix[1] = g;
+  pix[2] = b;
+}
+
+
+/* framePipeClass::submit()
+    Hands the back buffer to the sink as a completed frame. Waits (if necessary) until the sink has finished transmitting the previous
+    frame, swaps the buffers, and starts output of the new frame. The application then renders the next frame into the other buffer.
+    The step clock of the render context is advanced by one step.
+  Parameters: None
+  Returns: None
+*/
+void framePipeClass::submit() {
+  uint32_t now, waitStart;
+
+  if (sink == NULL)
+    return;
+  waitStart = micros();
+  while (sink->busy())  // previous frame (in the other buffer) still being transmitted
+    ;
+  now = micros();
+  stats.lastRenderUs = waitStart - renderStart;
+  stats.lastWaitUs = now - waitStart;
+  stats.lastLatencyUs = now - renderStart;
+  stats.maxRenderUs = max(stats.maxRenderUs, stats.lastRenderUs);
+  stats.maxWaitUs = max(stats.maxWaitUs, stats.lastWaitUs);
+  stats.maxLatencyUs = max(stats.maxLatencyUs, stats.lastLatencyUs);
+  stats.totalRenderUs += stats.lastRenderUs;
+  stats.totalWaitUs += stats.lastWaitUs;
+  stats.periodUs = now - lastSubmit;
+  lastSubmit = now;
+  stats.frames++;
+  back ^= 1;    // swap: the completed frame becomes the front buffer
+  sink->show(buf[back ^ 1], numPixels, bpp);
+  ctx->tick();
+  TRACE_END(TRACE_FRAME, traceLibId);
+  renderStart = micros();   // in case backBuffer() isn't called before rendering the next frame
+}
+
+
+/* framePipeClass::resetStats()
+    Clears the latency and throughput statistics
+  Parameters: None
+  Returns: None
+*/
+void framePipeClass::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+
+/* framePipeClass::framesPerSec()
+    Computes the frame rate from the time between the last two calls to submit()
+  Parameters: None
+  Returns:
+    float: Frames per second (0 if fewer than two frames have been submitted)
+*/
+float framePipeClass::framesPerSec() {
+  if ((stats.frames < 2) || (stats.periodUs == 0))
+    return (0);
+  return (1000000.0 / stats.periodUs);
+}
+
+
+/* framePipeClass::meanRenderUs()
+    Computes the mean time spent rendering each frame since the statistics were reset
+  Parameters: None
+  Returns:
+    float: Mean render time (us)
+*/
+float framePipeClass::meanRenderUs() {
+  return ((stats.frames == 0) ? 0 : ((float) stats.totalRenderUs / stats.frames));
+}
+
+
+/* framePipeClass::meanWaitUs()
+    Computes the mean time that submit() waited for the sink since the statistics were reset. A mean near 0 indicates that output is
+    fully overlapped with rendering; a large mean indicates that the frame rate is limited by the output.
+  Parameters: None
+  Returns:
+    float: Mean wait time (us)
+*/
+float framePipeClass::meanWaitUs() {
+  return ((stats.frames == 0) ? 0 : ((float) stats.totalWaitUs / stats.frames));
+}
@@ -0,0 +1,277 @@
+/* GOLDEN.CPP
+    This module defines the goldenClass, a regression harness used to confirm that an optimized rendering path (table-based trig,
+    batch rendering, cached per-frame terms, etc.) produces the same output as the reference scalar code, within a stated tolerance.
+
+    A scripted scene is run once through the reference code in record mode; each effect output value is passed to sample() with
+    a channel number (typically one channel per effect), and endFrame() is called at the end of each frame. The random seed is
+    applied at the start of recording and stored with the baseline, so that a replay of the scene sees the same random() sequence. The seed is also applied
+    to the render context (defaultContext unless bindContext() is called), for effects that draw from a private random stream.
+    The baseline can be written to any Print-derived stream with save() and read back with load(). Values are stored as scaled int16,
+    so a baseline of 100 frames x 1000 pixels is 200KB.
+
+    The same scene is then run through the optimized code in compare mode, calling sample() in the same order. Each value is
+    compared with the baseline, and per-channel error statistics (max error, mean error, number of samples beyond the tolerance,
+    first failing frame) are accumulated. Alternatively, compare() can be used to compare reference and optimized values computed
+    side-by-side in the same run, without a stored baseline.
+*/
+#include <Arduino.h>
+#include "Golden.h"
+
+
+/* goldenClass::init()
+    Allocates the baseline sample array and sets the comparison tolerance.
+  Parameters:
+    uint8_t channels: Number of channels (e.g. effects) to be tracked separately, up to goldenMaxChannels
+    uint32_t maxSamples: Maximum number of samples in the baseline (e.g. frames x pixels x channels)
+    float tol: Maximum allowed absolute error per sample
+  Returns: None
+*/
+void goldenClass::init(uint8_t channels, uint32_t maxSamples, float tol) {
+  numChannels = min(channels, goldenMaxChannels);
+  tolerance = tol;
+  if (baseline != NULL)
+    delete[] baseline;
+  baseline = new int16_t [maxSamples];  // allocate 2 bytes per sample
+  capacity = (baseline != NULL) ? maxSamples : 0;
+  numSamples = 0;
+  numFrames = 0;
+  mode = GOLDEN_IDLE;
+  resetStats();
+}
+
+
+/* goldenClass::startRecord()
+    Starts recording a new baseline, discarding any previously recorded or loaded baseline.
+  Parameters:
+    uint32_t rndSeed: Random seed applied with randomSeed() and to the render context, so that the scene can be replayed deterministically
+  Returns: None
+*/
+void goldenClass::startRecord(uint32_t rndSeed) {
+  seed = rndSeed;
+  randomSeed(seed);
+  ctx->seed(seed);
+  numSamples = 0;
+  numFrames = 0;
+  frameNum = 0;
+  overflow = false;
+  mode = GOLDEN_RECORD;
+}
+
+
+/* goldenClass::startCompare()
+    Starts comparing subsequent samples against the recorded or loaded baseline. The random seed stored with the baseline is applied.
+  Parameters: None
+  Returns: None
+*/
+void goldenClass::startCompare() {
+  randomSeed(seed);
+  ctx->seed(seed);
+  readPos = 0;
+  frameNum = 0;
+  overflow = false;
+  resetStats();
+  mode = GOLDEN_COMPARE;
+}
+
+
+/* goldenClass::sample()
+    Records a value (GOLDEN_RECORD mode) or compares it against the next baseline value (GOLDEN_COMPARE mode). Samples must be
+    supplied in the same order in both modes.
+  Parameters:
+    uint8_t channel: Channel number (0 - (channels - 1)) used to accumulate error statistics
+    float value: Effect output value, in the range -1.0 to +1.0
+  Returns: None
+*/
+void goldenClass::sample(uint8_t channel, float value) {
+  float refVal;
+
+  if (mode == GOLDEN_RECORD) {
+    if (numSamples < capacity)
+      baseline[numSamples++] = (int16_t) round(constrain(value, -1, 1) * goldenScale);
+    else
+      overflow = true;
+  }
+  else if (mode == GOLDEN_COMPARE) {
+    if (readPos < numSamples) {
+      refVal = (float) baseline[readPos++] / goldenScale;
+      accumulate(channel, value - refVal);
+    }
+    else
+      overflow = true;  // more samples than were recorded
+  }
+}
+
+
+/* goldenClass::compare()
+    Compares a reference value and an optimized value computed in the same run, and accumulates the error statistics. No baseline
+    is used, so this may be called in any mode.
+  Parameters:
+    uint8_t channel: Channel number (0 - (channels - 1)) used to accumulate error statistics
+    float refVal: Value computed by the reference code
+    float testVal: Value computed by the optimized code
+  Returns: None
+*/
+void goldenClass::compare(uint8_t channel, float refVal, float testVal) {
+  accumulate(channel, testVal - refVal);
+}
+
+
+/* goldenClass::endFrame()
+    Called at the end of each frame of the scene
+  Parameters: None
+  Returns: None
+*/
+void goldenClass::endFrame() {
+  frameNum++;
+  if (mode == GOLDEN_RECORD)
+    numFrames = frameNum;
+}
+
+
+/* goldenClass::accumulate()
+    Accumulates the error statistics for a channel. Errors up to half of the int16 quantization step are not counted as failures.
+  Parameters:
+    uint8_t channel: Channel number
+    float err: Signed error (test - reference)
+  Returns: None
+*/
+void goldenClass::accumulate(uint8_t channel, float err) {
+  goldenStatsStruct *st;
+
+  if (channel >= numChannels)
+    return;
+  st = &stats[channel];
+  err = abs(err);
+  st->maxErr = max(st->maxErr, err);
+  st->sumErr += err;
+  st->samples++;
+  if (err > (tolerance + (0.5 / goldenScale))) {
+    if (st->failures == 0)
+      st->firstFailFrame = frameNum;
+    st->failures++;
+  }
+}
+
+
+/* goldenClass::resetStats()
+    Clears the error statistics for all channels
+  Parameters: None
+  Returns: None
+*/
+void goldenClass::resetStats() {
+  memset(stats, 0, sizeof(stats));
+}
+
+
+/* goldenClass::save()
+    Writes the recorded baseline (header followed by int16 samples) to the specified stream
+  Parameters:
+    Print &out: Stream to write the baseline to (e.g. a File)
+  Returns:
+    bool: True if all bytes were written
+*/
+bool goldenClass::save(Print &out) {
+  goldenHeaderStruct hdr;
+  size_t bytes;
+
+  if ((baseline == NULL) || overflow)
+    return (false);
+  hdr.magic = goldenMagic;
+  hdr.version = goldenVersion;
+  hdr.numChannels = numChannels;
+  hdr.reserved = 0;
+  hdr.numFrames = numFrames;
+  hdr.numSamples = numSamples;
+  hdr.seed = seed;
+  bytes = out.write((const uint8_t *) &hdr, sizeof(hdr));
+  bytes += out.write((const uint8_t *) baseline, numSamples * sizeof(int16_t));
+  return (bytes == (sizeof(hdr) + (numSamples * sizeof(int16_t))));
+}
+
+
+/* goldenClass::load()
+    Reads a baseline previously written with save(). init() must have been called with a large enough maxSamples. The header is
+    validated before anything is changed, so an invalid file leaves the current baseline intact; if the sample data is truncated,
+    the partially-overwritten baseline is discarded.
+  Parameters:
+    Stream &in: Stream to read the baseline from (e.g. a File)
+  Returns:
+    bool: True if a valid baseline was read
+*/
+bool goldenClass::load(Stream &in) {
+  goldenHeaderStruct hdr;
+  uint32_t samplesRead;
+
+  if ((baseline == NULL) || (in.readBytes((uint8_t *) &hdr, sizeof(hdr)) != sizeof(hdr)))
+    return (false);
+  if ((hdr.magic != goldenMagic) || (hdr.version != goldenVersion) || (hdr.numSamples > capacity) || (hdr.numChannels == 0) ||
+      (hdr.numChannels > goldenMaxChannels))
+    return (false);
+  samplesRead = in.readBytes((uint8_t *) baseline, hdr.numSamples * sizeof(int16_t)) / sizeof(int16_t);
+  if (samplesRead != hdr.numSamples) {
+    numSamples = 0;   // baseline was partially overwritten
+    numFrames = 0;
+    mode = GOLDEN_IDLE;
+    return (false);
+  }
+  numSamples = samplesRead;
+  numChannels = hdr.numChannels;
+  numFrames = hdr.numFrames;
+  seed = hdr.seed;
+  mode = GOLDEN_IDLE;
+  return (true);
+}
+
+
+/* goldenClass::passed()
+    Returns true if no channel had a sample error beyond the tolerance, and (in compare mode) the number of samples matched the baseline
+  Parameters: None
+  Returns:
+    bool: True if the comparison passed
+*/
+bool goldenClass::passed() {
+  if (overflow || ((mode == GOLDEN_COMPARE) && (readPos != numSamples)))
+    return (false);
+  for (uint8_t c = 0; c < numChannels; c++) {
+    if (stats[c].failures > 0)
+      return (false);
+  }
+  return (true);
+}
+
+
+/* goldenClass::report()
+    Prints the per-channel error statistics to the specified stream
+  Parameters:
+    Print &out: Stream to print to (e.g. Serial)
+  Returns: None
+*/
+void goldenClass::report(Print &out) {
+  goldenStatsStruct *st;
+
+  for (uint8_t c = 0; c < numChannels; c++) {
+    st = &stats[c];
+    out.printf("ch %u: samples=%lu max=%.6f mean=%.6f fail=%lu", c, (unsigned long) st->samples, (double) st->maxErr,
+        (double) ((st->samples > 0) ? (st->sumErr / st->samples) : 0), (unsigned long) st->failures);
+    if (st->failures > 0)
+      out.printf(" (first at frame %lu)", (unsigned long) st->firstFailFrame);
+    out.print("\n");
+  }
+  if ((mode == GOLDEN_COMPARE) && (readPos != numSamples))
+    out.printf("sample count mismatch: %lu compared, %lu in baseline\n", (unsigned long) readPos, (unsigned long) numSamples);
+  out.print(passed() ? "PASS\n" : "FAIL\n");
+}
+
+
+/* goldenClass::getStats()
+    Returns a pointer to the error statistics for a channel
+  Parameters:
+    uint8_t channel: Channel number
+  Returns:
+    goldenStatsStruct *: Pointer to statistics, or NULL if channel is out of range
+*/
+goldenStatsStruct *goldenClass::getStats(uint8_t channel) {
+  if (channel >= numChannels)
+    return (NULL);
+  return (&stats[channel]);
+}
@@ -0,0 +1,125 @@
+/* INSTANCE.CPP
+    This module defines the instanceMapClass, which lets identical or symmetric fixtures share a single rendered span. Effects are
+    rendered only for the canonical (source) span of each group of fixtures, and apply() then copies the span into the other
+    fixtures' pixels: a memcpy for a forward copy, or a strided copy for a reversed (mirrored) copy. Copies are applied in the order
+    in which they were added, so a copy may use pixels written by an earlier copy as its source.
+
+    For example, a rig of 24 identical strips of 300 pixels, wired in serpentine order:
+      inst.addStrips(0, 300, 24, 300, true);   // strip 0 is rendered; strips 1 - 23 are copies, odd strips reversed
+      inst.addSources(mask);                   // mask = pixels to render (strip 0 only)
+      ...
+      wave.render(out, pos, mask);             // render the source span
+      inst.apply(out);                         // copy it to the other strips
+
+    apply() works on scalar effect output (float), HSI colors (hsiF), or on the bytes of an output frame (applyFrame()), so the
+    copies can be made at whichever stage of the output pipeline is cheapest.
+*/
+#include <Arduino.h>
+#include "Instance.h"
+
+
+/* instanceMapClass::addCopy()
+    Adds a copy of a span of pixels to the map
+  Parameters:
+    uint32_t srcFirst: First pixel of the source span
+    uint32_t count: Number of pixels
+    uint32_t dstFirst: First pixel of the copy; the copy must not overlap the source span
+    bool reverse: If true, the copy is in reverse order (dstFirst receives the last pixel of the source span)
+  Returns:
+    bool: False if the map is full or the spans overlap
+*/
+bool instanceMapClass::addCopy(uint32_t srcFirst, uint32_t count, uint32_t dstFirst, bool reverse) {
+  if ((numCopies >= instanceMaxCopies) || (count == 0))
+    return (false);
+  if ((dstFirst < (srcFirst + count)) && (srcFirst < (dstFirst + count)))   // overlapping spans
+    return (false);
+  copy[numCopies++] = {srcFirst, dstFirst, count, reverse};
+  return (true);
+}
+
+
+/* instanceMapClass::addStrips()
+    Adds copies of a source strip to a group of identical, equally-spaced strips (in pixel numbering)
+  Parameters:
+    uint32_t srcFirst: First pixel of the source strip (the first strip in the group)
+    uint32_t stripLen: Number of pixels in each strip
+    uint8_t numStrips: Number of strips in the group, including the source strip
+    uint32_t stride: Pixel number difference between the first pixels of consecutive strips (>= stripLen)
+    bool serpentine: If true, alternate strips are reversed (e.g. wired back and forth)
+  Returns:
+    bool: False if the map is full (copies that fit are added)
+*/
+bool instanceMapClass::addStrips(uint32_t srcFirst, uint32_t stripLen, uint8_t numStrips, uint32_t stride, bool serpentine) {
+  for (uint8_t s = 1; s < numStrips; s++) {
+    if (!addCopy(srcFirst, stripLen, srcFirst + (s * stride), serpentine && ((s & 1) != 0)))
+      return (false);
+  }
+  return (true);
+}
+
+
+/* instanceMapClass::addMirror()
+    Adds a mirror copy for a span that is symmetric about its center: the first half is rendered, and the second half is a
+    reversed copy of it. For an odd count, the center pixel belongs to the rendered half.
+  Parameters:
+    uint32_t first: First pixel of the symmetric span
+    uint32_t count: Number of pixels in the span
+  Returns:
+    bool: False if the map is full
+*/
+bool instanceMapClass::addMirror(uint32_t first, uint32_t count) {
+  return (addCopy(first, count / 2, first + ((count + 1) / 2), true));
+}
+
+
+/* instanceMapClass::addSources()
+    Restricts a mask (see PixelMask.cpp) to the pixels that must be rendered, by removing the destination pixels of every copy
+  Parameters:
+    pixelMaskClass &mask: Mask of the pixels to render (e.g. all pixels, set with setAll())
+  Returns: None
+*/
+void instanceMapClass::addSources(pixelMaskClass &mask) {
+  for (uint8_t c = 0; c < numCopies; c++)
+    mask.removeRange(copy[c].dstFirst, copy[c].count);
+}
+
+
+/* instanceMapClass::applyBytes()
+    Applies all of the copies to a buffer of fixed-size pixel elements
+  Parameters:
+    uint8_t *buf: Buffer, indexed by pixel number
+    uint8_t elemSize: Size of each pixel element (bytes)
+  Returns: None
+*/
+void instanceMapClass::applyBytes(uint8_t *buf, uint8_t elemSize) {
+  const instanceCopyStruct *c;
+  const uint8_t *src;
+  uint8_t *dst;
+
+  for (uint8_t n = 0; n < numCopies; n++) {
+    c = &copy[n];
+    src = buf + (c->srcFirst * elemSize);
+    dst = buf + (c->dstFirst * elemSize);
+    if (!c->reverse) {
+      memcpy(dst, src, c->count * elemSize);
+      continue;
+    }
+    src += (c->count - 1) * elemSize;   // last pixel of the source span
+    switch (elemSize) {   // strided copies for the common element sizes
+      case 4:   // float, or RGBW bytes (a fixed-size memcpy compiles to a single load and store)
+        for (uint32_t p = 0; p < c->count; p++, dst += 4, src -= 4)
+          memcpy(dst, src, 4);
+        break;
+      case 3:
+        for (uint32_t p = 0; p < c->count; p++, dst += 3, src -= 3) {
+          dst[0] = src[0];
+          dst[1] = src[1];
+          dst[2] = src[2];
+        }
+        break;
+      default:
+        for (uint32_t p = 0; p < c->count; p++, dst += elemSize, src -= elemSize)
+          memcpy(dst, src, elemSize);
+    }
+  }
+}
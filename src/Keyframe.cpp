@@ -0,0 +1,185 @@
+/* KEYFRAME.CPP
+    This module defines the keyframeClass, which allows effects to be stepped and rendered at a lower keyframe rate than the LED
+    output rate. The output stage linearly interpolates each pixel between the last two keyframes at the full output rate, which
+    costs one multiply-add per channel instead of re-evaluating the (sin- and sqrt-heavy) effects for every output frame. The
+    interpolated output lags the effects by one keyframe.
+
+    Typical use, with output at 400 Hz and keyframes at 100 Hz:
+      keyCtx.setStepPeriod(10);         // effects are stepped once per keyframe (see RenderContext.cpp)
+      wave.bindContext(&keyCtx);
+      kf.init(numPixels, 4, true);      // 4 output frames per keyframe, hsiF pixels
+      ...
+      once per output frame (2.5 ms):
+        if (kf.keyDue()) {
+          wave.step();
+          ... render the effects into kf.colorKey() ...
+          kf.commitKey();
+        }
+        kf.output(colors);              // interpolated colors for this output frame
+
+    In color mode, hues are interpolated along the shortest distance around the hue circle (with wrap-around). As with fadeClass, a
+    pixel that is off (intensity 0) in either keyframe takes the hue and saturation of the other keyframe, so fades in and out
+    change brightness only.
+*/
+#include <Arduino.h>
+#include "Keyframe.h"
+
+
+/* keyframeClass::freeArrays()
+    Frees the keyframe arrays
+  Parameters: None
+  Returns: None
+*/
+void keyframeClass::freeArrays() {
+  delete [] keyF;
+  delete [] lastF;
+  delete [] deltaF;
+  delete [] keyC;
+  delete [] lastC;
+  delete [] deltaC;
+  keyF = lastF = deltaF = NULL;
+  keyC = lastC = deltaC = NULL;
+}
+
+
+/* keyframeClass::init()
+    Allocates the keyframe arrays (3 values per pixel)
+  Parameters:
+    uint32_t numPix: Number of pixels
+    uint8_t outputFramesPerKey: Number of output frames per keyframe (1 disables interpolation)
+    bool hsiPixels: True for hsiF pixels (colorKey() / output(hsiF *)); false for scalar pixels (scalarKey() / output(float *))
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool keyframeClass::init(uint32_t numPix, uint8_t outputFramesPerKey, bool hsiPixels) {
+  freeArrays();
+  numPixels = 0;
+  color = hsiPixels;
+  framesPerKey = max(outputFramesPerKey, 1);
+  invFrames = 1.0 / framesPerKey;
+  frameNum = 0;
+  primed = false;
+  if (color) {
+    keyC = new hsiF [numPix];
+    lastC = new hsiF [numPix];
+    deltaC = new hsiF [numPix];
+    if ((keyC == NULL) || (lastC == NULL) || (deltaC == NULL)) {
+      freeArrays();
+      return (false);
+    }
+    memset(keyC, 0, numPix * sizeof(hsiF));
+  }
+  else {
+    keyF = new float [numPix];
+    lastF = new float [numPix];
+    deltaF = new float [numPix];
+    if ((keyF == NULL) || (lastF == NULL) || (deltaF == NULL)) {
+      freeArrays();
+      return (false);
+    }
+    memset(keyF, 0, numPix * sizeof(float));
+  }
+  numPixels = numPix;
+  return (true);
+}
+
+
+/* keyframeClass::commitKey()
+    Commits the keyframe rendered into scalarKey() or colorKey(). Output then interpolates from the previous keyframe to this one
+    over the next framesPerKey output frames. The render target is swapped with the previous keyframe, so scalarKey() and
+    colorKey() must be called again before rendering the next keyframe.
+  Parameters: None
+  Returns: None
+*/
+void keyframeClass::commitKey() {
+  float *swapF;
+  hsiF *swapC;
+  float dh;
+
+  if (numPixels == 0)
+    return;
+  if (color) {
+    for (uint32_t p = 0; p < numPixels; p++) {
+      if (!primed) {  // first keyframe: no interpolation
+        deltaC[p] = {0, 0, 0};
+        continue;
+      }
+      if (keyC[p].i == 0) {   // fading out: keep the previous hue and saturation
+        keyC[p].h = lastC[p].h;
+        keyC[p].s = lastC[p].s;
+      }
+      if (lastC[p].i == 0) {  // fading in: use the new hue and saturation throughout
+        deltaC[p].h = 0;
+        deltaC[p].s = 0;
+      }
+      else {
+        dh = keyC[p].h - lastC[p].h;
+        dh -= (dh > 0.5) ? 1.0 : 0;   // shortest distance around the hue circle
+        dh += (dh < -0.5) ? 1.0 : 0;
+        deltaC[p].h = dh;
+        deltaC[p].s = keyC[p].s - lastC[p].s;
+      }
+      deltaC[p].i = keyC[p].i - lastC[p].i;
+    }
+    swapC = lastC;
+    lastC = keyC;
+    keyC = swapC;
+  }
+  else {
+    for (uint32_t p = 0; p < numPixels; p++)
+      deltaF[p] = primed ? (keyF[p] - lastF[p]) : 0;
+    swapF = lastF;
+    lastF = keyF;
+    keyF = swapF;
+  }
+  primed = true;
+  frameNum = 0;
+}
+
+
+/* keyframeClass::output()
+    Writes the scalar pixel values for the current output frame, interpolated between the last two keyframes, and advances to the
+    next output frame. Does nothing in color mode or before the first keyframe.
+  Parameters:
+    float *out: Output array (numPixels values)
+  Returns: None
+*/
+void keyframeClass::output(float *out) {
+  float back;   // fraction of the keyframe interval remaining, i.e. distance back from the last keyframe
+
+  if (color || !primed)
+    return;
+  frameNum++;
+  back = 1.0 - (frameNum * invFrames);
+  for (uint32_t p = 0; p < numPixels; p++)
+    out[p] = lastF[p] - (deltaF[p] * back);
+  if (frameNum >= framesPerKey)
+    frameNum = 0;   // next keyframe is due
+}
+
+
+/* keyframeClass::output() [Overload]
+    Writes the hsiF pixel colors for the current output frame, interpolated between the last two keyframes (with hue wrap-around),
+    and advances to the next output frame. Does nothing in scalar mode or before the first keyframe.
+  Parameters:
+    hsiF *out: Output array (numPixels colors)
+  Returns: None
+*/
+void keyframeClass::output(hsiF *out) {
+  float back, h;
+
+  if (!color || !primed)
+    return;
+  frameNum++;
+  back = 1.0 - (frameNum * invFrames);
+  for (uint32_t p = 0; p < numPixels; p++) {
+    h = lastC[p].h - (deltaC[p].h * back);
+    h += (h < 0) ? 1.0 : 0;   // wrap to 0 - 1
+    h -= (h >= 1.0) ? 1.0 : 0;
+    out[p].h = h;
+    out[p].s = lastC[p].s - (deltaC[p].s * back);
+    out[p].i = lastC[p].i - (deltaC[p].i * back);
+  }
+  if (frameNum >= framesPerKey)
+    frameNum = 0;   // next keyframe is due
+}
@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "Laser.h"
+#include "Trace.h"
 
 
 void laserClass::init(uint16_t numPix, float length, const laserConfigStruct *configParams) {
@@ -12,6 +13,7 @@ void laserClass::init(uint16_t numPix, float length, const laserConfigStruct *co
 
 
 void laserClass::start(hsiF laserColor, float zapDur, float duration) {
+  TRACE_BEGIN(TRACE_START, traceLibId);
   beamColor = laserColor;
   pixelSpacing = zapLen / (float) numPixels;
   emberDurMax = duration - zapDur;
@@ -21,6 +23,18 @@ void laserClass::start(hsiF laserColor, float zapDur, float duration) {
   stepNum = 0;
   zapFlow.start(zapDur, zapLen, 0);
   randomizer.randomize();
+  prepareFrame();
+  TRACE_END(TRACE_START, traceLibId);
+}
+
+
+void laserClass::bindContext(renderContextClass *context) {
+  ctx = context;
+  zapFlow.bindContext(context);
+  emberRamp.bindContext(context);
+  for (uint8_t n = 0; n < numEmberTypes; n++)
+    emberFlicker[n].bindContext(context);
+  randomizer.bindContext(context);
 }
 
 
@@ -35,7 +49,7 @@ void laserClass::step() {
         emberScale = 1.0;
         emberRamp.start(&emberScale, 0, emberDurMax);
         for (uint8_t n = 0; n < numEmberTypes; n++) {
-          flickerFreq = config->emberFreqMin + (((float) random(0, 101) / 100) * (config->emberFreqMax - config->emberFreqMin));
+          flickerFreq = config->emberFreqMin + (((float) ctx->random(0, 101) / 100) * (config->emberFreqMax - config->emberFreqMin));
           emberFlicker[n].start(emberDurMax, flickerFreq, flickerFilter, flickerMinVal);
         }
       }
@@ -49,10 +63,19 @@ void laserClass::step() {
     if (stepNum >= effectSteps) {  // if LASER effect is done
       active = false;
     }
+    prepareFrame();
   }
 }
 
 
+void laserClass::prepareFrame() {
+  invZapLen = 1.0 / zapLen;
+  beamTail = zapFlow.curPos - config->beamWidth;
+  for (uint8_t n = 0; n < numEmberTypes; n++)
+    emberI[n] = (phase == EMBER_PHASE) ? (emberFlicker[n].val() * emberScale) : 0;
+}
+
+
 hsiF laserClass::colorVal(uint16_t pixel) {
   float pixelPos;
   float distFromBeam;
@@ -64,16 +87,44 @@ hsiF laserClass::colorVal(uint16_t pixel) {
   if (phase == ZAP_PHASE) {
     if (zapFlow.curPos < pixelPos)
       return (laserOffColor);
-    distFromBeam = (zapFlow.curPos - config->beamWidth) - pixelPos;
+    distFromBeam = beamTail - pixelPos;
     if (distFromBeam <= 0)
       return (beamColor);
   }
   else    // phase == EMBER_PHASE
     distFromBeam = zapLen - pixelPos;
-  retColor = InterpHsi(config->zapStartColor, config->zapEndColor, (distFromBeam / zapLen));
-  if (phase == EMBER_PHASE) {
-    retColor.i *= emberFlicker[randomizer.getPixType(pixel)].val();
-    retColor.i *= emberScale;
-  }
+  retColor = InterpHsi(config->zapStartColor, config->zapEndColor, (distFromBeam * invZapLen));
+  if (phase == EMBER_PHASE)
+    retColor.i *= emberI[randomizer.getPixType(pixel)];
   return (retColor);
 }
+
+
+/* laserClass::render()
+    Batch version of colorVal() for a range of pixels. Only reads the laser state, so disjoint pixel ranges may be rendered
+    concurrently (e.g. by spanPoolClass).
+  Parameters:
+    hsiF *out: Output array; out[p] is set for p = first to (first + count - 1)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void laserClass::render(hsiF *out, uint32_t first, uint32_t count) {
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  for (uint32_t p = first; p < (first + count); p++)
+    out[p] = colorVal(p);
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+
+/* laserClass::render() [Overload]
+    Masked version of render(): renders only the pixels in a mask, one run at a time (see PixelMask.cpp). Pixels outside the mask
+    are neither computed nor written.
+  Parameters:
+    hsiF *out: Output array, indexed by pixel number
+    pixelMaskClass &mask: Pixels to render
+  Returns: None
+*/
+void laserClass::render(hsiF *out, pixelMaskClass &mask) {
+  mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, first, count); });
+}
@@ -25,3 +25,33 @@ void movingLineClass::step(float distance) {
 float movingLineClass::distance(coordStruct pos) {
   return ((coeffA * pos.x) + (coeffB * pos.y) + coeffC);
 }
+
+
+  // plane through refPos, moving in the direction of its normal: azimuth is measured in the x-y plane from the x axis, and elevation
+  // from the x-y plane toward +z. azimuth = (line angle + 90) and elevation = 0 gives a vertical plane that matches movingLineClass
+void movingPlaneClass::init(coord3Struct refPos, float azimuth, float elevation) {
+  float az, el;
+
+  az = (azimuth / 360.0) * TWO_PI;
+  el = (elevation / 360.0) * TWO_PI;
+  normX = cos(el) * cos(az);
+  normY = cos(el) * sin(az);
+  normZ = sin(el);
+  coeffD = -(normX * refPos.x) - (normY * refPos.y) - (normZ * refPos.z);
+}
+
+
+void movingPlaneClass::step(float distance) {
+  coeffD -= distance;   // moving along the unit normal reduces the signed distance of every point by the same amount
+}
+
+
+float movingPlaneClass::distance(coord3Struct pos) {
+  return ((normX * pos.x) + (normY * pos.y) + (normZ * pos.z) + coeffD);
+}
+
+
+void movingPlaneClass::distance(float *out, const float *x, const float *y, const float *z, uint32_t first, uint32_t count) {
+  for (uint32_t p = first; p < (first + count); p++)
+    out[p] = (normX * x[p]) + (normY * y[p]) + (normZ * z[p]) + coeffD;
+}
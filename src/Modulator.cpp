@@ -0,0 +1,130 @@
+/* MODULATOR.CPP
+    This module defines the modulatorClass, which allows a single ramp, sine or flicker effect to modulate a parameter of any number
+    of other effects. Without it, (for example) forty waves that fade in and out together each step an identical embedded ramp.
+
+    The modulator is initialized with a pointer to its source effect, which is started by the caller as usual. modulatorClass::step()
+    is called once per step period (instead of calling the source's step()), and the source output is saved in modulatorClass::val.
+    Effects that support modulators provide bind functions (e.g. waveClass::bindRamp(), sineClass::bindAmplitude()) that take a
+    pointer to a modulator; the bound effect then reads modulatorClass::val instead of computing the parameter itself.
+
+    waveClass, swaveClass and flickerClass hold only a pointer to the modulator that scales their output (an outputRampClass),
+    instead of embedding a rampClass in every object. Until a modulator is bound, the pointer refers to the shared unityModulator
+    (val == 1.0). Calling the effect's setRamp() allocates a rampModulatorClass (a modulator that owns its ramp) for that effect
+    alone, which the effect then starts and steps itself; binding a NULL pointer restores it (or unityModulator if setRamp() hasn't
+    been called). The effects remain value types: a copy of an effect gets its own copy of the allocated ramp.
+*/
+#include <Arduino.h>
+#include "Modulator.h"
+
+const modulatorClass unityModulator;
+
+
+/* outputRampClass::outputRampClass() [Copy constructor]
+    Copies the modulator selection of another effect, allocating a copy of its ramp (if any)
+  Parameters:
+    const outputRampClass &src: Output ramp of the effect being copied
+*/
+outputRampClass::outputRampClass(const outputRampClass &src) {
+  mod = &unityModulator;
+  own = NULL;
+  *this = src;
+}
+
+
+/* outputRampClass::operator=()
+    Copies the modulator selection of another effect. The copy gets its own copy of the allocated ramp, and uses it if the source
+    effect uses its ramp; a bound shared modulator is shared by both effects.
+  Parameters:
+    const outputRampClass &src: Output ramp of the effect being copied
+  Returns:
+    outputRampClass &: This object
+*/
+outputRampClass &outputRampClass::operator=(const outputRampClass &src) {
+  if (this == &src)
+    return (*this);
+  if (src.own == NULL) {
+    delete own;
+    own = NULL;
+  }
+  else if (own == NULL)
+    own = new rampModulatorClass(*src.own);
+  else
+    *own = *src.own;
+  if (src.mod == src.own)   // source uses its own ramp (if allocation failed, use no ramp)
+    mod = (own != NULL) ? (const modulatorClass *) own : &unityModulator;
+  else
+    mod = src.mod;
+  return (*this);
+}
+
+
+/* outputRampClass::~outputRampClass()
+    Destructor: frees the ramp allocated by the effect's setRamp()
+*/
+outputRampClass::~outputRampClass() {
+  delete own;
+}
+
+
+/* modulatorClass::init()
+    Sets a rampClass object as the modulator source
+  Parameters:
+    rampClass *src: Pointer to the source ramp
+  Returns: None
+*/
+void modulatorClass::init(rampClass *src) {
+  ramp = src;
+  sine = NULL;
+  flicker = NULL;
+  val = (src->active) ? src->val : 0;
+}
+
+
+/* modulatorClass::init() [Overload]
+    Sets a sineClass object as the modulator source
+  Parameters:
+    sineClass *src: Pointer to the source sine
+  Returns: None
+*/
+void modulatorClass::init(sineClass *src) {
+  ramp = NULL;
+  sine = src;
+  flicker = NULL;
+  val = src->value();
+}
+
+
+/* modulatorClass::init() [Overload]
+    Sets a flickerClass object as the modulator source
+  Parameters:
+    flickerClass *src: Pointer to the source flicker
+  Returns: None
+*/
+void modulatorClass::init(flickerClass *src) {
+  ramp = NULL;
+  sine = NULL;
+  flicker = src;
+  val = src->val();
+}
+
+
+/* modulatorClass::step()
+    Called once per step period (frame) to step the source effect and save its output value. As in init(), the output of a ramp
+    that hasn't been started (or has been stopped) is 0.
+  Parameters: None
+  Returns: None
+*/
+void modulatorClass::step() {
+  if (ramp != NULL) {
+    ramp->step();
+    val = (ramp->active) ? ramp->val : 0;
+  }
+  else if (sine != NULL) {
+    sine->step();
+    val = sine->value();
+  }
+  else if (flicker != NULL) {
+    flicker->step();
+    val = flicker->val();
+  }
+}
@@ -0,0 +1,254 @@
+/* OSCBANK.CPP
+    This module defines the oscBankClass, which implements a bank of independent level-shifted sine oscillators ("channels"). Each
+    channel has the same parameters and update() semantics as sineClass (frequency, offset and amplitude, optionally ramped to new
+    values over a specified duration, with the channel terminated when its amplitude reaches 0), but all channels are stepped
+    together. A typical use is a shimmer effect in which every pixel has its own slowly drifting frequency and phase.
+
+    To avoid calling sin() for every channel in every frame, each channel's phase is held as a 32-bit integer (a full cycle is 2^32,
+    so wrap-around is free), and the sine is read from a shared table with linear interpolation (max error about 5e-6). Channel
+    state is held in separate arrays, so the main loop in step() is a simple pass over contiguous data. Parameter ramps are applied
+    in a separate pass that is skipped when no channel is ramping.
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "OscBank.h"
+#include "Trace.h"
+
+float oscBankClass::sineTable[oscTableSize + 1];
+bool oscBankClass::tableReady = false;
+
+
+/* oscBankClass::freeArrays()
+    Frees the per-channel arrays allocated by init()
+  Parameters: None
+  Returns: None
+*/
+void oscBankClass::freeArrays() {
+  delete [] phase;
+  delete [] phaseInc;
+  delete [] freq;
+  delete [] offset;
+  delete [] amplitude;
+  delete [] freqEnd;
+  delete [] offsetEnd;
+  delete [] amplEnd;
+  delete [] freqDelta;
+  delete [] offsetDelta;
+  delete [] amplDelta;
+  delete [] rampSteps;
+  delete [] chanActive;
+  delete [] val;
+  phase = NULL;
+  phaseInc = NULL;
+  freq = NULL;
+  offset = NULL;
+  amplitude = NULL;
+  freqEnd = NULL;
+  offsetEnd = NULL;
+  amplEnd = NULL;
+  freqDelta = NULL;
+  offsetDelta = NULL;
+  amplDelta = NULL;
+  rampSteps = NULL;
+  chanActive = NULL;
+  val = NULL;
+}
+
+
+/* oscBankClass::init()
+    Allocates the per-channel state (and builds the shared sine table, if not already built). All channels are initially inactive.
+  Parameters:
+    uint32_t numChannels: Number of oscillators in the bank
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool oscBankClass::init(uint32_t numChannels) {
+  if (!tableReady) {
+    for (uint16_t t = 0; t <= oscTableSize; t++)
+      sineTable[t] = sin((TWO_PI * t) / oscTableSize);
+    tableReady = true;
+  }
+  freeArrays();
+  numChan = numChannels;
+  numRamping = 0;
+  active = false;
+  phase = new uint32_t [numChan];
+  phaseInc = new uint32_t [numChan];
+  freq = new float [numChan];
+  offset = new float [numChan];
+  amplitude = new float [numChan];
+  freqEnd = new float [numChan];
+  offsetEnd = new float [numChan];
+  amplEnd = new float [numChan];
+  freqDelta = new float [numChan];
+  offsetDelta = new float [numChan];
+  amplDelta = new float [numChan];
+  rampSteps = new uint16_t [numChan];
+  chanActive = new uint8_t [numChan];
+  val = new float [numChan];
+  if ((phase == NULL) || (phaseInc == NULL) || (freq == NULL) || (offset == NULL) || (amplitude == NULL) || (freqEnd == NULL) ||
+      (offsetEnd == NULL) || (amplEnd == NULL) || (freqDelta == NULL) || (offsetDelta == NULL) || (amplDelta == NULL) ||
+      (rampSteps == NULL) || (chanActive == NULL) || (val == NULL)) {
+    freeArrays();
+    numChan = 0;
+    return (false);
+  }
+  for (uint32_t c = 0; c < numChan; c++) {
+    phase[c] = 0;
+    phaseInc[c] = 0;
+    freq[c] = 0;
+    offset[c] = 0;
+    amplitude[c] = 0;
+    rampSteps[c] = 0;
+    chanActive[c] = 0;
+    val[c] = 0;
+  }
+  return (true);
+}
+
+
+/* oscBankClass::freqToInc()
+    Converts a frequency to a phase increment per step
+  Parameters:
+    float frequency: Frequency (Hz)
+  Returns:
+    uint32_t: Phase increment (full cycle = 2^32)
+*/
+uint32_t oscBankClass::freqToInc(float frequency) {
+  float cycles;
+
+  cycles = frequency * ctx->stepPeriod;   // cycles per step
+  cycles -= floor(cycles);  // only the fractional cycle matters (0 <= cycles < 1)
+  return ((uint32_t) (cycles * 4294967040.0));  // largest float below 2^32, so that the result can't overflow
+}
+
+
+/* oscBankClass::update()
+    Starts one channel, or updates its parameters if it is already active (see sineClass::update())
+  Parameters:
+    uint32_t chan: Channel number
+    float frequency: Sine wave frequency (Hz)
+    float level: Offset of sine wave baseline from 0 (0 - 1)
+    float ampl: Maximum absolute value of the sine wave (0 - 1) prior to the offset being applied
+    float rampDur: Duration (seconds) of the ramp from the previous parameters to the new values. 0 applies them immediately
+      (and restarts the phase at 0, as in sineClass)
+  Returns: None
+*/
+void oscBankClass::update(uint32_t chan, float frequency, float level, float ampl, float rampDur) {
+  uint16_t steps;
+
+  if (chan >= numChan)
+    return;
+  if ((chanActive[chan] == 0) || (rampDur == 0)) {  // if channel hasn't been started yet, or if parameters have immediate effect
+    chanActive[chan] = 1;
+    phase[chan] = 0;
+    freq[chan] = frequency;
+    offset[chan] = level;
+    amplitude[chan] = ampl;
+    phaseInc[chan] = freqToInc(frequency);
+    if (rampSteps[chan] > 0) {    // cancel any ramp in progress
+      rampSteps[chan] = 0;
+      numRamping--;
+    }
+  }
+  if (rampDur > 0) {    // parameters are to be "ramped in"
+    steps = max(ComputeSteps(rampDur), 1);
+    freqEnd[chan] = frequency;
+    offsetEnd[chan] = level;
+    amplEnd[chan] = ampl;
+    freqDelta[chan] = (frequency - freq[chan]) / steps;
+    offsetDelta[chan] = (level - offset[chan]) / steps;
+    amplDelta[chan] = (ampl - amplitude[chan]) / steps;
+    if (rampSteps[chan] == 0)
+      numRamping++;
+    rampSteps[chan] = steps;
+  }
+  active = true;
+}
+
+
+/* oscBankClass::updateAll()
+    Starts or updates every channel with the same parameters (e.g. to ramp a shimmer down to 0 amplitude)
+  Parameters:
+    (see oscBankClass::update())
+  Returns: None
+*/
+void oscBankClass::updateAll(float frequency, float level, float ampl, float rampDur) {
+  for (uint32_t c = 0; c < numChan; c++)
+    update(c, frequency, level, ampl, rampDur);
+}
+
+
+/* oscBankClass::setPhase()
+    Sets the current phase of one channel
+  Parameters:
+    uint32_t chan: Channel number
+    float phaseFrac: Phase, as a fraction of a complete cycle (0 - 1)
+  Returns: None
+*/
+void oscBankClass::setPhase(uint32_t chan, float phaseFrac) {
+  if (chan < numChan) {
+    phaseFrac -= floor(phaseFrac);
+    phase[chan] = (uint32_t) (phaseFrac * 4294967040.0);
+  }
+}
+
+
+/* oscBankClass::randomizePhase()
+    Sets the phase of every channel to a random value (from the render context's random stream), so that channels with the same
+    frequency aren't visibly synchronized
+  Parameters: None
+  Returns: None
+*/
+void oscBankClass::randomizePhase() {
+  for (uint32_t c = 0; c < numChan; c++)
+    phase[c] = (ctx->random(0x10000) << 16) | ctx->random(0x10000);
+}
+
+
+/* oscBankClass::step()
+    Called once per step period (frame) to advance every channel and compute its output value, if any channel is active
+  Parameters: None
+  Returns: None
+*/
+void oscBankClass::step() {
+  uint32_t idx, numActive;
+  float frac, s, v;
+
+  if (active) {
+    TRACE_BEGIN(TRACE_STEP, traceLibId);
+    if (numRamping > 0) {   // apply parameter ramps (see rampVarClass::step())
+      for (uint32_t c = 0; c < numChan; c++) {
+        if (rampSteps[c] > 0) {
+          rampSteps[c]--;
+          if (rampSteps[c] == 0) {  // end of ramp; avoid rounding errors
+            freq[c] = freqEnd[c];
+            offset[c] = offsetEnd[c];
+            amplitude[c] = amplEnd[c];
+            numRamping--;
+          }
+          else {
+            freq[c] += freqDelta[c];
+            offset[c] += offsetDelta[c];
+            amplitude[c] += amplDelta[c];
+          }
+          phaseInc[c] = freqToInc(freq[c]);
+        }
+      }
+    }
+    numActive = 0;
+    for (uint32_t c = 0; c < numChan; c++) {
+      phase[c] += phaseInc[c];
+      idx = phase[c] >> oscFracBits;
+      frac = (float) (phase[c] & ((1 << oscFracBits) - 1)) * (1.0f / (1 << oscFracBits));
+      s = sineTable[idx] + ((sineTable[idx + 1] - sineTable[idx]) * frac);
+      v = (s * amplitude[c]) + offset[c];
+      v = (v < 0) ? 0 : ((v > 1.0f) ? 1.0f : v);
+      val[c] = chanActive[c] ? v : 0;
+      numActive += chanActive[c];
+      chanActive[c] &= ((amplitude[c] != 0) || (rampSteps[c] != 0));  // terminate when the amplitude has been ramped down to 0
+    }
+    active = (numActive > 0);   // remains active for one more step after the last channel terminates, so that val is set to 0
+    TRACE_END(TRACE_STEP, traceLibId);
+  }
+}
@@ -0,0 +1,307 @@
+/* PALETTE.CPP
+    This module defines an 8-bit indexed-color frame buffer (indexedFrameClass) and the palettes used to display it (paletteClass).
+    Most effects produce a scalar value (0 - 1) per pixel, which would otherwise be mapped to a color per pixel with InterpHsi()-style
+    code and held in an hsiF frame buffer (12 bytes per pixel). Instead, each pixel holds a palette index (1 byte per pixel), and the
+    colors are resolved once per frame in the output stage through a 256-entry RGB lookup table.
+
+    The effects' batch render() functions still produce float values. If a whole frame of them is rendered and then passed to
+    setLevels(), the float frame costs another 4 bytes per pixel (5 in total). renderLevels() avoids this: it calls a render
+    function for chunks of levelChunkSize pixels, into a small float buffer on the stack, and converts each chunk to indexes, so
+    the frame costs only 1 byte per pixel. The render function renders pixels first to (first + count - 1) into out[0] onwards, e.g.
+    by offsetting the position array: wave.render(out, pos + first, 0, count).
+
+    A palette is defined as a set of HSI colors, either entry by entry or as a gradient between stops. resolve() converts the palette
+    to RGB, applying the current hue rotation, index rotation (color cycling) and brightness, so any of these can be animated
+    without re-rendering the effects: only the 256 palette entries are converted, rather than every pixel. resolve() does nothing if
+    the palette hasn't changed since the last call, so it can be called every frame.
+
+    Typical use, once per frame:
+      void renderWave(void *arg, float *out, uint32_t first, uint32_t count) { wave.render(out, pos + first, 0, count); }
+      ...
+      frameBuf.renderLevels(renderWave, NULL);
+      pal.setHueShift(hue);     // e.g. slowly rotating
+      frameBuf.output(pipe.backBuffer(), 3, pal);
+      pipe.submit();
+*/
+#include <Arduino.h>
+#include "Palette.h"
+
+
+/* paletteClass::paletteClass()
+    Constructor: initializes the palette to a white intensity ramp (index 0 = off, 255 = full intensity)
+*/
+paletteClass::paletteClass() {
+  for (uint16_t n = 0; n < paletteSize; n++)
+    entry[n] = {0, 0, (float) n / (paletteSize - 1)};
+  hueShift = 0;
+  cycleOffset = 0;
+  brightness = 1.0;
+  dirty = true;
+}
+
+
+/* paletteClass::setEntry()
+    Sets the color of a single palette entry
+  Parameters:
+    uint8_t index: Palette index
+    hsiF color: Color (hue, saturation and intensity, each 0 - 1)
+  Returns: None
+*/
+void paletteClass::setEntry(uint8_t index, hsiF color) {
+  entry[index] = color;
+  dirty = true;
+}
+
+
+/* paletteClass::setGradient()
+    Sets the palette to a linear HSI gradient between stops. Entries before the first stop or after the last stop are set to the
+    color of that stop.
+  Parameters:
+    const paletteStopStruct *stops: Array of stops, in increasing order of position
+    uint8_t numStops: Number of stops (1 - paletteMaxStops)
+    bool shortestHue: If true, hues are interpolated in the direction of the shortest distance (with wrap-around); otherwise hues
+      are interpolated in the positive direction
+  Returns: None
+*/
+void paletteClass::setGradient(const paletteStopStruct *stops, uint8_t numStops, bool shortestHue) {
+  uint8_t s = 0;
+  float pos, frac, h;
+
+  if ((stops == NULL) || (numStops == 0))
+    return;
+  numStops = min(numStops, paletteMaxStops);
+  for (uint16_t n = 0; n < paletteSize; n++) {
+    pos = (float) n / (paletteSize - 1);
+    while (((s + 1) < numStops) && (pos > stops[s + 1].pos))  // find the stops on either side of pos
+      s++;
+    if ((pos <= stops[0].pos) || ((s + 1) >= numStops)) {
+      entry[n] = (pos <= stops[0].pos) ? stops[0].color : stops[numStops - 1].color;
+      continue;
+    }
+    frac = (pos - stops[s].pos) / max(stops[s + 1].pos - stops[s].pos, 0.0001);
+    entry[n] = InterpHsi(stops[s].color, stops[s + 1].color, frac);
+    h = stops[s].color.h + (HueDistance(stops[s].color.h, stops[s + 1].color.h, shortestHue, true) * frac);
+    entry[n].h = h - floor(h);  // wrap to 0 - 1
+  }
+  dirty = true;
+}
+
+
+/* paletteClass::setHueShift()
+    Sets the hue rotation applied to every palette entry (e.g. animated for a hue-rotating palette)
+  Parameters:
+    float shift: Hue rotation; the integer part has no effect
+  Returns: None
+*/
+void paletteClass::setHueShift(float shift) {
+  shift -= floor(shift);
+  if (shift != hueShift) {
+    hueShift = shift;
+    dirty = true;
+  }
+}
+
+
+/* paletteClass::setCycle()
+    Sets the index rotation (color cycling): pixel index n is displayed with the color of palette entry (n + offset)
+  Parameters:
+    uint8_t offset: Index rotation
+  Returns: None
+*/
+void paletteClass::setCycle(uint8_t offset) {
+  if (offset != cycleOffset) {
+    cycleOffset = offset;
+    dirty = true;
+  }
+}
+
+
+/* paletteClass::setBrightness()
+    Sets the intensity scale applied to every palette entry
+  Parameters:
+    float level: Brightness (0 - 1)
+  Returns: None
+*/
+void paletteClass::setBrightness(float level) {
+  level = constrain(level, 0, 1);
+  if (level != brightness) {
+    brightness = level;
+    dirty = true;
+  }
+}
+
+
+/* paletteClass::resolve()
+    Converts the palette to the RGB lookup table, if it has changed. Called by indexedFrameClass::output().
+  Parameters: None
+  Returns: None
+*/
+void paletteClass::resolve() {
+  hsiF color;
+
+  if (!dirty)
+    return;
+  for (uint16_t n = 0; n < paletteSize; n++) {
+    color = entry[(uint8_t) (n + cycleOffset)];
+    color.h += hueShift;
+    color.h -= (color.h >= 1.0) ? 1.0 : 0;
+    color.i *= brightness;
+    HsiToRgb(color, lut[n]);
+  }
+  dirty = false;
+}
+
+
+/* paletteClass::HsiToRgb()
+    Converts an HSI color to 8-bit RGB, using the HSI sector formulas commonly used for LEDs (hue 0 = red, 1/3 = green, 2/3 = blue),
+    where the R + G + B total is proportional to intensity: a fully-saturated primary at intensity 1 is full scale, while unsaturated
+    (white) colors are shared equally between the three LEDs
+  Parameters:
+    hsiF color: Color (hue, saturation and intensity, each 0 - 1)
+    uint8_t *rgbOut: Set to the red, green and blue values (3 bytes)
+  Returns: None
+*/
+void paletteClass::HsiToRgb(hsiF color, uint8_t *rgbOut) {
+  float h, s, i, a, b, c;
+  uint8_t sector;
+
+  h = (color.h - floor(color.h)) * 3;   // sector (0 - 2) plus fraction
+  sector = (uint8_t) h;
+  h = (h - sector) * (TWO_PI / 3);   // angle within the sector (0 - 120 degrees)
+  s = constrain(color.s, 0, 1);
+  i = constrain(color.i, 0, 1);
+  a = (i / 3) * (1 + ((s * cos(h)) / cos((PI / 3) - h)));   // leading primary
+  b = (i / 3) * (1 - s);                                   // lagging primary
+  c = i - (a + b);                                         // third primary
+  a = constrain(a, 0, 1) * 255;
+  b = constrain(b, 0, 1) * 255;
+  c = constrain(c, 0, 1) * 255;
+  switch (sector) {
+    case 0:
+      rgbOut[0] = round(a);
+      rgbOut[1] = round(c);
+      rgbOut[2] = round(b);
+      break;
+    case 1:
+      rgbOut[0] = round(b);
+      rgbOut[1] = round(a);
+      rgbOut[2] = round(c);
+      break;
+    default:
+      rgbOut[0] = round(c);
+      rgbOut[1] = round(b);
+      rgbOut[2] = round(a);
+  }
+}
+
+
+/* indexedFrameClass::init()
+    Allocates the index buffer (cleared to index 0)
+  Parameters:
+    uint32_t numPix: Number of pixels
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool indexedFrameClass::init(uint32_t numPix) {
+  delete [] index;
+  numPixels = 0;
+  index = new uint8_t [numPix];
+  if (index == NULL)
+    return (false);
+  memset(index, 0, numPix);
+  numPixels = numPix;
+  return (true);
+}
+
+
+/* indexedFrameClass::setLevel()
+    Sets the palette index of a pixel from a scalar effect value
+  Parameters:
+    uint32_t pixel: Pixel number
+    float level: Effect value (0 - 1), mapped to palette index 0 - 255
+  Returns: None
+*/
+void indexedFrameClass::setLevel(uint32_t pixel, float level) {
+  level = constrain(level, 0, 1);
+  index[pixel] = (uint8_t) ((level * 255) + 0.5);
+}
+
+
+/* indexedFrameClass::setLevels()
+    Batch version of setLevel(), e.g. for the output array of an effect's render() function
+  Parameters:
+    const float *level: Array of effect values (0 - 1), indexed by pixel number
+    uint32_t first: First pixel to set
+    uint32_t count: Number of pixels to set
+  Returns: None
+*/
+void indexedFrameClass::setLevels(const float *level, uint32_t first, uint32_t count) {
+  if (first >= numPixels)
+    return;
+  quantize(level + first, first, min(count, numPixels - first));
+}
+
+
+/* indexedFrameClass::renderLevels()
+    Sets the palette index of every pixel from effect values rendered in chunks of levelChunkSize pixels, so that no float frame
+    buffer is needed
+  Parameters:
+    levelFuncPtr renderFunc: Function that renders the effect values of pixels first to (first + count - 1) into out[0] onwards
+    void *arg: Argument passed to renderFunc
+  Returns: None
+*/
+void indexedFrameClass::renderLevels(levelFuncPtr renderFunc, void *arg) {
+  float level[levelChunkSize];
+  uint32_t count;
+
+  for (uint32_t first = 0; first < numPixels; first += levelChunkSize) {
+    count = min((uint32_t) levelChunkSize, numPixels - first);
+    renderFunc(arg, level, first, count);
+    quantize(level, first, count);
+  }
+}
+
+
+/* indexedFrameClass::quantize()
+    Converts effect values to palette indexes (used by setLevels() and renderLevels())
+  Parameters:
+    const float *level: Effect values (0 - 1); level[0] is the value of pixel first
+    uint32_t first: First pixel to set
+    uint32_t count: Number of pixels to set (first + count must not exceed numPixels)
+  Returns: None
+*/
+void indexedFrameClass::quantize(const float *level, uint32_t first, uint32_t count) {
+  float v;
+
+  for (uint32_t n = 0; n < count; n++) {
+    v = level[n];
+    v = (v < 0) ? 0 : ((v > 1) ? 1 : v);
+    index[first + n] = (uint8_t) ((v * 255) + 0.5);
+  }
+}
+
+
+/* indexedFrameClass::output()
+    Resolves the palette (if changed) and converts the index buffer to an RGB frame, e.g. the back buffer of a framePipeClass
+  Parameters:
+    uint8_t *frame: Output frame buffer (numPixels * bytesPerPixel bytes)
+    uint8_t bytesPerPixel: 3 for RGB; 4 for RGBW (the white byte is set to 0)
+    paletteClass &pal: Palette
+  Returns: None
+*/
+void indexedFrameClass::output(uint8_t *frame, uint8_t bytesPerPixel, paletteClass &pal) {
+  const uint8_t *color;
+
+  if ((frame == NULL) || (bytesPerPixel < 3))
+    return;
+  pal.resolve();
+  for (uint32_t p = 0; p < numPixels; p++) {
+    color = pal.rgb(index[p]);
+    frame[0] = color[0];
+    frame[1] = color[1];
+    frame[2] = color[2];
+    if (bytesPerPixel > 3)
+      frame[3] = 0;
+    frame += bytesPerPixel;
+  }
+}
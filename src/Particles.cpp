@@ -0,0 +1,321 @@
+/* PARTICLES.CPP
+    This module defines the particlePoolClass, which manages a fixed-capacity pool of lightweight particles for scenes that need
+    hundreds of simultaneous droplets or pops (e.g. rain and fireworks), where an array of dropletClass or popClass objects would
+    be stepped and rendered one object at a time, with every pixel tested against every object.
+
+    Two kinds of particle are supported, both moving along a linear strip:
+      - Droplet: same shape and kinematics as dropletClass (initial velocity, acceleration, head ramp, head and random tail length),
+        moving in the positive direction from its start position until its tail passes the end position
+      - Pop: same shape as a linear popClass, expanding in both directions from a center position for a specified duration
+    Several strips can share one pool by assigning each strip its own range of positions (e.g. strip n starts at n * 10000 mm).
+
+    Particle state is held in separate arrays (position, velocity, acceleration, etc.), and particles are allocated from a free list
+    by the emit functions and returned to it when they finish, so no memory is allocated after init(). The live particles are kept
+    in a dense index list, so step() and render() cost is proportional to the number of live particles. render() visits only the
+    pixels covered by each particle, and combines overlapping particles using the maximum value.
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Particles.h"
+#include "Trace.h"
+
+
+/* particlePoolClass::freeArrays()
+    Frees the arrays allocated by init()
+  Parameters: None
+  Returns: None
+*/
+void particlePoolClass::freeArrays() {
+  delete [] live;
+  delete [] freeList;
+  delete [] kind;
+  delete [] pos;
+  delete [] vel;
+  delete [] acc;
+  delete [] origin;
+  delete [] endPos;
+  delete [] rampLen;
+  delete [] headLen;
+  delete [] tailLen;
+  delete [] level;
+  delete [] fade;
+  delete [] stepsLeft;
+  live = NULL;
+  freeList = NULL;
+  kind = NULL;
+  pos = NULL;
+  vel = NULL;
+  acc = NULL;
+  origin = NULL;
+  endPos = NULL;
+  rampLen = NULL;
+  headLen = NULL;
+  tailLen = NULL;
+  level = NULL;
+  fade = NULL;
+  stepsLeft = NULL;
+}
+
+
+/* particlePoolClass::init()
+    Allocates the particle arrays
+  Parameters:
+    uint16_t maxParticles: Max number of live particles (less than particleNone)
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool particlePoolClass::init(uint16_t maxParticles) {
+  freeArrays();
+  capacity = min(maxParticles, (uint16_t) (particleNone - 1));
+  live = new uint16_t [capacity];
+  freeList = new uint16_t [capacity];
+  kind = new uint8_t [capacity];
+  pos = new float [capacity];
+  vel = new float [capacity];
+  acc = new float [capacity];
+  origin = new float [capacity];
+  endPos = new float [capacity];
+  rampLen = new float [capacity];
+  headLen = new float [capacity];
+  tailLen = new float [capacity];
+  level = new float [capacity];
+  fade = new float [capacity];
+  stepsLeft = new uint16_t [capacity];
+  if ((live == NULL) || (freeList == NULL) || (kind == NULL) || (pos == NULL) || (vel == NULL) || (acc == NULL) || (origin == NULL) ||
+      (endPos == NULL) || (rampLen == NULL) || (headLen == NULL) || (tailLen == NULL) || (level == NULL) || (fade == NULL) ||
+      (stepsLeft == NULL)) {
+    freeArrays();
+    capacity = 0;
+  }
+  clear();
+  return (capacity > 0);
+}
+
+
+/* particlePoolClass::clear()
+    Kills all particles
+  Parameters: None
+  Returns: None
+*/
+void particlePoolClass::clear() {
+  numLive = 0;
+  numFree = capacity;
+  for (uint16_t n = 0; n < capacity; n++)
+    freeList[n] = capacity - 1 - n;   // so that particle 0 is allocated first
+  active = false;
+}
+
+
+/* particlePoolClass::alloc()
+    Allocates a particle from the free list and adds it to the live list, with default (no fade, no time limit) settings
+  Parameters: None
+  Returns:
+    uint16_t: Particle index, or particleNone if the pool is full
+*/
+uint16_t particlePoolClass::alloc() {
+  uint16_t n;
+
+  if (numFree == 0)
+    return (particleNone);
+  n = freeList[--numFree];
+  live[numLive++] = n;
+  level[n] = 1.0;
+  fade[n] = 0;
+  stepsLeft[n] = particleNoLimit;
+  active = true;
+  return (n);
+}
+
+
+/* particlePoolClass::emitDroplet()
+    Emits a droplet particle (see dropletClass::start())
+  Parameters:
+    const dropletConfigStruct *cfg: Droplet shape and kinematic parameters
+    float startPos: Start position (mm) of the droplet leading edge
+    float dist: Distance (mm) from startPos to the end of travel; the particle ends when its tail passes this point
+  Returns:
+    uint16_t: Particle index, or particleNone if the pool is full
+*/
+uint16_t particlePoolClass::emitDroplet(const dropletConfigStruct *cfg, float startPos, float dist) {
+  uint16_t n;
+
+  n = alloc();
+  if (n != particleNone) {
+    kind[n] = PARTICLE_DROPLET;
+    origin[n] = startPos;
+    pos[n] = startPos;
+    vel[n] = cfg->initVelocity * ctx->stepPeriod;   // convert initial velocity to mm/step
+    acc[n] = cfg->acceleration * ctx->stepPeriod * ctx->stepPeriod;   // convert accel (mm/sec^2) to (mm/step^2)
+    rampLen[n] = max(cfg->headRampLen, 0.001);
+    headLen[n] = cfg->headLength;
+    tailLen[n] = ctx->random(cfg->minTailLength, cfg->maxTailLength);   // random tail length
+    tailLen[n] = max(tailLen[n], 0.001);
+    endPos[n] = startPos + dist + rampLen[n] + headLen[n] + tailLen[n];   // tail goes "off the end"
+  }
+  return (n);
+}
+
+
+/* particlePoolClass::emitPop()
+    Emits a pop particle that expands linearly in both directions from a center position (see popClass::start())
+  Parameters:
+    float center: Center position (mm)
+    float distance: Radius (mm) at the end of the duration
+    float duration: Duration (seconds)
+    float rampWidth: Distance (mm) from the radius to the top of the ramp
+  Returns:
+    uint16_t: Particle index, or particleNone if the pool is full
+*/
+uint16_t particlePoolClass::emitPop(float center, float distance, float duration, float rampWidth) {
+  uint16_t n;
+  uint16_t steps;
+
+  n = alloc();
+  if (n != particleNone) {
+    steps = max(ComputeSteps(duration), 1);
+    kind[n] = PARTICLE_POP;
+    origin[n] = center;
+    pos[n] = 0;
+    vel[n] = distance / steps;
+    acc[n] = 0;
+    rampLen[n] = constrain(rampWidth, 1, max(distance, 1));   // ramp width must be > 0 and <= distance
+    stepsLeft[n] = min(steps, (uint16_t) (particleNoLimit - 1));
+  }
+  return (n);
+}
+
+
+/* particlePoolClass::setFade()
+    Fades a particle's output level from its current value to 0 over a specified time; the particle ends when the level reaches 0
+  Parameters:
+    uint16_t particle: Particle index returned by an emit function
+    float fadeTime: Fade duration (seconds)
+  Returns: None
+*/
+void particlePoolClass::setFade(uint16_t particle, float fadeTime) {
+  if (particle < capacity)
+    fade[particle] = level[particle] / max(ComputeSteps(fadeTime), 1);
+}
+
+
+/* particlePoolClass::kill()
+    Ends a particle immediately and returns it to the free list
+  Parameters:
+    uint16_t particle: Particle index returned by an emit function
+  Returns: None
+*/
+void particlePoolClass::kill(uint16_t particle) {
+  for (uint16_t i = 0; i < numLive; i++) {
+    if (live[i] == particle) {
+      live[i] = live[--numLive];  // move last entry into this position
+      freeList[numFree++] = particle;
+      return;
+    }
+  }
+}
+
+
+/* particlePoolClass::step()
+    Called once per step period (frame) to move every live particle, and to recycle particles that have finished
+  Parameters: None
+  Returns: None
+*/
+void particlePoolClass::step() {
+  uint16_t i, n;
+  bool done;
+
+  if (active) {
+    TRACE_BEGIN(TRACE_STEP, traceLibId);
+    i = 0;
+    while (i < numLive) {
+      n = live[i];
+      pos[n] += vel[n];
+      vel[n] += acc[n];
+      level[n] -= fade[n];
+      if (stepsLeft[n] != particleNoLimit)
+        stepsLeft[n]--;
+      done = (stepsLeft[n] == 0) || (level[n] <= 0);
+      if (kind[n] == PARTICLE_DROPLET)
+        done |= (pos[n] >= endPos[n]);
+      if (done) {
+        live[i] = live[--numLive];  // recycle (don't increment i; re-check moved entry)
+        freeList[numFree++] = n;
+      }
+      else
+        i++;
+    }
+    active = (numLive > 0);
+    TRACE_END(TRACE_STEP, traceLibId);
+  }
+}
+
+
+/* particlePoolClass::render()
+    Renders every live particle into a strip of equally-spaced pixels, visiting only the pixels covered by each particle. Each pixel
+    is set to the maximum of its current value and the particle value, so out[] should be cleared (or pre-rendered with other
+    effects) before each frame.
+  Parameters:
+    float *out: Array of numPix pixel values
+    uint16_t numPix: Number of pixels in the strip
+    float spacing: Distance between pixels (mm)
+    float firstPos: Position (mm) of pixel 0
+  Returns: None
+*/
+void particlePoolClass::render(float *out, uint16_t numPix, float spacing, float firstPos) {
+  uint16_t n;
+  float lo, hi;       // span (mm) covered by the particle
+  float tailPos, headEnd, headSlope, tailSlope, invRamp;
+  float x, rel, v;
+  int32_t p0, p1;
+  float invSpacing;
+
+  if (!active || (numPix == 0))
+    return;
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  invSpacing = 1.0 / spacing;
+  for (uint16_t i = 0; i < numLive; i++) {
+    n = live[i];
+    if (kind[n] == PARTICLE_DROPLET) {
+      headEnd = rampLen[n] + headLen[n];
+      tailPos = pos[n] - headEnd - tailLen[n];
+      lo = max(tailPos, origin[n]);
+      hi = pos[n];
+    }
+    else {
+      lo = origin[n] - pos[n];
+      hi = origin[n] + pos[n];
+    }
+    p0 = (int32_t) ceil((lo - firstPos) * invSpacing);   // first and last pixels inside the span
+    p1 = (int32_t) floor((hi - firstPos) * invSpacing);
+    p0 = max(p0, 0);
+    p1 = min(p1, (int32_t) numPix - 1);
+    if (p0 > p1)
+      continue;
+    if (kind[n] == PARTICLE_DROPLET) {    // see dropletClass::value()
+      headSlope = 1.0 / rampLen[n];
+      tailSlope = 1.0 / tailLen[n];
+      for (int32_t p = p0; p <= p1; p++) {
+        x = firstPos + (p * spacing);
+        rel = pos[n] - x;   // distance behind the leading edge
+        if (rel < rampLen[n])
+          v = rel * headSlope;
+        else if (rel < headEnd)
+          v = 1.0;
+        else
+          v = (x - tailPos) * tailSlope;
+        v *= level[n];
+        out[p] = max(out[p], v);
+      }
+    }
+    else {    // pop; see popClass::value()
+      invRamp = 1.0 / rampLen[n];
+      for (int32_t p = p0; p <= p1; p++) {
+        rel = pos[n] - fabsf(firstPos + (p * spacing) - origin[n]);   // distance inside the radius
+        v = (rel > rampLen[n]) ? 1.0 : (rel * invRamp);
+        v *= level[n];
+        out[p] = max(out[p], v);
+      }
+    }
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
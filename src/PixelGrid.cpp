@@ -0,0 +1,221 @@
+/* PIXELGRID.CPP
+    This module defines the pixelGridClass, a uniform-grid spatial index over the (x, y) coordinates of the pixels in a 2-dimensional
+    pixel map (e.g. as produced by stripMgrClass::getCoord() for each pixel). The grid is built once by init(); the pixel numbers
+    are then sorted by cell, with the start of each cell's list held in cellStart[] (so the index uses 2 bytes per pixel plus 2 bytes
+    per cell, and no per-cell allocation).
+
+    Queries return the list of pixels within an annulus, disc or rectangle. Only the cells that overlap the query shape are
+    visited; cells that lie entirely inside the shape are copied without testing each pixel, so the query time is proportional to
+    the number of pixels found plus the number of cells crossed by the shape boundary. This allows position-based effects such as
+    popClass to render only the pixels they cover (see popClass::render()), rather than testing every pixel in the map.
+
+    The results of each query are held in a buffer owned by the grid, and are valid until the next query.
+*/
+#include <Arduino.h>
+#include "PixelGrid.h"
+
+
+/* pixelGridClass::freeArrays()
+    Frees the arrays allocated by init()
+  Parameters: None
+  Returns: None
+*/
+void pixelGridClass::freeArrays() {
+  delete [] cellStart;
+  delete [] cellPixels;
+  delete [] result;
+  cellStart = NULL;
+  cellPixels = NULL;
+  result = NULL;
+}
+
+
+/* pixelGridClass::init()
+    Builds the grid index for a pixel map. The coordinate arrays are referenced (not copied), and must remain valid and unchanged.
+  Parameters:
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    uint16_t numPix: Number of pixels
+    float cell: Cell size (mm). A value <= 0 selects a size that averages about 4 pixels per cell
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool pixelGridClass::init(const float *x, const float *y, uint16_t numPix, float cell) {
+  float maxX, maxY;
+  uint32_t numCells;
+  uint16_t c;
+
+  freeArrays();
+  xCoord = x;
+  yCoord = y;
+  numPixels = numPix;
+  numResults = 0;
+  if (numPixels == 0)
+    return (false);
+  minX = maxX = x[0];
+  minY = maxY = y[0];
+  for (uint16_t p = 1; p < numPixels; p++) {
+    minX = min(minX, x[p]);
+    maxX = max(maxX, x[p]);
+    minY = min(minY, y[p]);
+    maxY = max(maxY, y[p]);
+  }
+  if (cell <= 0)  // default: about 4 pixels per cell
+    cell = sqrt((max(maxX - minX, 1) * max(maxY - minY, 1) * 4) / numPixels);
+  cellSize = max(cell, 0.001);
+  while (true) {  // increase cell size until the number of cells is within limits
+    invCellSize = 1.0 / cellSize;   // the same expression as cellOf(), so that the pixels at maxX and maxY are in the last cell
+    cols = (uint16_t) min(((maxX - minX) * invCellSize) + 1, 65535);
+    rows = (uint16_t) min(((maxY - minY) * invCellSize) + 1, 65535);
+    numCells = (uint32_t) cols * rows;
+    if (numCells <= gridMaxCells)
+      break;
+    cellSize *= 1.5;
+  }
+  cellStart = new uint16_t [numCells + 1];
+  cellPixels = new uint16_t [numPixels];
+  result = new uint16_t [numPixels];
+  if ((cellStart == NULL) || (cellPixels == NULL) || (result == NULL)) {
+    freeArrays();
+    numPixels = 0;
+    return (false);
+  }
+  memset(cellStart, 0, (numCells + 1) * sizeof(uint16_t));
+  for (uint16_t p = 0; p < numPixels; p++) {    // count pixels in each cell (offset by 1 for the prefix sum)
+    c = cellOf(x[p], y[p]);
+    cellStart[c + 1]++;
+  }
+  for (uint32_t n = 1; n <= numCells; n++)   // prefix sum: cellStart[c] = first entry of cell c
+    cellStart[n] += cellStart[n - 1];
+  for (uint16_t p = 0; p < numPixels; p++) {    // fill cells, using cellStart[c] as the insert position
+    c = cellOf(x[p], y[p]);
+    cellPixels[cellStart[c]++] = p;
+  }
+  for (uint32_t n = numCells; n > 0; n--)   // restore cellStart[] (each entry was advanced to the start of the next cell)
+    cellStart[n] = cellStart[n - 1];
+  cellStart[0] = 0;
+  return (true);
+}
+
+
+/* pixelGridClass::cellOf()
+    Returns the cell containing a point of the map, clamped to the last column and row
+  Parameters:
+    float px, py: Point (mm), within the bounding box of the pixel coordinates
+  Returns:
+    uint16_t: Cell number
+*/
+uint16_t pixelGridClass::cellOf(float px, float py) {
+  uint16_t col, row;
+
+  col = (uint16_t) min((px - minX) * invCellSize, cols - 1);
+  row = (uint16_t) min((py - minY) * invCellSize, rows - 1);
+  return ((row * cols) + col);
+}
+
+
+/* pixelGridClass::addCell()
+    Adds every pixel in a cell to the query results, without testing
+  Parameters:
+    uint16_t cell: Cell number
+  Returns: None
+*/
+void pixelGridClass::addCell(uint16_t cell) {
+  for (uint16_t i = cellStart[cell]; i < cellStart[cell + 1]; i++)
+    result[numResults++] = cellPixels[i];
+}
+
+
+/* pixelGridClass::queryAnnulus()
+    Finds the pixels whose distance from a center point is in the range rIn to rOut
+  Parameters:
+    float cx, cy: Center point (mm)
+    float rIn: Inner radius (mm); a value < 0 finds all pixels within rOut (a disc)
+    float rOut: Outer radius (mm)
+  Returns:
+    uint16_t: Number of pixels found; the pixel numbers are returned by results()
+*/
+uint16_t pixelGridClass::queryAnnulus(float cx, float cy, float rIn, float rOut) {
+  int32_t c0, c1, r0, r1;
+  float cellX0, cellY0, dx, dy, nearX, nearY, farX, farY;
+  float nearSq, farSq, distSq, rInSq, rOutSq;
+  uint16_t cell, p;
+
+  numResults = 0;
+  if ((numPixels == 0) || (rOut < 0))
+    return (0);
+  rInSq = (rIn < 0) ? -1 : (rIn * rIn);
+  rOutSq = rOut * rOut;
+  c0 = max((int32_t) floor((cx - rOut - minX) * invCellSize), 0);   // range of cells overlapping the bounding box
+  c1 = min((int32_t) floor((cx + rOut - minX) * invCellSize), (int32_t) cols - 1);
+  r0 = max((int32_t) floor((cy - rOut - minY) * invCellSize), 0);
+  r1 = min((int32_t) floor((cy + rOut - minY) * invCellSize), (int32_t) rows - 1);
+  for (int32_t row = r0; row <= r1; row++) {
+    cellY0 = minY + (row * cellSize);
+    nearY = max(max(cellY0 - cy, cy - (cellY0 + cellSize)), 0);   // y distance from center to nearest point of cell
+    farY = max(fabs(cellY0 - cy), fabs(cellY0 + cellSize - cy));  // y distance to farthest point of cell
+    for (int32_t col = c0; col <= c1; col++) {
+      cellX0 = minX + (col * cellSize);
+      nearX = max(max(cellX0 - cx, cx - (cellX0 + cellSize)), 0);
+      farX = max(fabs(cellX0 - cx), fabs(cellX0 + cellSize - cx));
+      nearSq = (nearX * nearX) + (nearY * nearY);
+      farSq = (farX * farX) + (farY * farY);
+      if ((nearSq > rOutSq) || (farSq < rInSq))   // cell is entirely outside the annulus
+        continue;
+      cell = (row * cols) + col;
+      if ((nearSq >= rInSq) && (farSq <= rOutSq)) {   // cell is entirely inside the annulus
+        addCell(cell);
+        continue;
+      }
+      for (uint16_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {  // cell crosses the boundary: test each pixel
+        p = cellPixels[i];
+        dx = xCoord[p] - cx;
+        dy = yCoord[p] - cy;
+        distSq = (dx * dx) + (dy * dy);
+        if ((distSq >= rInSq) && (distSq <= rOutSq))
+          result[numResults++] = p;
+      }
+    }
+  }
+  return (numResults);
+}
+
+
+/* pixelGridClass::queryRect()
+    Finds the pixels within a rectangle
+  Parameters:
+    float x0, y0: Lower-left corner of the rectangle (mm)
+    float x1, y1: Upper-right corner of the rectangle (mm)
+  Returns:
+    uint16_t: Number of pixels found; the pixel numbers are returned by results()
+*/
+uint16_t pixelGridClass::queryRect(float x0, float y0, float x1, float y1) {
+  int32_t c0, c1, r0, r1;
+  float cellX0, cellY0;
+  uint16_t cell, p;
+
+  numResults = 0;
+  if ((numPixels == 0) || (x1 < x0) || (y1 < y0))
+    return (0);
+  c0 = max((int32_t) floor((x0 - minX) * invCellSize), 0);
+  c1 = min((int32_t) floor((x1 - minX) * invCellSize), (int32_t) cols - 1);
+  r0 = max((int32_t) floor((y0 - minY) * invCellSize), 0);
+  r1 = min((int32_t) floor((y1 - minY) * invCellSize), (int32_t) rows - 1);
+  for (int32_t row = r0; row <= r1; row++) {
+    cellY0 = minY + (row * cellSize);
+    for (int32_t col = c0; col <= c1; col++) {
+      cellX0 = minX + (col * cellSize);
+      cell = (row * cols) + col;
+      if ((cellX0 >= x0) && ((cellX0 + cellSize) <= x1) && (cellY0 >= y0) && ((cellY0 + cellSize) <= y1)) {
+        addCell(cell);  // cell is entirely inside the rectangle
+        continue;
+      }
+      for (uint16_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+        p = cellPixels[i];
+        if ((xCoord[p] >= x0) && (xCoord[p] <= x1) && (yCoord[p] >= y0) && (yCoord[p] <= y1))
+          result[numResults++] = p;
+      }
+    }
+  }
+  return (numResults);
+}
@@ -0,0 +1,220 @@
+/* PIXELMAP.CPP
+    This module defines the pixelMapClass, which holds the 3-dimensional coordinates of every pixel in an installation as a structure
+    of arrays (separate x, y and z arrays, indexed by pixel number). This is the form expected by the batch render() functions of the
+    position-based effects (e.g. popClass, wipeClass, sdfShapeClass), which can then read the coordinates of consecutive pixels
+    directly, without copying a coordinate struct for each pixel.
+
+    Pixels are appended in the order in which they are driven. 2D strips defined with stripMgrClass are added at a fixed z coordinate;
+    addLine() adds a straight run of pixels in any direction (e.g. a hanging tube) and addGrid() adds a rectangular volume (e.g. an
+    LED cube), with x varying fastest.
+
+    Large mapped installations can instead be described by a binary pixel map image, generated from a CSV file by the host tool
+    tools/pixmap_convert.py. The image is a pixmapHeaderStruct followed by the x, y and (optionally) z coordinate arrays as 4-byte
+    aligned little-endian floats, so attach() only validates the header and points the coordinate arrays into the image: there is no
+    parse or copy step. On the device the converter emits the image as a const PROGMEM array (placed in flash) to be passed to
+    attach(); on a host build with EFFECT_HOST_MMAP defined, load() memory-maps an image file and attaches it. For a 2D image, z()
+    returns NULL.
+*/
+#include <Arduino.h>
+#include "PixelMap.h"
+#include "StripMgr.h"
+
+
+/* pixelMapClass::pixelMapClass()
+    Constructor: creates an empty map
+*/
+pixelMapClass::pixelMapClass() {
+  capacity = 0;
+  numPixels = 0;
+  xCoord = yCoord = zCoord = NULL;
+  xStore = yStore = zStore = NULL;
+}
+
+
+/* pixelMapClass::freeArrays()
+    Frees the coordinate arrays allocated by init(), and releases any image attached by load()
+  Parameters: None
+  Returns: None
+*/
+void pixelMapClass::freeArrays() {
+  delete [] xStore;
+  delete [] yStore;
+  delete [] zStore;
+  xStore = yStore = zStore = NULL;
+  xCoord = yCoord = zCoord = NULL;
+#ifdef EFFECT_HOST_MMAP
+  mapping.unmap();
+#endif
+  capacity = 0;
+  numPixels = 0;
+}
+
+
+/* pixelMapClass::init()
+    Allocates the coordinate arrays, and removes any pixels previously defined
+  Parameters:
+    uint16_t maxPixels: Max number of pixels in the map
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool pixelMapClass::init(uint16_t maxPixels) {
+  freeArrays();
+  xStore = new float [maxPixels];
+  yStore = new float [maxPixels];
+  zStore = new float [maxPixels];
+  if ((xStore == NULL) || (yStore == NULL) || (zStore == NULL)) {
+    freeArrays();
+    return (false);
+  }
+  xCoord = xStore;
+  yCoord = yStore;
+  zCoord = zStore;
+  capacity = maxPixels;
+  return (true);
+}
+
+
+/* pixelMapClass::addPixel()
+    Appends a single pixel to the map
+  Parameters:
+    coord3Struct pos: Pixel coordinates (mm)
+  Returns:
+    bool: False if the map is full
+*/
+bool pixelMapClass::addPixel(coord3Struct pos) {
+  if (numPixels >= capacity)
+    return (false);
+  xStore[numPixels] = pos.x;
+  yStore[numPixels] = pos.y;
+  zStore[numPixels] = pos.z;
+  numPixels++;
+  return (true);
+}
+
+
+/* pixelMapClass::addStrip()
+    Appends the pixels of a 2D strip, in strip order
+  Parameters:
+    stripMgrClass &strip: Strip, previously set up with stripMgrClass::define()
+    uint16_t numPix: Number of pixels in the strip
+    float z: z coordinate (mm) of the plane containing the strip
+  Returns:
+    bool: False if the map is full (pixels that fit are added)
+*/
+bool pixelMapClass::addStrip(stripMgrClass &strip, uint16_t numPix, float z) {
+  stripCoordStruct coord;
+
+  for (uint16_t p = 0; p < numPix; p++) {
+    coord = (p == 0) ? strip.getCoord(0) : strip.getCoord();  // sequential access avoids searching the segments for each pixel
+    if (!addPixel({coord.x, coord.y, z}))
+      return (false);
+  }
+  return (true);
+}
+
+
+/* pixelMapClass::addLine()
+    Appends a straight run of equally-spaced pixels
+  Parameters:
+    coord3Struct startPos: Coordinates of the first pixel (mm)
+    float azimuth: Direction of the run (degrees) in the x-y plane, measured from the x axis
+    float elevation: Direction of the run (degrees) above the x-y plane; -90 for a hanging tube driven from the top
+    float spacing: Distance between pixels (mm)
+    uint16_t numPix: Number of pixels
+  Returns:
+    bool: False if the map is full (pixels that fit are added)
+*/
+bool pixelMapClass::addLine(coord3Struct startPos, float azimuth, float elevation, float spacing, uint16_t numPix) {
+  float az, el, dx, dy, dz;
+
+  az = (azimuth / 360.0) * TWO_PI;
+  el = (elevation / 360.0) * TWO_PI;
+  dx = cos(el) * cos(az) * spacing;
+  dy = cos(el) * sin(az) * spacing;
+  dz = sin(el) * spacing;
+  for (uint16_t p = 0; p < numPix; p++) {
+    if (!addPixel({startPos.x + (dx * p), startPos.y + (dy * p), startPos.z + (dz * p)}))
+      return (false);
+  }
+  return (true);
+}
+
+
+/* pixelMapClass::addGrid()
+    Appends a rectangular volume of equally-spaced pixels, with x varying fastest, then y, then z
+  Parameters:
+    coord3Struct origin: Coordinates of the first pixel (mm)
+    uint16_t nx, ny, nz: Number of pixels in each direction
+    float spacing: Distance between pixels (mm)
+  Returns:
+    bool: False if the map is full (pixels that fit are added)
+*/
+bool pixelMapClass::addGrid(coord3Struct origin, uint16_t nx, uint16_t ny, uint16_t nz, float spacing) {
+  for (uint16_t k = 0; k < nz; k++) {
+    for (uint16_t j = 0; j < ny; j++) {
+      for (uint16_t i = 0; i < nx; i++) {
+        if (!addPixel({origin.x + (spacing * i), origin.y + (spacing * j), origin.z + (spacing * k)}))
+          return (false);
+      }
+    }
+  }
+  return (true);
+}
+
+
+/* pixelMapClass::attach()
+    Uses a binary pixel map image in place (e.g. a const PROGMEM array generated by tools/pixmap_convert.py). The image must be
+    4-byte aligned and remain valid while attached; pixels can't be added to an attached map.
+  Parameters:
+    const void *image: Start of the image
+    uint32_t size: Size of the image (bytes)
+  Returns:
+    bool: False if the image header is invalid (the map is then empty)
+*/
+bool pixelMapClass::attach(const void *image, uint32_t size) {
+  const pixmapHeaderStruct *hdr;
+  uint32_t arraySize;
+
+  freeArrays();
+  hdr = (const pixmapHeaderStruct *) image;
+  if ((image == NULL) || (((uintptr_t) image & 3) != 0) || (size < sizeof(pixmapHeaderStruct)))
+    return (false);
+  if ((hdr->magic != pixmapMagic) || (hdr->version != pixmapVersion) || (hdr->imageSize > size) || (hdr->numPixels > 65535))
+    return (false);
+  if (((hdr->dims != 2) && (hdr->dims != 3)) || ((hdr->dims == 2) && (hdr->zOffset != 0)))
+    return (false);
+  arraySize = hdr->numPixels * sizeof(float);   // numPixels <= 65535, so this can't overflow
+  if (((hdr->xOffset | hdr->yOffset | hdr->zOffset) & 3) != 0)
+    return (false);
+    // each array must fit within the image; compared as (arraySize > imageSize - offset) so that a huge offset can't wrap around
+  if ((hdr->xOffset > hdr->imageSize) || (arraySize > (hdr->imageSize - hdr->xOffset)) ||
+      (hdr->yOffset > hdr->imageSize) || (arraySize > (hdr->imageSize - hdr->yOffset)) ||
+      ((hdr->dims == 3) && ((hdr->zOffset > hdr->imageSize) || (arraySize > (hdr->imageSize - hdr->zOffset)))))
+    return (false);
+  xCoord = (const float *) ((const uint8_t *) image + hdr->xOffset);
+  yCoord = (const float *) ((const uint8_t *) image + hdr->yOffset);
+  zCoord = (hdr->dims == 3) ? (const float *) ((const uint8_t *) image + hdr->zOffset) : NULL;
+  numPixels = (uint16_t) hdr->numPixels;
+  return (true);
+}
+
+
+#ifdef EFFECT_HOST_MMAP
+/* pixelMapClass::load()
+    Host builds only: memory-maps a binary pixel map file (read-only) and attaches it. The mapping is released by a subsequent
+    init(), attach() or load().
+  Parameters:
+    const char *path: Path of the image file
+  Returns:
+    bool: False if the file can't be mapped or isn't a valid image
+*/
+bool pixelMapClass::load(const char *path) {
+  fileMapClass file;
+
+  freeArrays();
+  if (!file.map(path, sizeof(pixmapHeaderStruct)) || !attach(file.data(), file.length()))
+    return (false);   // file is unmapped when it goes out of scope
+  mapping.adopt(file);  // adopted after attach(), which releases any previous mapping
+  return (true);
+}
+#endif  // EFFECT_HOST_MMAP
@@ -0,0 +1,264 @@
+/* PIXELMASK.CPP
+    This module defines the pixelMaskClass, which restricts rendering to a region of an installation (e.g. one zone of a facade).
+    The mask is held as a bitset (one bit per pixel), built from pixel ranges, stripMgrClass segments, or a predicate on the pixel
+    coordinates. For rendering, the set pixels are converted to a list of runs of consecutive pixels, which is rebuilt only when the
+    mask changes.
+
+    The batch render() functions of the effects (flowClass, waveClass, popClass, wipeClass, laserClass, shapeEffectClass) have masked
+    overloads that render each run in turn, so masked-out pixels are skipped entirely (neither computed nor written); the caller's
+    output array keeps its previous values for those pixels. Custom renderers can iterate over runs() in the same way:
+      for (uint32_t r = 0; r < mask.runCount(); r++)
+        render(out, ..., mask.runs()[r].first, mask.runs()[r].count);
+*/
+#include <Arduino.h>
+#include "PixelMask.h"
+#include "StripMgr.h"
+
+
+/* pixelMaskClass::init()
+    Allocates the mask (with no pixels set)
+  Parameters:
+    uint32_t numPix: Number of pixels in the installation
+  Returns:
+    bool: False if memory allocation failed
+*/
+bool pixelMaskClass::init(uint32_t numPix) {
+  delete [] bits;
+  delete [] run;
+  run = NULL;
+  maxRuns = 0;
+  numPixels = 0;
+  bits = new uint32_t [(numPix + 31) / 32];
+  if (bits == NULL)
+    return (false);
+  numPixels = numPix;
+  clear();
+  return (true);
+}
+
+
+/* pixelMaskClass::clear()
+    Clears all pixels from the mask
+  Parameters: None
+  Returns: None
+*/
+void pixelMaskClass::clear() {
+  if (bits != NULL)
+    memset(bits, 0, ((numPixels + 31) / 32) * sizeof(uint32_t));
+  runsValid = false;
+}
+
+
+/* pixelMaskClass::setAll()
+    Adds all pixels to the mask
+  Parameters: None
+  Returns: None
+*/
+void pixelMaskClass::setAll() {
+  addRange(0, numPixels);
+}
+
+
+/* pixelMaskClass::invert()
+    Inverts the mask (e.g. to render everything except a region)
+  Parameters: None
+  Returns: None
+*/
+void pixelMaskClass::invert() {
+  uint32_t numWords;
+
+  numWords = (numPixels + 31) / 32;
+  for (uint32_t w = 0; w < numWords; w++)
+    bits[w] = ~bits[w];
+  if ((numPixels & 31) != 0)  // clear the unused bits of the last word
+    bits[numWords - 1] &= (1UL << (numPixels & 31)) - 1;
+  runsValid = false;
+}
+
+
+/* pixelMaskClass::addRange()
+    Adds a range of consecutive pixels to the mask
+  Parameters:
+    uint32_t first: First pixel
+    uint32_t count: Number of pixels
+  Returns: None
+*/
+void pixelMaskClass::addRange(uint32_t first, uint32_t count) {
+  uint32_t last;
+
+  if (first >= numPixels)
+    return;
+  last = min(first + count, numPixels);
+  for (uint32_t p = first; p < last; p++) {
+    if (((p & 31) == 0) && ((p + 32) <= last)) {  // whole word
+      bits[p >> 5] = 0xFFFFFFFF;
+      p += 31;
+    }
+    else
+      bits[p >> 5] |= 1UL << (p & 31);
+  }
+  runsValid = false;
+}
+
+
+/* pixelMaskClass::removeRange()
+    Removes a range of consecutive pixels from the mask
+  Parameters:
+    uint32_t first: First pixel
+    uint32_t count: Number of pixels
+  Returns: None
+*/
+void pixelMaskClass::removeRange(uint32_t first, uint32_t count) {
+  uint32_t last;
+
+  if (first >= numPixels)
+    return;
+  last = min(first + count, numPixels);
+  for (uint32_t p = first; p < last; p++) {
+    if (((p & 31) == 0) && ((p + 32) <= last)) {  // whole word
+      bits[p >> 5] = 0;
+      p += 31;
+    }
+    else
+      bits[p >> 5] &= ~(1UL << (p & 31));
+  }
+  runsValid = false;
+}
+
+
+/* pixelMaskClass::addSegments()
+    Adds the pixels of a range of strip segments to the mask, where the segments are defined as for stripMgrClass::define() and the
+    first pixel of segment 0 is pixel 0
+  Parameters:
+    const segmentDefStruct *segments: Array of segment definitions
+    uint8_t firstSeg: First segment to add
+    uint8_t lastSeg: Last segment to add (inclusive)
+  Returns: None
+*/
+void pixelMaskClass::addSegments(const segmentDefStruct *segments, uint8_t firstSeg, uint8_t lastSeg) {
+  uint32_t first = 0;
+
+  for (uint8_t s = 0; s <= lastSeg; s++) {
+    if (s >= firstSeg)
+      addRange(first, segments[s].numPixels);
+    first += segments[s].numPixels;
+  }
+}
+
+
+/* pixelMaskClass::addWhere()
+    Adds the pixels whose coordinates satisfy a predicate (e.g. inside a zone of a 2D pixel map)
+  Parameters:
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    bool (*inside)(float x, float y, void *arg): Predicate; returns true if the pixel is in the region
+    void *arg: Argument passed to the predicate
+  Returns: None
+*/
+void pixelMaskClass::addWhere(const float *x, const float *y, bool (*inside)(float x, float y, void *arg), void *arg) {
+  for (uint32_t p = 0; p < numPixels; p++) {
+    if (inside(x[p], y[p], arg))
+      bits[p >> 5] |= 1UL << (p & 31);
+  }
+  runsValid = false;
+}
+
+
+/* pixelMaskClass::count()
+    Returns the number of pixels in the mask
+  Parameters: None
+  Returns:
+    uint32_t: Number of pixels set
+*/
+uint32_t pixelMaskClass::count() {
+  uint32_t total = 0;
+
+  for (uint32_t w = 0; w < ((numPixels + 31) / 32); w++)
+    total += __builtin_popcount(bits[w]);
+  return (total);
+}
+
+
+/* pixelMaskClass::buildRuns()
+    Rebuilds the list of runs from the bitset. The run array is reallocated if it is too small.
+  Parameters: None
+  Returns:
+    bool: False if memory allocation failed (the run list is then empty)
+*/
+bool pixelMaskClass::buildRuns() {
+  uint32_t word, needed;
+  bool inRun;
+
+  for (uint8_t pass = 0; pass < 2; pass++) {  // first pass counts the runs; second pass fills them in
+    numRuns = 0;
+    inRun = false;
+    for (uint32_t p = 0; p < numPixels; p++) {
+      word = bits[p >> 5];
+      if ((p & 31) == 0) {    // skip words that don't change the run state
+        if ((word == 0) && !inRun) {
+          p += 31;
+          continue;
+        }
+        if ((word == 0xFFFFFFFF) && inRun) {
+          if (pass == 1)
+            run[numRuns - 1].count += min((uint32_t) 32, numPixels - p);
+          p += 31;
+          continue;
+        }
+      }
+      if ((word & (1UL << (p & 31))) != 0) {
+        if (!inRun) {
+          if (pass == 1)
+            run[numRuns] = {p, 0};
+          numRuns++;
+          inRun = true;
+        }
+        if (pass == 1)
+          run[numRuns - 1].count++;
+      }
+      else
+        inRun = false;
+    }
+    if (pass == 0) {
+      needed = numRuns;
+      if (needed > maxRuns) {
+        delete [] run;
+        maxRuns = 0;
+        run = new pixelRunStruct [needed];
+        if (run == NULL) {
+          numRuns = 0;
+          return (false);
+        }
+        maxRuns = needed;
+      }
+    }
+  }
+  runsValid = true;
+  return (true);
+}
+
+
+/* pixelMaskClass::runCount()
+    Returns the number of runs of consecutive set pixels, rebuilding the run list if the mask has changed
+  Parameters: None
+  Returns:
+    uint32_t: Number of runs
+*/
+uint32_t pixelMaskClass::runCount() {
+  if (!runsValid)
+    buildRuns();
+  return (numRuns);
+}
+
+
+/* pixelMaskClass::runs()
+    Returns the list of runs of consecutive set pixels, rebuilding it if the mask has changed
+  Parameters: None
+  Returns:
+    const pixelRunStruct *: Array of runCount() runs, in increasing pixel order
+*/
+const pixelRunStruct *pixelMaskClass::runs() {
+  if (!runsValid)
+    buildRuns();
+  return (run);
+}
@@ -1,6 +1,7 @@
 #include "Arduino.h"
 #include "EffectUtils.h"
 #include "Pop.h"
+#include "Trace.h"
 
 
 void popClass::start(float duration, coordStruct pos, float distance, float rampLen) {
@@ -10,10 +11,13 @@ void popClass::start(float duration, coordStruct pos, float distance, float ramp
   rampWidth = constrain(rampLen, 1, distance);    // ramp width must be > 0 and <= distance
   center.x = pos.x;
   center.y = pos.y;
+  centerZ = 0;
   radius = 0;
   completedFlag = false;
+  lastActive = false;   // report the full span as changed after a (re)start
   stepNum = 0;
   active = true;
+  prepareFrame();
 }
 
 void popClass::start(float duration, coordStruct pos, float distance, float rampLen, float accel0, float distFrac0, float accel1) {
@@ -21,6 +25,7 @@ void popClass::start(float duration, coordStruct pos, float distance, float ramp
   rampWidth = constrain(rampLen, 1, distance);    // ramp width must be > 0 and <= distance
   center.x = pos.x;
   center.y = pos.y;
+  centerZ = 0;
   a0 = accel0;
   a1 = accel1;
   t0 = (uint16_t) round(sqrt((2 * distance * distFrac0) / a0));
@@ -32,15 +37,23 @@ void popClass::start(float duration, coordStruct pos, float distance, float ramp
   v2 = (distance - d0 - d1) / (float) (effectSteps - t0 - t1);
   radius = 0;
   completedFlag = false;
+  lastActive = false;   // report the full span as changed after a (re)start
   phase = 0;
   phaseStep = 0;
   stepNum = 0;
   linear = false;
   active = true;
+  prepareFrame();
   // Serial.printf("Pop: dist=%4.2f t0=%i d0=%4.2f t1=%i d1=%4.2f, v2=%3.2f\n", distance, t0, d0, t1, d1, v2);
 }
 
 
+void popClass::startSphere(float duration, coord3Struct pos, float distance, float rampLen) {
+  start(duration, {pos.x, pos.y}, distance, rampLen);
+  centerZ = pos.z;  // the 3D functions render a sphere; the 2D functions ignore centerZ
+}
+
+
 void popClass::step() {
 
   if (active) {
@@ -76,10 +89,16 @@ void popClass::step() {
       completedFlag = true;
       active = false;
     }
+    prepareFrame();
   }
 }
 
 
+void popClass::prepareFrame() {
+  invRampWidth = 1.0 / rampWidth;
+}
+
+
 float popClass::value(coordStruct pos) {
   float distFromRadius;
 
@@ -93,7 +112,7 @@ float popClass::value(coordStruct pos) {
     if (distFromRadius > rampWidth)   // back end of ramp has already crossed the point
       return (1.0f);
     else  // point is in between radius and back of ramp
-      return (distFromRadius / rampWidth);    // return linear ramp value (0 - 1)
+      return (distFromRadius * invRampWidth);    // return linear ramp value (0 - 1)
   }
 }
 
@@ -109,4 +128,155 @@ bool popClass::completed() {
   retVal = completedFlag;
   completedFlag = false;
   return retVal;
-}
\ No newline at end of file
+}
+
+
+/* popClass::changed()
+    Reports the span where value() may have changed since the previous call (see effect::changed()). The span is expressed as a
+    distance (mm) from the pop center: only the ramp annulus (plus the growth of the radius in the last step) changes.
+  Parameters:
+    float *spanStart: Set to the inner radius of the changed annulus (mm)
+    float *spanEnd: Set to the outer radius of the changed annulus (mm)
+  Returns:
+    spanKindEnum: SPAN_RADIAL, or the result of effect::changed() (entire span or SPAN_NONE) when the pop starts or ends
+*/
+spanKindEnum popClass::changed(float *spanStart, float *spanEnd) {
+  spanKindEnum retVal;
+
+  if (active && lastActive) {
+    *spanStart = max(lastRadius - rampWidth, 0);
+    *spanEnd = radius;
+    retVal = SPAN_RADIAL;
+  }
+  else
+    retVal = effect::changed(spanStart, spanEnd);
+  lastRadius = radius;
+  return (retVal);
+}
+
+
+/* popClass::render()
+    Batch version of value() for a range of pixels, with pixel coordinates supplied as separate x and y arrays. Only reads the pop
+    state, so disjoint pixel ranges may be rendered concurrently (e.g. by spanPoolClass).
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void popClass::render(float *out, const float *x, const float *y, uint32_t first, uint32_t count) {
+  float dx, dy;
+  float distInside;   // distance inside the pop radius (negative if outside)
+
+  if (!active) {
+    memset(&out[first], 0, count * sizeof(float));
+    return;
+  }
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  for (uint32_t p = first; p < (first + count); p++) {
+    dx = x[p] - center.x;
+    dy = y[p] - center.y;
+    distInside = radius - sqrtf((dx * dx) + (dy * dy));
+    if (distInside <= 0)    // pop radius hasn't yet crossed the point
+      out[p] = 0.0f;
+    else if (distInside > rampWidth)  // back end of ramp has already crossed the point
+      out[p] = 1.0f;
+    else
+      out[p] = distInside * invRampWidth;
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+/* popClass::render() [Overload]
+    Renders only the pixels covered by the pop, using a spatial index (see PixelGrid.cpp) to find the pixels within the current
+    radius. Pixels outside the radius are not modified, so the output array should be cleared by the caller before rendering (or
+    just the pixels set in the previous frame, since the pop only grows). The pixel coordinates are those used to build the grid.
+  Parameters:
+    float *out: Output array, indexed by pixel number
+    pixelGridClass &grid: Spatial index over the pixel coordinates
+  Returns:
+    uint16_t: Number of pixels set
+*/
+uint16_t popClass::render(float *out, pixelGridClass &grid) {
+  const uint16_t *pix;
+  uint16_t numPix;
+  float dx, dy;
+  float distInside;
+
+  if (!active)
+    return (0);
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  numPix = grid.queryDisc(center.x, center.y, radius);
+  pix = grid.results();
+  for (uint16_t i = 0; i < numPix; i++) {
+    dx = grid.x(pix[i]) - center.x;
+    dy = grid.y(pix[i]) - center.y;
+    distInside = radius - sqrtf((dx * dx) + (dy * dy));
+    out[pix[i]] = (distInside > rampWidth) ? 1.0f : (distInside * invRampWidth);
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+  return (numPix);
+}
+
+
+float popClass::value3D(coord3Struct pos) {
+  float dx, dy, dz, distInside;
+
+  if (!active)
+    return (0.0f);
+  dx = pos.x - center.x;
+  dy = pos.y - center.y;
+  dz = pos.z - centerZ;
+  distInside = radius - sqrtf((dx * dx) + (dy * dy) + (dz * dz));
+  if (distInside <= 0)
+    return (0.0f);
+  return ((distInside > rampWidth) ? 1.0f : (distInside * invRampWidth));
+}
+
+
+/* popClass::render() [Overload]
+    3D version of render(), with pixel coordinates supplied as separate x, y and z arrays; the pop is a sphere centered at
+    (center.x, center.y, centerZ)
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    const float *z: Array of pixel z coordinates (mm)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void popClass::render(float *out, const float *x, const float *y, const float *z, uint32_t first, uint32_t count) {
+  float dx, dy, dz, v;
+
+  if (!active) {
+    memset(&out[first], 0, count * sizeof(float));
+    return;
+  }
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  for (uint32_t p = first; p < (first + count); p++) {
+    dx = x[p] - center.x;
+    dy = y[p] - center.y;
+    dz = z[p] - centerZ;
+    v = (radius - sqrtf((dx * dx) + (dy * dy) + (dz * dz))) * invRampWidth;  // distance inside radius, in ramp widths
+    out[p] = (v < 0) ? 0.0f : ((v > 1) ? 1.0f : v);
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+
+/* popClass::render() [Overload]
+    Masked version of render(): renders only the pixels in a mask, one run at a time (see PixelMask.cpp). Pixels outside the mask
+    are neither computed nor written.
+  Parameters:
+    float *out: Output array, indexed by pixel number
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    pixelMaskClass &mask: Pixels to render
+  Returns: None
+*/
+void popClass::render(float *out, const float *x, const float *y, pixelMaskClass &mask) {
+  mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, x, y, first, count); });
+}
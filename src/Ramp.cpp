@@ -46,34 +46,20 @@ void rampClass::setRamp(float rampDur) {
   Returns: None
 */
 void rampClass::start(float duration, float rampUpDur, float rampDownDur) {
-  float rampTime;    // potentially-constrained ramp time for this start instance
+  rampStepsStruct steps;
 
   setRamp(rampUpDur, rampDownDur);    // set new values for rampClass::rampUpTime and rampClass::rampDownTime
-  if (duration == 0) {  // if ramp has infinite duration
-    rampUpSteps = ComputeSteps(rampUpTime);  // number of steps in ramp-up
-    holdSteps = 0;  // hold phase has infinite duration after ramp up
-  }
-  else {  // finite duration ramp
-    if (duration < (rampUpTime + rampDownTime)) {   // if duration is to short to accommodate full ramp-up/down
-        // compute time at intersection of up and down ramps, constrained by total duration
-      rampTime = ((-1/rampDownTime) * duration) / ((-1/rampDownTime) - (1/rampUpTime));
-      rampUpSteps = ComputeSteps(rampTime);   // truncated ramp-up duration (steps)
-      rampDownSteps = ComputeSteps(duration - rampTime);  // remaining time used for down ramp
-      holdSteps = 1;  // bare-minimum hold phase, to avoid step() implementing infinite hold (holdSteps == 0)
-    }
-    else {  // duration is long enough to accommodate full ramp up/down
-      rampUpSteps = ComputeSteps(rampUpTime);
-      rampDownSteps = ComputeSteps(rampDownTime);
-      holdSteps = max(ComputeSteps(duration - rampUpTime - rampDownTime), 1);   // ensure at least 1 hold step
-    }
-  }
+  steps = ComputeRampSteps(duration, rampUpTime, rampDownTime);   // phase durations, truncated if duration is too short
+  rampUpSteps = steps.upSteps;
+  holdSteps = steps.holdSteps;
+  rampDownSteps = steps.downSteps;
   if (rampUpSteps == 0) {   // if no ramp-up phase
     rampDelta = 0;
     val = 1.0;      // set val to max value
     phase = hold;   // go directly to hold phase
   }
   else {    // prepare to start ramp-up
-    rampDelta = 1.0 / (float) ComputeSteps(rampUpTime); // compute slope based on non-truncated duration
+    rampDelta = steps.upDelta;  // slope based on non-truncated duration
     phase = rampUp;
     val = 0;  // ramp function initial value at start of rampUp
   }
@@ -152,3 +138,22 @@ void rampClass::step() {
     }
   }
 }
+
+
+/* rampClass::changed()
+    Reports whether val has changed since the previous call (see effect::changed()). The ramp value is position-independent, so the
+    span is always the entire span; nothing is reported during the hold phase.
+  Parameters:
+    float *spanStart: Set to the start of the changed span
+    float *spanEnd: Set to the end of the changed span
+  Returns:
+    spanKindEnum: SPAN_LINEAR (entire span) if val changed, otherwise SPAN_NONE
+*/
+spanKindEnum rampClass::changed(float *spanStart, float *spanEnd) {
+  bool retVal;
+
+  effect::changed(spanStart, spanEnd);  // sets full span
+  retVal = (val != lastVal);
+  lastVal = val;
+  return (retVal ? SPAN_LINEAR : SPAN_NONE);
+}
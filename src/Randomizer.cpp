@@ -38,13 +38,13 @@ void randomizerClass::randomize() {
   if (pixType != NULL) {  // make sure memory allocation was successful
     for (uint16_t p = 0; p < numPixels; p++) {  // for each pixel in the allocated array
       if (type0Prob == 0) {             // if type 0 probability has not been specified
-        pixType[p] = random(numTypes);  // randomy assign type, with equal probability for all type values
+        pixType[p] = ctx->random(numTypes);  // randomy assign type, with equal probability for all type values
       }
       else {    // type 0 probability was specified
-        if (random(100) < (uint32_t) (type0Prob * 100)) // use probability to determine if this pixel is type 0
+        if (ctx->random(100) < (uint32_t) (type0Prob * 100)) // use probability to determine if this pixel is type 0
           pixType[p] = 0;
         else {  // type 0 was not assigned to this pixel
-          pixType[p] = random(1, numTypes); // randomly pick type from remaining values (> 0)
+          pixType[p] = ctx->random(1, numTypes); // randomly pick type from remaining values (> 0)
         }
       }
     }
@@ -0,0 +1,63 @@
+/* RENDERCONTEXT.CPP
+    This module defines the renderContextClass, which holds the state that was previously shared by all effects in the program: the
+    step period, the random number stream, and a step clock. Every effect is bound to a context (defaultContext unless bindContext()
+    is called), and reads its step period and random numbers from that context only. Two installations running at different frame
+    rates can therefore share one program, and host simulations that each use their own context (and their own effects) share no
+    mutable state and can run concurrently on separate threads.
+
+    For compatibility with existing sketches, a context initially draws from the global Arduino random() stream, so randomSeed()
+    still determines the sequence seen by effects bound to defaultContext. Calling seed() with a non-zero value switches the context
+    to its own private stream; contexts used on separate threads must be seeded.
+
+    The step clock counts the frames output since the clock was reset. It is reset by framePipeClass::init() and advanced by each
+    framePipeClass::submit() (see FramePipe.cpp) for the context passed to the pipe.
+*/
+#include <Arduino.h>
+#include "RenderContext.h"
+
+renderContextClass defaultContext;
+
+
+/* renderContextClass::seed()
+    Seeds the private random number stream of this context
+  Parameters:
+    uint32_t rndSeed: Seed value; 0 returns the context to the global Arduino random() stream
+  Returns: None
+*/
+void renderContextClass::seed(uint32_t rndSeed) {
+  rngState = rndSeed;
+}
+
+
+/* renderContextClass::random()
+    Returns a random number from the context's stream, equivalent to the Arduino random(howBig) function
+  Parameters:
+    uint32_t howBig: Upper bound (exclusive)
+  Returns:
+    uint32_t: Random number in the range 0 to (howBig - 1), or 0 if (howBig == 0)
+*/
+uint32_t renderContextClass::random(uint32_t howBig) {
+  if (howBig == 0)
+    return (0);
+  if (rngState == 0)    // if not seeded, use the global stream
+    return (::random(howBig));
+  rngState ^= rngState << 13;   // xorshift32
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (rngState % howBig);
+}
+
+
+/* renderContextClass::random() [Overload]
+    Returns a random number from the context's stream, equivalent to the Arduino random(howSmall, howBig) function
+  Parameters:
+    int32_t howSmall: Lower bound (inclusive)
+    int32_t howBig: Upper bound (exclusive)
+  Returns:
+    int32_t: Random number in the range howSmall to (howBig - 1), or howSmall if (howSmall >= howBig)
+*/
+int32_t renderContextClass::random(int32_t howSmall, int32_t howBig) {
+  if (howSmall >= howBig)
+    return (howSmall);
+  return (howSmall + (int32_t) random((uint32_t) (howBig - howSmall)));
+}
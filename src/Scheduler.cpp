@@ -0,0 +1,194 @@
+/* SCHEDULER.CPP
+    This module defines the schedulerClass, which replaces per-frame polling of completed() in show logic. Two services are provided:
+
+    1. Cues: a callback function (typically one that calls start() on an effect) is scheduled to be called at a specified step number,
+       or after a specified delay. Pending cues are held in a two-level timing wheel, so scheduling and firing a cue is O(1) and
+       pending cues cost nothing while they wait. The inner wheel has one slot per step; the outer wheel has one slot per
+       schedWheelSize steps, and its slots are moved ("cascaded") into the inner wheel as they come due. Cues more than
+       schedWheelSize^2 steps in the future simply stay in the outer wheel for additional revolutions.
+
+    2. Step set: a started effect is added with run(), and is then stepped by the scheduler every step. When the effect becomes
+       inactive, its completion callback (if any) is called and it is removed from the step set automatically.
+
+    schedulerClass::step() is called once per step period (frame), in place of calling step() on each running effect.
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Scheduler.h"
+#include "Trace.h"
+
+
+/* schedulerClass::init()
+    Clears all pending cues and the step set, and resets the step count to 0
+  Parameters: None
+  Returns: None
+*/
+void schedulerClass::init() {
+  for (uint16_t c = 0; c < schedMaxCues; c++)   // link all cues into the free list
+    cue[c].next = (c < (schedMaxCues - 1)) ? (c + 1) : schedNoCue;
+  freeCue = 0;
+  for (uint16_t s = 0; s < schedWheelSize; s++) {
+    wheel0[s] = schedNoCue;
+    wheel1[s] = schedNoCue;
+  }
+  numRunning = 0;
+  curStep = 0;
+  openStep = 0;
+}
+
+
+/* schedulerClass::insert()
+    Inserts a cue into the appropriate wheel slot based on its trigger step
+  Parameters:
+    uint16_t c: Index of cue
+  Returns: None
+*/
+void schedulerClass::insert(uint16_t c) {
+  uint16_t slot;
+
+  if ((cue[c].trigger - curStep) < schedWheelSize) {   // if due within one revolution of the inner wheel
+    slot = cue[c].trigger & (schedWheelSize - 1);
+    cue[c].next = wheel0[slot];
+    wheel0[slot] = c;
+  }
+  else {
+    slot = (cue[c].trigger >> schedWheelBits) & (schedWheelSize - 1);
+    cue[c].next = wheel1[slot];
+    wheel1[slot] = c;
+  }
+}
+
+
+/* schedulerClass::at()
+    Schedules a cue to be fired at a specified step number. A step number whose cues have already been fired fires at the earliest
+    step that hasn't: during the current call to step() if at() is called from a cue function, and otherwise on the next call to
+    step() (e.g. at(stepCount()) from a completion function, which is called after the cues of the current step).
+  Parameters:
+    uint32_t step: Step number (see stepCount()) at which func is called
+    cueFuncPtr func: Function to be called
+    void *arg: Argument passed to func
+  Returns:
+    bool: False if no free cues are available
+*/
+bool schedulerClass::at(uint32_t step, cueFuncPtr func, void *arg) {
+  uint16_t c;
+
+  if ((freeCue == schedNoCue) || (func == NULL))
+    return (false);
+  c = freeCue;
+  freeCue = cue[c].next;
+  cue[c].trigger = ((int32_t) (step - openStep) < 0) ? openStep : step;
+  cue[c].func = func;
+  cue[c].arg = arg;
+  insert(c);
+  return (true);
+}
+
+
+/* schedulerClass::after()
+    Schedules a cue to be fired after a specified delay
+  Parameters:
+    float delay: Delay (seconds) from the current step
+    cueFuncPtr func: Function to be called
+    void *arg: Argument passed to func
+  Returns:
+    bool: False if no free cues are available
+*/
+bool schedulerClass::after(float delay, cueFuncPtr func, void *arg) {
+  return (at(curStep + (uint32_t) ceil(max(delay, 0) / ctx->stepPeriod), func, arg));
+}
+
+
+/* schedulerClass::run()
+    Adds a started effect to the step set. The effect is stepped by schedulerClass::step() until it becomes inactive; doneFunc is
+    then called and the effect is removed from the step set.
+  Parameters:
+    effect *fx: Pointer to the effect (already started)
+    cueFuncPtr doneFunc: Function called when the effect completes (may be NULL)
+    void *doneArg: Argument passed to doneFunc
+  Returns:
+    bool: False if the step set is full
+*/
+bool schedulerClass::run(effect *fx, cueFuncPtr doneFunc, void *doneArg) {
+  if (numRunning >= schedMaxRunning)
+    return (false);
+  running[numRunning].fx = fx;
+  running[numRunning].doneFunc = doneFunc;
+  running[numRunning].doneArg = doneArg;
+  numRunning++;
+  return (true);
+}
+
+
+/* schedulerClass::remove()
+    Removes an effect from the step set without calling its completion function (e.g. to stop an infinite-duration effect)
+  Parameters:
+    effect *fx: Pointer to the effect
+  Returns:
+    bool: True if the effect was in the step set
+*/
+bool schedulerClass::remove(effect *fx) {
+  for (uint8_t r = 0; r < numRunning; r++) {
+    if (running[r].fx == fx) {
+      running[r] = running[--numRunning];   // move last entry into this position
+      return (true);
+    }
+  }
+  return (false);
+}
+
+
+/* schedulerClass::step()
+    Called once per step period (frame). Fires the cues due at the current step, then steps each effect in the step set and calls the
+    completion function of any effect that has become inactive.
+  Parameters: None
+  Returns: None
+*/
+void schedulerClass::step() {
+  uint16_t c, next;
+  uint16_t slot;
+  uint8_t r;
+  runningStruct done;
+
+  if ((curStep & (schedWheelSize - 1)) == 0) {  // if start of a new inner wheel revolution
+    slot = (curStep >> schedWheelBits) & (schedWheelSize - 1);
+    c = wheel1[slot];   // cascade the outer wheel slot into the inner wheel
+    wheel1[slot] = schedNoCue;
+    while (c != schedNoCue) {
+      next = cue[c].next;
+      insert(c);
+      c = next;
+    }
+  }
+  slot = curStep & (schedWheelSize - 1);
+  while (wheel0[slot] != schedNoCue) {  // repeat if a fired cue schedules another cue for the current step
+    c = wheel0[slot];   // detach the current slot, so that cues fired here may schedule new cues
+    wheel0[slot] = schedNoCue;
+    while (c != schedNoCue) {
+      next = cue[c].next;
+      cue[c].next = freeCue;  // return cue to free list before calling func, so that func can re-use it
+      freeCue = c;
+      TRACE_BEGIN(TRACE_START, traceLibId);
+      cue[c].func(cue[c].arg);
+      TRACE_END(TRACE_START, traceLibId);
+      c = next;
+    }
+  }
+  openStep = curStep + 1;   // the current slot has been fired; cues for this step scheduled from here on fire on the next step
+  r = 0;
+  while (r < numRunning) {
+    TRACE_BEGIN(TRACE_STEP, traceLibId);
+    running[r].fx->step();
+    TRACE_END(TRACE_STEP, traceLibId);
+    if (!running[r].fx->active) {   // if effect has completed
+      done = running[r];
+      running[r] = running[--numRunning];   // remove from step set (don't increment r; re-check moved entry)
+      if (done.doneFunc != NULL)
+        done.doneFunc(done.doneArg);
+    }
+    else
+      r++;
+  }
+  curStep++;
+  openStep = curStep;
+}
@@ -0,0 +1,303 @@
+/* SCRIPT.CPP
+    This module defines a C++20 coroutine layer for sequencing effects, so that a show can be written as a straight-line script
+    instead of a hand-written state machine that polls completed() every frame. For example:
+
+      scriptClass myShow(scriptRunnerClass &run) {
+        flow.start(2.0, 1000, 100);
+        co_await run.untilDone(flow);
+        co_await run.waitFor(1.5);
+        popA.start(1.0, posA, 500, 50);
+        popB.start(1.0, posB, 500, 50);
+        co_await run.allDone(popA, popB);
+      }
+      ...
+      scripts.init(&scheduler);
+      scripts.start(myShow(scripts));
+
+    Awaited effects are added to the step set of a schedulerClass (see Scheduler.cpp), which steps them (so they must not also be
+    stepped elsewhere) and resumes the script only on the step where the awaited effect completes, or where the waitFor() delay
+    expires. A blocked script therefore costs nothing per frame. If the step set is full, the awaiter retries on each following step
+    (the effect isn't stepped meanwhile). untilDone() and allDone() return true when the effects have completed, or false if they could
+    not be waited for because no scheduler cues were free either; in that case the script resumes immediately and none of the effects
+    are left in the step set, e.g. if (!co_await run.untilDone(flow)) ... Coroutine frames are allocated from a fixed pool rather than the
+    heap; if the pool is exhausted or a script's frame is larger than scriptFrameSize, start() returns false.
+
+    This module requires C++20 coroutine support (e.g. build_flags = -std=gnu++20 -fcoroutines), and is empty otherwise.
+*/
+#include <Arduino.h>
+#include "Script.h"
+
+#ifdef EFFECT_SCRIPTS
+
+static uint32_t framePool[scriptPoolSize][scriptFrameSize / sizeof(uint32_t)];  // coroutine frame pool (word-aligned)
+static uint16_t freeFrame[scriptPoolSize];  // stack of free frame indexes
+static uint16_t numFree = 0;
+static bool poolReady = false;
+
+
+/* scriptClass::promise_type::operator new()
+    Allocates a coroutine frame from the fixed pool
+  Parameters:
+    size_t size: Size of the coroutine frame (bytes)
+  Returns:
+    void *: Pointer to the frame, or NULL if the pool is exhausted or the frame is too large
+*/
+void *scriptClass::promise_type::operator new(size_t size) noexcept {
+  if (!poolReady) {   // first allocation: all frames are free
+    for (uint16_t f = 0; f < scriptPoolSize; f++)
+      freeFrame[f] = f;
+    numFree = scriptPoolSize;
+    poolReady = true;
+  }
+  if ((size > scriptFrameSize) || (numFree == 0))
+    return (NULL);
+  return (framePool[freeFrame[--numFree]]);
+}
+
+
+/* scriptClass::promise_type::operator delete()
+    Returns a coroutine frame to the fixed pool
+  Parameters:
+    void *ptr: Pointer to the frame
+  Returns: None
+*/
+void scriptClass::promise_type::operator delete(void *ptr) {
+  if (ptr != NULL)
+    freeFrame[numFree++] = ((uint32_t (*)[scriptFrameSize / sizeof(uint32_t)]) ptr) - framePool;
+}
+
+
+/* scriptAwaitBase::resume()
+    Scheduler callback that resumes a suspended script, and releases its frame if the script has finished
+  Parameters:
+    void *arg: Coroutine handle address
+  Returns: None
+*/
+void scriptAwaitBase::resume(void *arg) {
+  std::coroutine_handle<> h;
+
+  h = std::coroutine_handle<>::from_address(arg);
+  h.resume();
+  if (h.done())
+    h.destroy();
+}
+
+
+/* untilDoneAwaiter::await_suspend()
+    Suspends the script until the awaited effect completes
+  Parameters:
+    std::coroutine_handle<> h: Handle of the suspended script
+  Returns:
+    bool: False (don't suspend; co_await returns false) if the effect can't be added to the step set and no retry can be scheduled
+*/
+bool untilDoneAwaiter::await_suspend(std::coroutine_handle<> h) {
+  handle = h;
+  if (sched->run(fx, resume, h.address()))
+    return (true);
+  if (sched->at(sched->stepCount() + 1, retry, this))   // step set is full: try again on the next step
+    return (true);
+  ok = false;
+  return (false);
+}
+
+
+/* untilDoneAwaiter::retry()
+    Scheduler cue that retries adding the awaited effect to the step set, one step after it was found to be full
+  Parameters:
+    void *arg: Pointer to the untilDoneAwaiter
+  Returns: None
+*/
+void untilDoneAwaiter::retry(void *arg) {
+  untilDoneAwaiter *aw;
+
+  aw = (untilDoneAwaiter *) arg;
+  if (!aw->fx->active)    // stopped elsewhere while waiting
+    resume(aw->handle.address());
+  else if (!aw->sched->run(aw->fx, resume, aw->handle.address())) {
+    if (!aw->sched->at(aw->sched->stepCount() + 1, retry, aw)) {  // still full: try again on the next step
+      aw->ok = false;
+      resume(aw->handle.address());
+    }
+  }
+}
+
+
+/* waitForAwaiter::await_suspend()
+    Suspends the script until the delay has expired
+  Parameters:
+    std::coroutine_handle<> h: Handle of the suspended script
+  Returns:
+    bool: False (don't suspend; co_await returns false) if no free cue is available to resume the script
+*/
+bool waitForAwaiter::await_suspend(std::coroutine_handle<> h) {
+  handle = h;
+  if (sched->after(delay, resume, h.address()))
+    return (true);
+  ok = false;
+  return (false);
+}
+
+
+/* allDoneAwaiter::await_ready()
+    Returns true (no suspension) if none of the effects are active
+  Parameters: None
+  Returns:
+    bool: True if all of the effects have already completed
+*/
+bool allDoneAwaiter::await_ready() {
+  for (uint8_t n = 0; n < count; n++) {
+    if (fx[n]->active)
+      return (false);
+  }
+  return (true);
+}
+
+
+/* allDoneAwaiter::await_suspend()
+    Suspends the script until all of the active effects have completed
+  Parameters:
+    std::coroutine_handle<> h: Handle of the suspended script
+  Returns:
+    bool: False (don't suspend; co_await returns false) if the effects can't all be added to the step set and no retry can be
+      scheduled
+*/
+bool allDoneAwaiter::await_suspend(std::coroutine_handle<> h) {
+  handle = h;
+  ok = true;
+  remaining = 0;
+  waiting = 0;
+  for (uint8_t n = 0; n < count; n++) {
+    if (fx[n]->active) {
+      remaining++;
+      waiting |= (1 << n);
+    }
+  }
+  if (addWaiting())
+    return (true);
+  cancel();
+  ok = false;
+  return (false);
+}
+
+
+/* allDoneAwaiter::addWaiting()
+    Adds the waiting effects to the step set. If the step set is full, the rest are retried on the next step.
+  Parameters: None
+  Returns:
+    bool: False if effects are still waiting and the retry couldn't be scheduled
+*/
+bool allDoneAwaiter::addWaiting() {
+  for (uint8_t n = 0; n < count; n++) {
+    if (waiting & (1 << n)) {
+      if (!fx[n]->active) {   // stopped elsewhere while waiting
+        waiting &= ~(1 << n);
+        remaining--;
+      }
+      else if (sched->run(fx[n], done, this))
+        waiting &= ~(1 << n);
+    }
+  }
+  if (waiting == 0)
+    return (true);
+  return (sched->at(sched->stepCount() + 1, retry, this));
+}
+
+
+/* allDoneAwaiter::cancel()
+    Removes the effects that were added to the step set (and haven't completed), so that the awaiter can be released
+  Parameters: None
+  Returns: None
+*/
+void allDoneAwaiter::cancel() {
+  for (uint8_t n = 0; n < count; n++) {
+    if (!(waiting & (1 << n)) && fx[n]->active)
+      sched->remove(fx[n]);
+  }
+}
+
+
+/* allDoneAwaiter::retry()
+    Scheduler cue that retries adding the waiting effects to the step set, one step after it was found to be full
+  Parameters:
+    void *arg: Pointer to the allDoneAwaiter
+  Returns: None
+*/
+void allDoneAwaiter::retry(void *arg) {
+  allDoneAwaiter *aw;
+
+  aw = (allDoneAwaiter *) arg;
+  if (!aw->addWaiting()) {
+    aw->cancel();
+    aw->ok = false;
+  }
+  else if (aw->remaining > 0)   // still waiting for effects to be added or to complete
+    return;
+  resume(aw->handle.address());
+}
+
+
+/* allDoneAwaiter::done()
+    Scheduler completion callback for each of the awaited effects. Resumes the script when the last active one completes.
+  Parameters:
+    void *arg: Pointer to the allDoneAwaiter
+  Returns: None
+*/
+void allDoneAwaiter::done(void *arg) {
+  allDoneAwaiter *aw;
+
+  aw = (allDoneAwaiter *) arg;
+  if (--aw->remaining == 0)
+    resume(aw->handle.address());
+}
+
+
+/* scriptRunnerClass::start()
+    Starts a script. The script begins running on the next call to schedulerClass::step().
+  Parameters:
+    scriptClass script: Return value of a script coroutine, e.g. start(myShow(runner))
+  Returns:
+    bool: False if the script frame could not be allocated
+*/
+bool scriptRunnerClass::start(scriptClass script) {
+  if ((sched == NULL) || !script.handle)
+    return (false);
+  if (!sched->at(sched->stepCount(), scriptAwaitBase::resume, script.handle.address())) {
+    script.handle.destroy();
+    return (false);
+  }
+  return (true);
+}
+
+
+/* scriptRunnerClass::untilDone()
+    Returns an awaiter that suspends the script until a (started) effect completes, e.g. co_await run.untilDone(flow)
+  Parameters:
+    effect &fx: Effect to wait for. The effect is stepped by the scheduler while the script is suspended
+  Returns:
+    untilDoneAwaiter: Awaiter to be used with co_await
+*/
+untilDoneAwaiter scriptRunnerClass::untilDone(effect &fx) {
+  untilDoneAwaiter aw;
+
+  aw.sched = sched;
+  aw.fx = &fx;
+  return (aw);
+}
+
+
+/* scriptRunnerClass::waitFor()
+    Returns an awaiter that suspends the script for a specified time, e.g. co_await run.waitFor(1.5)
+  Parameters:
+    float seconds: Delay (seconds)
+  Returns:
+    waitForAwaiter: Awaiter to be used with co_await
+*/
+waitForAwaiter scriptRunnerClass::waitFor(float seconds) {
+  waitForAwaiter aw;
+
+  aw.sched = sched;
+  aw.delay = seconds;
+  return (aw);
+}
+
+#endif  // EFFECT_SCRIPTS
@@ -0,0 +1,430 @@
+/* SHAPE.CPP
+    This module defines the sdfShapeClass, a small library of 2-dimensional shapes described by signed distance functions (SDFs), and
+    the shapeEffectClass, which animates a shape by moving, rotating and scaling it. The signed distance of a point from a shape is
+    negative inside the shape, 0 on its edge and positive outside. popClass and wipeClass are special cases: a pop is a circle whose
+    radius grows, and a wipe is a line (half-plane) that moves perpendicular to itself.
+
+    A shape is built from up to shapeMaxParts primitives (circle, line, rectangle, ring, polygon), each combined with the result of
+    the parts before it by union (min distance), intersection (max distance) or subtraction. For example, a rectangular frame is a
+    rectangle with a smaller rectangle subtracted. The shape transform (position, rotation and scale factor) is applied by
+    transforming the pixel coordinates into the shape's local coordinates, so the parts themselves never change.
+
+    render() converts the signed distance to a ramped output in the same way as popClass and wipeClass:
+      value = 0 outside the shape
+      0 < value < 1 within rampWidth of the edge, inside the shape
+      value = 1 deeper than rampWidth inside the shape
+    Pixels are evaluated in blocks of shapeBlockSize, one part at a time, so that each primitive is a simple loop over the block
+    (without per-pixel branching on the part type) that the compiler can vectorize.
+*/
+#include <Arduino.h>
+#include "EffectUtils.h"
+#include "Shape.h"
+#include "Trace.h"
+
+
+/* sdfShapeClass::clear()
+    Removes all parts and resets the transform
+  Parameters: None
+  Returns: None
+*/
+void sdfShapeClass::clear() {
+  numParts = 0;
+  setTransform({0, 0}, 0, 1);
+}
+
+
+/* sdfShapeClass::addPart()
+    Adds a primitive to the shape
+  Parameters:
+    uint8_t type: shapeTypeEnum
+    uint8_t op: shapeOpEnum; ignored for the first part
+    float a, b, c, d: Primitive parameters (see shapePartStruct)
+  Returns:
+    bool: False if the shape already has shapeMaxParts parts
+*/
+bool sdfShapeClass::addPart(uint8_t type, uint8_t op, float a, float b, float c, float d) {
+  shapePartStruct *pt;
+
+  if (numParts >= shapeMaxParts)
+    return (false);
+  pt = &part[numParts++];
+  pt->type = type;
+  pt->op = op;
+  pt->a = a;
+  pt->b = b;
+  pt->c = c;
+  pt->d = d;
+  pt->points = NULL;
+  pt->numPoints = 0;
+  return (true);
+}
+
+
+/* sdfShapeClass::addCircle()
+    Adds a circle (disc) to the shape
+  Parameters:
+    coordStruct center: Center of the circle (mm, shape coordinates)
+    float radius: Radius (mm)
+    uint8_t op: How the circle is combined with the previous parts (shapeOpEnum)
+  Returns:
+    bool: False if the shape is full
+*/
+bool sdfShapeClass::addCircle(coordStruct center, float radius, uint8_t op) {
+  return (addPart(SHAPE_CIRCLE, op, center.x, center.y, radius, 0));
+}
+
+
+/* sdfShapeClass::addLine()
+    Adds a line to the shape. As with wipeClass, the inside of the shape is the half-plane behind the line, where the line moves
+    forward (perpendicular to the line) as the shape is moved.
+  Parameters:
+    coordStruct refPos: Coordinates of a point on the line (mm, shape coordinates)
+    float lineAngle: Angle of the line (degrees)
+    uint8_t op: How the line is combined with the previous parts (shapeOpEnum)
+  Returns:
+    bool: False if the shape is full
+*/
+bool sdfShapeClass::addLine(coordStruct refPos, float lineAngle, uint8_t op) {
+  movingLineClass line;
+  float coeffA, coeffB;
+
+  line.init(refPos, lineAngle);   // use the same line equation as wipeClass
+  coeffA = line.distance({1, 0}) - line.distance({0, 0});
+  coeffB = line.distance({0, 1}) - line.distance({0, 0});
+  return (addPart(SHAPE_LINE, op, coeffA, coeffB, line.distance({0, 0}), 0));
+}
+
+
+/* sdfShapeClass::addRect()
+    Adds an axis-aligned rectangle to the shape (use the shape transform to rotate it)
+  Parameters:
+    coordStruct center: Center of the rectangle (mm, shape coordinates)
+    float width, height: Size of the rectangle (mm)
+    uint8_t op: How the rectangle is combined with the previous parts (shapeOpEnum)
+  Returns:
+    bool: False if the shape is full
+*/
+bool sdfShapeClass::addRect(coordStruct center, float width, float height, uint8_t op) {
+  return (addPart(SHAPE_RECT, op, center.x, center.y, width / 2, height / 2));
+}
+
+
+/* sdfShapeClass::addRing()
+    Adds a ring (annulus) to the shape
+  Parameters:
+    coordStruct center: Center of the ring (mm, shape coordinates)
+    float radius: Radius of the center line of the ring (mm)
+    float thickness: Width of the ring (mm)
+    uint8_t op: How the ring is combined with the previous parts (shapeOpEnum)
+  Returns:
+    bool: False if the shape is full
+*/
+bool sdfShapeClass::addRing(coordStruct center, float radius, float thickness, uint8_t op) {
+  return (addPart(SHAPE_RING, op, center.x, center.y, radius, thickness / 2));
+}
+
+
+/* sdfShapeClass::addPolygon()
+    Adds a closed polygon to the shape. The vertex array is referenced (not copied), and must remain valid.
+  Parameters:
+    const coordStruct *points: Array of vertices (mm, shape coordinates), in either winding order
+    uint8_t numPoints: Number of vertices (at least 3)
+    uint8_t op: How the polygon is combined with the previous parts (shapeOpEnum)
+  Returns:
+    bool: False if the shape is full or there are too few vertices
+*/
+bool sdfShapeClass::addPolygon(const coordStruct *points, uint8_t numPoints, uint8_t op) {
+  if ((points == NULL) || (numPoints < 3) || !addPart(SHAPE_POLYGON, op, 0, 0, 0, 0))
+    return (false);
+  part[numParts - 1].points = points;
+  part[numParts - 1].numPoints = numPoints;
+  return (true);
+}
+
+
+/* sdfShapeClass::setTransform()
+    Sets the position, rotation and scale of the shape. Shape coordinates (x, y) map to global coordinates
+    pos + scaleFactor * (rotated x, y).
+  Parameters:
+    coordStruct pos: Global coordinates (mm) of the shape origin
+    float rotation: Rotation (degrees, counter-clockwise)
+    float scaleFactor: Scale factor (> 0)
+  Returns: None
+*/
+void sdfShapeClass::setTransform(coordStruct pos, float rotation, float scaleFactor) {
+  offset = pos;
+  angle = rotation;
+  scale = max(scaleFactor, 0.001);    // prevent divide by 0
+  cosA = cos((angle / 360.0) * TWO_PI);
+  sinA = sin((angle / 360.0) * TWO_PI);
+  invScale = 1.0 / scale;
+}
+
+
+/* sdfShapeClass::partDistance()
+    Computes the signed distance of a block of points (in shape coordinates) from one part
+  Parameters:
+    const shapePartStruct &pt: Part
+    const float *x, *y: Point coordinates (mm, shape coordinates)
+    float *dist: Output array of signed distances (mm, shape coordinates)
+    uint16_t count: Number of points
+  Returns: None
+*/
+void sdfShapeClass::partDistance(const shapePartStruct &pt, const float *x, const float *y, float *dist, uint16_t count) {
+  float dx, dy, qx, qy, ex, ey, wx, wy, bx, by, t, minSq, sign;
+  const coordStruct *vi, *vj;
+
+  switch (pt.type) {
+    case SHAPE_CIRCLE:
+      for (uint16_t i = 0; i < count; i++) {
+        dx = x[i] - pt.a;
+        dy = y[i] - pt.b;
+        dist[i] = sqrtf((dx * dx) + (dy * dy)) - pt.c;
+      }
+      break;
+    case SHAPE_LINE:
+      for (uint16_t i = 0; i < count; i++)
+        dist[i] = (pt.a * x[i]) + (pt.b * y[i]) + pt.c;
+      break;
+    case SHAPE_RECT:
+      for (uint16_t i = 0; i < count; i++) {
+        qx = fabsf(x[i] - pt.a) - pt.c;   // distance outside each pair of edges (negative if inside)
+        qy = fabsf(y[i] - pt.b) - pt.d;
+        dx = (qx > 0) ? qx : 0;
+        dy = (qy > 0) ? qy : 0;
+        t = (qx > qy) ? qx : qy;
+        dist[i] = sqrtf((dx * dx) + (dy * dy)) + ((t < 0) ? t : 0);
+      }
+      break;
+    case SHAPE_RING:
+      for (uint16_t i = 0; i < count; i++) {
+        dx = x[i] - pt.a;
+        dy = y[i] - pt.b;
+        dist[i] = fabsf(sqrtf((dx * dx) + (dy * dy)) - pt.c) - pt.d;
+      }
+      break;
+    case SHAPE_POLYGON:
+      for (uint16_t i = 0; i < count; i++) {
+        minSq = 3.4e38;
+        sign = 1;
+        for (uint8_t n = 0; n < pt.numPoints; n++) {
+          vi = &pt.points[n];
+          vj = &pt.points[(n == 0) ? (pt.numPoints - 1) : (n - 1)];
+          ex = vj->x - vi->x;   // edge vector
+          ey = vj->y - vi->y;
+          wx = x[i] - vi->x;
+          wy = y[i] - vi->y;
+          t = ((wx * ex) + (wy * ey)) / max((ex * ex) + (ey * ey), 1e-12);
+          t = constrain(t, 0, 1);
+          bx = wx - (ex * t);   // vector from nearest point on edge
+          by = wy - (ey * t);
+          minSq = min(minSq, (bx * bx) + (by * by));
+          if ((y[i] >= vi->y) != (y[i] >= vj->y)) {   // edge crosses the horizontal through the point
+            if (((ex * wy) > (ey * wx)) == (vj->y > vi->y))  // crossing is to the right of the point
+              sign = -sign;
+          }
+        }
+        dist[i] = sign * sqrtf(minSq);
+      }
+      break;
+    default:
+      for (uint16_t i = 0; i < count; i++)
+        dist[i] = 3.4e38;
+  }
+}
+
+
+/* sdfShapeClass::distance()
+    Returns the signed distance of a point from the shape
+  Parameters:
+    coordStruct pos: Global coordinates of the point (mm)
+  Returns:
+    float: Signed distance (mm); negative inside the shape
+*/
+float sdfShapeClass::distance(coordStruct pos) {
+  float out;
+
+  render(&out, &pos.x, &pos.y, 0, 1, 0);
+  return (out);
+}
+
+
+/* sdfShapeClass::render()
+    Evaluates the shape for a range of pixels, with pixel coordinates supplied as separate x and y arrays. Only reads the shape, so
+    disjoint pixel ranges may be rendered concurrently (e.g. by spanPoolClass).
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+    float rampWidth: Width (mm) of the ramp inside the shape edge. rampWidth = 0 sets out[] to the signed distance (mm) instead
+  Returns: None
+*/
+void sdfShapeClass::render(float *out, const float *x, const float *y, uint32_t first, uint32_t count, float rampWidth) {
+  float lx[shapeBlockSize], ly[shapeBlockSize];   // block of pixel coordinates, transformed to shape coordinates
+  float acc[shapeBlockSize], dist[shapeBlockSize];
+  float dx, dy, v, gain;
+  uint32_t p;
+  uint16_t n;
+
+  if (numParts == 0) {
+    memset(&out[first], 0, count * sizeof(float));
+    return;
+  }
+  gain = (rampWidth > 0) ? -(scale / rampWidth) : scale;  // converts shape distance to ramp value (or global distance)
+  for (uint32_t blockStart = first; blockStart < (first + count); blockStart += shapeBlockSize) {
+    n = (uint16_t) min((first + count) - blockStart, (uint32_t) shapeBlockSize);
+    for (uint16_t i = 0; i < n; i++) {
+      dx = x[blockStart + i] - offset.x;
+      dy = y[blockStart + i] - offset.y;
+      lx[i] = ((dx * cosA) + (dy * sinA)) * invScale;   // inverse rotation and scale
+      ly[i] = ((dy * cosA) - (dx * sinA)) * invScale;
+    }
+    partDistance(part[0], lx, ly, acc, n);
+    for (uint8_t k = 1; k < numParts; k++) {
+      partDistance(part[k], lx, ly, dist, n);
+      switch (part[k].op) {
+        case SHAPE_INTERSECT:
+          for (uint16_t i = 0; i < n; i++)
+            acc[i] = (dist[i] > acc[i]) ? dist[i] : acc[i];
+          break;
+        case SHAPE_SUBTRACT:
+          for (uint16_t i = 0; i < n; i++)
+            acc[i] = (-dist[i] > acc[i]) ? -dist[i] : acc[i];
+          break;
+        default:  // SHAPE_UNION
+          for (uint16_t i = 0; i < n; i++)
+            acc[i] = (dist[i] < acc[i]) ? dist[i] : acc[i];
+      }
+    }
+    for (uint16_t i = 0; i < n; i++) {
+      p = blockStart + i;
+      v = acc[i] * gain;
+      if (rampWidth > 0)
+        v = (v < 0) ? 0 : ((v > 1) ? 1 : v);
+      out[p] = v;
+    }
+  }
+}
+
+
+/* shapeEffectClass::start()
+    Starts an animation of a shape, which moves, rotates and scales linearly from an initial to a final transform over the duration
+    of the effect. The shape transform is updated by start() and step(), so a shape should be animated by only one effect at a time.
+  Parameters:
+    float duration: Total duration of the effect (seconds)
+    sdfShapeClass *shp: Shape to animate
+    coordStruct pos0, float angle0, float scale0: Initial position (mm), rotation (degrees) and scale factor
+    coordStruct pos1, float angle1, float scale1: Final position (mm), rotation (degrees) and scale factor
+    float rampLen: Width (mm) of the ramp inside the shape edge
+  Returns: None
+*/
+void shapeEffectClass::start(float duration, sdfShapeClass *shp, coordStruct pos0, float angle0, float scale0, coordStruct pos1, 
+                              float angle1, float scale1, float rampLen) {
+  effectSteps = max(ComputeSteps(duration), 1);
+  shape = shp;
+  pos = pos0;
+  angle = angle0;
+  scale = scale0;
+  deltaPos.x = (pos1.x - pos0.x) / (float) effectSteps;
+  deltaPos.y = (pos1.y - pos0.y) / (float) effectSteps;
+  deltaAngle = (angle1 - angle0) / (float) effectSteps;
+  deltaScale = (scale1 - scale0) / (float) effectSteps;
+  rampWidth = max(rampLen, 1);
+  completedFlag = false;
+  lastActive = false;   // report the full span as changed after a (re)start
+  stepNum = 0;
+  active = (shape != NULL);
+  if (active)
+    shape->setTransform(pos, angle, scale);
+}
+
+
+/* shapeEffectClass::step()
+    Called once per step period (frame) to update the shape transform, if active
+  Parameters: None
+  Returns: None
+*/
+void shapeEffectClass::step() {
+  if (active) {
+    pos.x += deltaPos.x;
+    pos.y += deltaPos.y;
+    angle += deltaAngle;
+    scale += deltaScale;
+    shape->setTransform(pos, angle, scale);
+    stepNum++;
+    if (stepNum >= effectSteps) {
+      completedFlag = true;
+      active = false;
+    }
+  }
+}
+
+
+/* shapeEffectClass::value()
+    Returns the ramped shape value (0 - 1) at a point
+  Parameters:
+    coordStruct p: Global coordinates of the point (mm)
+  Returns:
+    float: 0 outside the shape, ramping up to 1 at rampWidth inside the edge
+*/
+float shapeEffectClass::value(coordStruct p) {
+  float out;
+
+  if (!active)
+    return (0);
+  shape->render(&out, &p.x, &p.y, 0, 1, rampWidth);
+  return (out);
+}
+
+
+/* shapeEffectClass::render()
+    Batch version of value() for a range of pixels (see sdfShapeClass::render())
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void shapeEffectClass::render(float *out, const float *x, const float *y, uint32_t first, uint32_t count) {
+  if (!active) {
+    memset(&out[first], 0, count * sizeof(float));
+    return;
+  }
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  shape->render(out, x, y, first, count, rampWidth);
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+
+/* shapeEffectClass::completed()
+    Returns true once, when the effect has just completed
+  Parameters: None
+  Returns:
+    bool: True if the effect completed since the previous call
+*/
+bool shapeEffectClass::completed() {
+  bool retVal;
+
+  retVal = completedFlag;
+  completedFlag = false;
+  return (retVal);
+}
+
+
+/* shapeEffectClass::render() [Overload]
+    Masked version of render(): renders only the pixels in a mask, one run at a time (see PixelMask.cpp). Pixels outside the mask
+    are neither computed nor written.
+  Parameters:
+    float *out: Output array, indexed by pixel number
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    pixelMaskClass &mask: Pixels to render
+  Returns: None
+*/
+void shapeEffectClass::render(float *out, const float *x, const float *y, pixelMaskClass &mask) {
+  mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, x, y, first, count); });
+}
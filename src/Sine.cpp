@@ -5,7 +5,9 @@
     offset = 0.5, level = 0.5 produces a full-range  sine wave with no clipping. 
     A rampDur parameter value of > 0 indicates that the specified parameter values (frequency, level, amplitude) are to be ramped from 
     their current value to the specified new values over the ramp duration. RampDur=0 causes the specified parameters to be applied
-    immediately, and this can be used to establish initial conditions for a subsequent ramp to otrher values. 
+    immediately, and this can be used to establish initial conditions for a subsequent ramp to otrher values. All three parameters
+    are ramped over the same duration, so a single step counter and three per-step deltas are held in the object (rather than three
+    embedded rampVarClass objects). 
     Once started by a call to sineClass::update(), there are only two ways to terminate this effect:
       1. update() is called with frequency=0. The effect is terminated (becomes inactive) immediately
       2. update() is called with amplitude=0. The effect remains active until the sine wave amplitude is ramped down to 0, based on the 
@@ -13,8 +15,8 @@
 */
 #include <Arduino.h>
 #include "EffectUtils.h"
-#include "RampVar.h"
 #include "Sine.h"
+#include "Modulator.h"
 
 
 /* sineClass::update()
@@ -28,36 +30,89 @@
   Returns: None
 */
 void sineClass::update(float freq, float level, float ampl, float rampDur) {
+  uint16_t steps;
+
   if ((!active) || (rampDur == 0)) {  // is sine effect hasn't been started yet, or if parameters have immediate effect
     active = true;
     phaseAngle = 0;
-    phaseDelta = (TWO_PI * freq * stepPeriod);
+    phaseDelta = (TWO_PI * freq * ctx->stepPeriod);
     amplitude = ampl;
     offset = level;
     frequency = freq;
-    freqRamp.active = false;
-    offsetRamp.active = false;
-    amplitudeRamp.active = false;
+    rampSteps = 0;
   } 
   if (rampDur > 0) {    // parameters are to be "ramped in"
-    freqRamp.start(&frequency, freq, rampDur);
-    offsetRamp.start(&offset, level, rampDur);
-    amplitudeRamp.start(&amplitude, ampl, rampDur);
+    steps = ComputeSteps(rampDur);
+    rampSteps = max(steps, 1);
+    freqEnd = freq;
+    offsetEnd = level;
+    amplEnd = ampl;
+    freqDelta = (freqEnd - frequency) / rampSteps;
+    offsetDelta = (offsetEnd - offset) / rampSteps;
+    amplDelta = (amplEnd - amplitude) / rampSteps;
   }
 }
 
 
+/* sineClass::bindFrequency()
+    Binds a shared modulator (see Modulator.cpp) to control the sine frequency, instead of the frequency ramp started by update()
+  Parameters:
+    const modulatorClass *mod: Pointer to the shared modulator, or NULL to restore the frequency set by update()
+    float maxFreq: Frequency (Hz) when the modulator value is 1.0
+  Returns: None
+*/
+void sineClass::bindFrequency(const modulatorClass *mod, float maxFreq) {
+  freqMod = mod;
+  freqModScale = maxFreq;
+}
+
+
+/* sineClass::bindOffset()
+    Binds a shared modulator (see Modulator.cpp) to control the sine offset, instead of the offset ramp started by update()
+  Parameters:
+    const modulatorClass *mod: Pointer to the shared modulator, or NULL to restore the offset set by update()
+  Returns: None
+*/
+void sineClass::bindOffset(const modulatorClass *mod) {
+  offsetMod = mod;
+}
+
+
+/* sineClass::bindAmplitude()
+    Binds a shared modulator (see Modulator.cpp) to control the sine amplitude, instead of the amplitude ramp started by update().
+    The effect is not terminated when a bound amplitude modulator reaches 0.
+  Parameters:
+    const modulatorClass *mod: Pointer to the shared modulator, or NULL to restore the amplitude set by update()
+  Returns: None
+*/
+void sineClass::bindAmplitude(const modulatorClass *mod) {
+  amplitudeMod = mod;
+}
+
+
 /* sineClass::step() 
     Called once per step period (frame) to update effect
   Parameters: None
   Returns: None
 */
 void sineClass::step() {
+  bool rampDone;
+
   if (active) {
-    freqRamp.step();
-    offsetRamp.step();
-    amplitudeRamp.step();
-    phaseDelta = (TWO_PI * frequency * stepPeriod);   // recompute in case it was being ramped
+    if (rampSteps > 0) {    // apply parameter ramps (see rampVarClass::step())
+      rampSteps--;
+      rampDone = (rampSteps == 0);  // end of ramp; avoid rounding errors
+      frequency = rampDone ? freqEnd : (frequency + freqDelta);
+      offset = rampDone ? offsetEnd : (offset + offsetDelta);
+      amplitude = rampDone ? amplEnd : (amplitude + amplDelta);
+    }
+    if (freqMod != NULL)    // bound modulators (stepped by their owner) override the ramped parameters
+      frequency = freqMod->val * freqModScale;
+    if (offsetMod != NULL)
+      offset = offsetMod->val;
+    if (amplitudeMod != NULL)
+      amplitude = amplitudeMod->val;
+    phaseDelta = (TWO_PI * frequency * ctx->stepPeriod);   // recompute in case it was being ramped
     phaseAngle += phaseDelta;
   }
 }
@@ -79,7 +134,7 @@ float sineClass::value(float phaseOffsetFrac) {
   phaseOffset = TWO_PI * phaseOffsetFrac;
   if (active) {
     retVal = constrain((sin(phaseAngle + phaseOffset) * amplitude) + offset, 0, 1);
-    if (amplitude == 0)   // if the amplitude has been ramped down to 0
+    if ((amplitude == 0) && (amplitudeMod == NULL))   // if the amplitude has been ramped down to 0
       active = false;     // terminate this effect
     return (retVal);
   }
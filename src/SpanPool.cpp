@@ -0,0 +1,133 @@
+/* SPANPOOL.CPP
+    This module defines the spanPoolClass, a thread pool used on host builds (e.g. a render server driving pixels over a network
+    bridge, or a preview) to split the rendering of each frame across CPU cores. It is only compiled when EFFECT_HOST_THREADS is
+    defined.
+
+    Each frame, all effects are stepped once on the calling thread, and then run() is called with a render function that renders a
+    range of pixels, typically using the batch render() functions of waveClass, popClass, wipeClass, flowClass and laserClass.
+    The pixels are divided into fixed-size chunks, and each thread (the calling thread plus the workers) repeatedly claims the next
+    chunk from a shared atomic chunk counter until none are left, so faster threads take more chunks. There are no per-thread queues,
+    so no work stealing is needed. Since each pixel is rendered by exactly one thread
+    using only the stepped effect state, the results are identical to single-threaded rendering regardless of the thread count.
+    run() returns when all chunks have been rendered.
+*/
+#include "SpanPool.h"    // included first, so that its standard headers precede Arduino.h
+#include <Arduino.h>
+#include "Trace.h"
+
+#ifdef EFFECT_HOST_THREADS
+
+
+/* spanPoolClass::init()
+    Starts the worker threads
+  Parameters:
+    uint8_t threads: Total number of rendering threads, including the calling thread (1 - spanMaxThreads)
+  Returns: None
+*/
+void spanPoolClass::init(uint8_t threads) {
+  uint32_t startGeneration;
+
+  end();    // stop any existing workers
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    quit = false;
+    startGeneration = generation;   // non-zero if the pool has been used before
+  }
+  numWorkers = constrain(threads, 1, spanMaxThreads) - 1;
+  for (uint8_t w = 0; w < numWorkers; w++)
+    worker[w] = std::thread(&spanPoolClass::workerLoop, this, startGeneration);
+}
+
+
+/* spanPoolClass::end()
+    Stops and joins the worker threads
+  Parameters: None
+  Returns: None
+*/
+void spanPoolClass::end() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    quit = true;
+  }
+  startCv.notify_all();
+  for (uint8_t w = 0; w < numWorkers; w++)
+    worker[w].join();
+  numWorkers = 0;
+}
+
+
+/* spanPoolClass::renderChunks()
+    Takes and renders chunks of the current run() until none are left
+  Parameters: None
+  Returns: None
+*/
+void spanPoolClass::renderChunks() {
+  uint32_t first;
+
+  while ((first = nextChunk.fetch_add(1) * chunkSize) < numPixels)
+    func(funcArg, first, min(chunkSize, numPixels - first));
+}
+
+
+/* spanPoolClass::workerLoop()
+    Thread function for each worker: waits for a new run(), renders chunks, and reports completion
+  Parameters:
+    uint32_t lastGeneration: Value of generation when the worker was started (read under the lock by init()), so that a run()
+      that starts before the worker first waits is not missed, and an earlier one is not repeated
+  Returns: None
+*/
+void spanPoolClass::workerLoop(uint32_t lastGeneration) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      startCv.wait(guard, [&] { return (quit || (generation != lastGeneration)); });
+      if (quit)
+        return;
+      lastGeneration = generation;
+    }
+    renderChunks();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      workersDone++;
+    }
+    doneCv.notify_one();
+  }
+}
+
+
+/* spanPoolClass::run()
+    Renders a frame by calling renderFunc for disjoint pixel ranges on all threads. Returns when all pixels have been rendered.
+  Parameters:
+    spanFuncPtr renderFunc: Function that renders a range of pixels; must only read shared effect state
+    void *arg: Argument passed to renderFunc
+    uint32_t pixels: Total number of pixels
+    uint32_t chunk: Number of pixels per work item
+  Returns: None
+*/
+void spanPoolClass::run(spanFuncPtr renderFunc, void *arg, uint32_t pixels, uint32_t chunk) {
+  bool tracing;
+
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  tracing = effectTrace.enabled;
+  effectTrace.enabled = false;    // the trace buffer has a single producer, so the render functions can't record from the workers
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    func = renderFunc;
+    funcArg = arg;
+    numPixels = pixels;
+    chunkSize = max(chunk, 1);
+    nextChunk = 0;
+    workersDone = 0;
+    generation++;
+  }
+  startCv.notify_all();
+  renderChunks();   // calling thread renders too
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    doneCv.wait(guard, [&] { return (workersDone >= numWorkers); });
+  }
+  effectTrace.enabled = tracing;
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+#endif  // EFFECT_HOST_THREADS
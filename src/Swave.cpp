@@ -5,13 +5,14 @@
     equal to the specified amplitude, occurs at x = (wavelength / 4). The value(position) function is used to
     evaluate the wave at any position (in mm) where position >= 0, and the returned value is in the range -ampltude to +amplitude. 
     
-    The swaveClass object also includes a rampClass object that is optionally used to further scale the  wave output. The ramp effect 
-    total duration (ramp-up, hold, ramp-down) is automatically set to the same duration as the wave, although the ramp-up and ramp-down 
-    durations must be separately configured with swaveClass::setRamp(). 
+    The wave output is optionally further scaled by a ramp function. A ramp is only allocated when swaveClass::setRamp() is used to
+    configure the ramp-up and ramp-down durations; its total duration (ramp-up, hold, ramp-down) is then automatically set to the same
+    duration as the wave. Alternatively, a shared modulator may be bound with swaveClass::bindRamp() (see Modulator.cpp).
 */
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Swave.h"
+#include "Modulator.h"
 
 
 /* swaveClass::start()
@@ -30,23 +31,60 @@ void swaveClass::start(float duration, float wavelen, float freq, float ampl) {
   else
     effectSteps = ComputeSteps(duration);  // total number of steps in wave effect
       // angle change per step; Negative angle delta makes travelling wave move in "positive" direction
-  phaseDelta = -(TWO_PI * freq * stepPeriod);
+  phaseDelta = -(TWO_PI * freq * ctx->stepPeriod);
   phaseAngle = 0;
   stepNum = 0;
   active = true;
-  ramp.start(duration);   // start ramp with same duration
+  if ((outRamp.own != NULL) && (outRamp.mod == outRamp.own))
+    outRamp.own->start(duration);   // start ramp with same duration
 }
 
 
 /* swaveClass::setRamp() 
-    Pass-through to rampClass::setRamp (for convenience). Sets the duration of each of the ramp-up and ramp-down phases of the 
-    trapezoidal ramp function to be applied in subsequent calls to swaveClass::start()
+    Sets the duration of each of the ramp-up and ramp-down phases of the trapezoidal ramp function to be applied in subsequent calls
+    to swaveClass::start(). The ramp is allocated by the first call, and is used unless a shared modulator is bound.
   Parameters:
     float rampDur: Duration of each of the ramp-up and ramp-down phases
   Returns: None
 */
 void swaveClass::setRamp(float rampDur) {
-  ramp.setRamp(rampDur);
+  if (outRamp.own == NULL) {
+    outRamp.own = new rampModulatorClass;
+    if (outRamp.own == NULL)
+      return;
+    outRamp.own->ramp.bindContext(ctx);
+    if (outRamp.mod == &unityModulator)
+      outRamp.mod = outRamp.own;
+  }
+  outRamp.own->ramp.setRamp(rampDur);
+}
+
+
+/* swaveClass::bindRamp() 
+    Binds a shared modulator (see Modulator.cpp) to be used instead of the ramp set by setRamp(). The ramp is not stepped while a
+    modulator is bound.
+  Parameters:
+    const modulatorClass *mod: Pointer to the shared modulator, or NULL to restore the ramp set by setRamp() (or no ramp)
+  Returns: None
+*/
+void swaveClass::bindRamp(const modulatorClass *mod) {
+  if (mod != NULL)
+    outRamp.mod = mod;
+  else
+    outRamp.mod = (outRamp.own != NULL) ? (const modulatorClass *) outRamp.own : &unityModulator;
+}
+
+
+/* swaveClass::bindContext()
+    Binds the effect and its ramp (if any) to a render context, which supplies the step period
+  Parameters:
+    renderContextClass *context: Pointer to the context
+  Returns: None
+*/
+void swaveClass::bindContext(renderContextClass *context) {
+  ctx = context;
+  if (outRamp.own != NULL)
+    outRamp.own->ramp.bindContext(context);
 }
 
 
@@ -58,7 +96,8 @@ void swaveClass::setRamp(float rampDur) {
 void swaveClass::step() {
   if (active) {
     phaseAngle += phaseDelta;
-    ramp.step();  // update ramp function (if active)
+    if ((outRamp.own != NULL) && (outRamp.mod == outRamp.own))  // shared modulator (if bound) is stepped by its owner
+      outRamp.own->step();  // update ramp function (if active)
     if (effectSteps > 0) {  // if finite duration
       stepNum++;
       if (stepNum >= effectSteps) // duration is over
@@ -69,9 +108,9 @@ void swaveClass::step() {
 
 
 /* swaveClass::value() 
-    Returns the current standing wave value (amplitude-scaled) at the specified distance from the wave origin, also scaled by the 
-    embedded ramp function. A value of 0 will be returned prior to the first call to swaveClass::step().
-    The ramp will have no effect unless swaveClass::setRamp() is used to set a non-zero ramp-up/down duration.
+    Returns the current standing wave value (amplitude-scaled) at the specified distance from the wave origin, also scaled by the
+    ramp function or bound modulator. The ramp will have no effect unless swaveClass::setRamp() is used to set a non-zero
+    ramp-up/down duration.
   Parameters: 
     float position: Distance (mm) from the wave origin (x = 0)
   Returns: 
@@ -82,7 +121,7 @@ float swaveClass::value(float position) {
 
   if (active) {
     retVal = sin(TWO_PI * (position / waveLength)) * cos(phaseAngle) * amplitude;
-    retVal *= ramp.val; // scale by current ramp function value
+    retVal *= outRamp.mod->val; // scale by current ramp function (or shared modulator) value
     return (retVal);
   }
   else
@@ -0,0 +1,115 @@
+/* TRACE.CPP
+    This module defines the traceClass, which implements a fixed-size ring buffer of timestamped begin/end events that can be used to
+    see what happened inside individual frames (e.g. a frame that ran long because of a laserClass::start() or a burst of wavelet
+    launches). Recording an event is an inline timestamp read and a few stores, so trace points can be left in frame-critical code.
+
+    There is a single producer (the code recording events) and a single consumer (the code calling drain() or exportJson()), so no
+    locks are needed: the producer only writes head and the consumer only writes tail. The producer never waits; if the buffer fills
+    before it is drained, the oldest events are overwritten and counted as lost. Since the producer may overwrite a slot while the
+    consumer is copying it (e.g. when recording from an interrupt or another thread), drain() re-reads head after copying, and
+    discards any copied events whose slots may have been reused in the meantime, like a sequence lock.
+
+    Trace points are built into the library at frame boundaries (framePipeClass::backBuffer() to submit()), around each effect
+    stepped by schedulerClass::step() and the bank classes, around the batch render() functions, and in expensive start() functions.
+    Since recording is single-producer, render trace points are suspended while spanPoolClass worker threads are rendering; the
+    whole parallel render is recorded as a single event on the calling thread instead.
+
+    Recorded events can be written to any Print-derived stream (Serial, a File, etc.) in Chrome trace-event JSON format, which can be
+    loaded into chrome://tracing or ui.perfetto.dev.
+
+    The global effectTrace object is used by the TRACE_BEGIN()/TRACE_END() macros, which compile to nothing unless EFFECT_TRACE is
+    defined.
+*/
+#include <Arduino.h>
+#include "Trace.h"
+
+traceClass effectTrace;
+
+  // names used for the "name" field of exported events, indexed by traceCatEnum
+static const char *traceCatNames[TRACE_NUM_CATS] = {"frame", "start", "step", "render", "launch"};
+
+
+/* traceClass::drain()
+    Copies the oldest un-drained events (up to maxEvents) to a caller-supplied array, and removes them from the ring buffer.
+  Parameters:
+    traceEventStruct *dest: Pointer to an array of at least maxEvents elements
+    uint16_t maxEvents: Maximum number of events to copy
+  Returns:
+    uint16_t: Number of events copied to dest
+*/
+uint16_t traceClass::drain(traceEventStruct *dest, uint16_t maxEvents) {
+  uint32_t curHead, first, stale;
+  uint16_t count;
+
+  curHead = __atomic_load_n(&head, __ATOMIC_ACQUIRE);   // snapshot of producer index
+  if ((curHead - tail) > traceBufSize) {    // if producer has overwritten events that weren't drained
+    lost += (curHead - tail) - traceBufSize;
+    tail = curHead - traceBufSize;    // skip to oldest event still in the buffer
+  }
+  first = tail;
+  count = 0;
+  while ((tail != curHead) && (count < maxEvents)) {
+    dest[count++] = buf[tail & (traceBufSize - 1)];
+    tail = tail + 1;
+  }
+    // sequence check: the slot of event (h - traceBufSize) is being reused while the producer records event h, so any copied event
+    // at or below that index may be torn
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);    // copies complete before head is re-read
+  curHead = __atomic_load_n(&head, __ATOMIC_RELAXED);
+  if ((curHead - first) >= traceBufSize) {
+    stale = min((uint32_t) (curHead - first - traceBufSize + 1), (uint32_t) count);
+    lost += stale;
+    count -= stale;
+    memmove(dest, dest + stale, count * sizeof(traceEventStruct));
+  }
+  return (count);
+}
+
+
+/* traceClass::exportJson()
+    Drains all recorded events and writes them to the specified stream in Chrome trace-event JSON format. Timestamps are converted to
+    microseconds. The event id is used as the thread id ("tid"), so that each id is shown on its own timeline.
+  Parameters:
+    Print &out: Stream to write the JSON text to (e.g. Serial)
+  Returns: None
+*/
+void traceClass::exportJson(Print &out) {
+  traceEventStruct ev[32];    // drain in small chunks to limit stack usage
+  uint16_t count;
+  uint32_t t0;
+  float usPerTick;
+  bool first;
+
+  usPerTick = 1.0 / ticksPerUs();
+  first = true;
+  t0 = 0;
+  out.print("{\"traceEvents\":[\n");
+  while ((count = drain(ev, 32)) > 0) {
+    for (uint16_t e = 0; e < count; e++) {
+      if (first)
+        t0 = ev[e].time;    // timestamps are relative to the first exported event (handles counter wrap-around)
+      out.printf("%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}", (first ? "" : ",\n"),
+          traceCatNames[(ev[e].category < TRACE_NUM_CATS) ? ev[e].category : 0], ((ev[e].phase == TRACE_BEGIN) ? 'B' : 'E'),
+          (double) ((ev[e].time - t0) * usPerTick), (unsigned) ev[e].id);
+      first = false;
+    }
+  }
+  out.print("\n]}\n");
+}
+
+
+/* traceClass::ticksPerUs()
+    Returns the number of timestamp ticks per microsecond, used to convert timestamps to time
+  Parameters: None
+  Returns:
+    float: CPU cycles per microsecond if the cycle counter is used for timestamps, otherwise 1.0
+*/
+float traceClass::ticksPerUs() {
+#if defined(ARM_DWT_CYCCNT) && defined(__IMXRT1062__)
+  return ((float) F_CPU_ACTUAL / 1000000);
+#elif defined(ARM_DWT_CYCCNT)
+  return ((float) F_CPU / 1000000);
+#else
+  return (1.0);
+#endif
+}
@@ -22,9 +22,9 @@
     For each frame, the sine value for each LED is obtained using a phase angle offset that is based on the LEDs position (relative to an
     arbitrary origin point) as a fraction of the sine wavelength (0 - 1).
 
-    The waveClass object also includes a rampClass object that is optionally used to further scale the sine wave output. The ramp effect 
-    total duration (ramp-up, hold, ramp-down) is automatically set to the same duration as the wave, although the ramp-up and ramp-down 
-    durations must be separately configured with waveClass::setRamp(). 
+    The sine wave output is optionally further scaled by a ramp function. A ramp is only allocated when waveClass::setRamp() is used to
+    configure the ramp-up and ramp-down durations; its total duration (ramp-up, hold, ramp-down) is then automatically set to the same
+    duration as the wave. Alternatively, a shared modulator may be bound with waveClass::bindRamp() (see Modulator.cpp).
 
     The waveClass::setAmplitude and waveClass::setFrequency methods are provided to allow these wave parameters to be changed dynamically
     while the effect is active. 
@@ -32,6 +32,8 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Wave.h"
+#include "Modulator.h"
+#include "Trace.h"
 
 
 /* waveClass::start()
@@ -54,7 +56,8 @@ void waveClass::start(float duration, float frequency, float ampl) {
     phaseAngle = -(TWO_PI / 4); // sin(-π/s) is minimum point of wave, which results in val() = 0
   stepNum = 0;
   active = true;
-  ramp.start(duration);   // start ramp with same duration
+  if ((outRamp.own != NULL) && (outRamp.mod == outRamp.own))
+    outRamp.own->start(duration);   // start ramp with same duration
 }
 
 
@@ -68,20 +71,43 @@ void waveClass::start(float duration, float frequency, float ampl) {
   Returns: None
 */
 void waveClass::start(float duration, float wavelen, float speed, float ampl) {
-  waveLength = max(wavelen, 1); // prevent divide by 0
+  setWaveLength(wavelen);
   start(duration, (speed / waveLength), ampl);
 }
 
 
 /* waveClass::setRamp() 
-    Pass-through to rampClass::setRamp (for convenience). Sets the duration of each of the ramp-up and ramp-down phases of the 
-    trapezoidal ramp function to be applied in subsequent calls to waveClass::start()
+    Sets the duration of each of the ramp-up and ramp-down phases of the trapezoidal ramp function to be applied in subsequent calls
+    to waveClass::start(). The ramp is allocated by the first call, and is used unless a shared modulator is bound.
   Parameters:
     float rampDur: Duration of each of the ramp-up and ramp-down phases
   Returns: None
 */
 void waveClass::setRamp(float rampDur) {
-  ramp.setRamp(rampDur);
+  if (outRamp.own == NULL) {
+    outRamp.own = new rampModulatorClass;
+    if (outRamp.own == NULL)
+      return;
+    outRamp.own->ramp.bindContext(ctx);
+    if (outRamp.mod == &unityModulator)
+      outRamp.mod = outRamp.own;
+  }
+  outRamp.own->ramp.setRamp(rampDur);
+}
+
+
+/* waveClass::bindRamp() 
+    Binds a shared modulator (see Modulator.cpp) to be used instead of the ramp set by setRamp(). The ramp is not stepped while a
+    modulator is bound.
+  Parameters:
+    const modulatorClass *mod: Pointer to the shared modulator, or NULL to restore the ramp set by setRamp() (or no ramp)
+  Returns: None
+*/
+void waveClass::bindRamp(const modulatorClass *mod) {
+  if (mod != NULL)
+    outRamp.mod = mod;
+  else
+    outRamp.mod = (outRamp.own != NULL) ? (const modulatorClass *) outRamp.own : &unityModulator;
 }
 
 
@@ -93,7 +119,7 @@ void waveClass::setRamp(float rampDur) {
   Returns: None
 */
 void waveClass::setFrequency(float frequency) {
-  phaseDelta = -(TWO_PI * frequency * stepPeriod);
+  phaseDelta = -(TWO_PI * frequency * ctx->stepPeriod);
 }
 
 
@@ -108,6 +134,34 @@ void waveClass::setAmplitude(float ampl) {
 }
 
 
+/* waveClass::setWaveLength()
+    Sets the wavelength used by value() and render(), and the cached phase change per mm. May be called while the effect is active;
+    the frequency is unchanged, so the wave speed changes in proportion to the wavelength. A value written directly to the public
+    waveLength member (as before setWaveLength() existed) takes effect at the next step(), which refreshes phasePerMm. The ramp
+    scale factor is not cached, since a bound modulator may be stepped after the wave.
+  Parameters:
+    float wavelen: Wavelength (in mm); values below 1 are set to 1
+  Returns: None
+*/
+void waveClass::setWaveLength(float wavelen) {
+  waveLength = max(wavelen, 1); // prevent divide by 0
+  phasePerMm = TWO_PI / waveLength;
+}
+
+
+/* waveClass::bindContext()
+    Binds the effect and its ramp (if any) to a render context, which supplies the step period
+  Parameters:
+    renderContextClass *context: Pointer to the context
+  Returns: None
+*/
+void waveClass::bindContext(renderContextClass *context) {
+  ctx = context;
+  if (outRamp.own != NULL)
+    outRamp.own->ramp.bindContext(context);
+}
+
+
 /* waveClass::step() 
     Called once per setp period (frame) to update effect, if active
   Parameters: None
@@ -116,7 +170,9 @@ void waveClass::setAmplitude(float ampl) {
 void waveClass::step() {
   if (active) {
     phaseAngle += phaseDelta;
-    ramp.step();  // update ramp function (if active)
+    phasePerMm = TWO_PI / max(waveLength, 1);   // one divide per step, so that direct writes to waveLength take effect
+    if ((outRamp.own != NULL) && (outRamp.mod == outRamp.own))  // shared modulator (if bound) is stepped by its owner
+      outRamp.own->step();  // update ramp function (if active)
     if (effectSteps > 0) {  // if finite duration
       stepNum++;
       if (stepNum >= effectSteps) // duration is over
@@ -127,9 +183,9 @@ void waveClass::step() {
 
 
 /* waveClass::value() 
-    Returns the current wave value (amplitude-scaled) at the specified distance from the wave origin, also scaled by the 
-    embedded ramp function. A value of 0 will be returned prior to the first call to waveClass::step().
-    The ramp will have no effect unless waveClass::setRamp() is used to set a non-zero ramp-up/down duration.
+    Returns the current wave value (amplitude-scaled) at the specified distance from the wave origin, also scaled by the ramp
+    function or bound modulator. The ramp will have no effect unless waveClass::setRamp() is used to set a non-zero ramp-up/down
+    duration.
   Parameters: 
     float position: Distance (mm) from the wave origin (x = 0)
   Returns: 
@@ -140,8 +196,8 @@ float waveClass::value(float position) {
 
   if (active) {
       // shift sin up to range 0 - 2, then scale to range 0 - 1, then scale by amplitude
-    retVal = sin(phaseAngle + (TWO_PI * (position / waveLength))) * amplitude;
-    retVal *= ramp.val; // scale by current ramp function value
+    retVal = sin(phaseAngle + (phasePerMm * position)) * amplitude;
+    retVal *= outRamp.mod->val; // scale by current ramp function (or shared modulator) value
     return (retVal);
   }
   else
@@ -151,9 +207,8 @@ float waveClass::value(float position) {
 
 
 /* waveClass::val() 
-    Returns the current sine wave value (amplitude-scaled) at the specified phase offset, also scaled by the embedded ramp
-    function. A value of 0 will be returned prior to the first call to waveClass::step().
-    The ramp will have no effect unless waveClass::setRamp() is used to set a non-zero ramp-up/down duration.
+    Returns the current sine wave value (amplitude-scaled) at the specified phase offset, also scaled by the ramp function or
+    bound modulator. The ramp will have no effect unless waveClass::setRamp() is used to set a non-zero ramp-up/down duration.
   Parameters: 
     float offset: Fractional part specifies the phase offset as a fraction of a complete cycle (2π radians). Integer part has no effect
   Returns: 
@@ -165,7 +220,7 @@ float waveClass::val(float offset) {
   if (active) {
       // shift sin up to range 0 - 2, then scale to range 0 - 1, then scale by amplitude
     retVal = ((sin(phaseAngle + (offset * TWO_PI)) + 1) / 2) * amplitude;
-    retVal *= ramp.val; // scale by current ramp function value
+    retVal *= outRamp.mod->val; // scale by current ramp function (or shared modulator) value
     return (retVal);
   }
   else
@@ -185,3 +240,36 @@ float waveClass::val() {
 }
 
 
+/* waveClass::render()
+    Batch version of value() for a range of pixels, with the frame-constant terms computed once. Only reads the wave state, so
+    disjoint pixel ranges may be rendered concurrently (e.g. by spanPoolClass).
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *position: Array of pixel distances (mm) from the wave origin
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void waveClass::render(float *out, const float *position, uint32_t first, uint32_t count) {
+  float scale;
+
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  scale = active ? (amplitude * outRamp.mod->val) : 0;
+  for (uint32_t p = first; p < (first + count); p++)
+    out[p] = sinf(phaseAngle + (phasePerMm * position[p])) * scale;
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+
+/* waveClass::render() [Overload]
+    Masked version of render(): renders only the pixels in a mask, one run at a time (see PixelMask.cpp). Pixels outside the mask
+    are neither computed nor written.
+  Parameters:
+    float *out: Output array, indexed by pixel number
+    const float *position: Array of pixel distances (mm) from the wave origin
+    pixelMaskClass &mask: Pixels to render
+  Returns: None
+*/
+void waveClass::render(float *out, const float *position, pixelMaskClass &mask) {
+  mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, position, first, count); });
+}
@@ -10,6 +10,7 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Wavelet.h"
+#include "Trace.h"
 
 //char vstr[80];  // DEBUG
 
@@ -28,8 +29,8 @@
 void waveletClass::start(float duration, float dist, float speed, float accel, float len, float delay) {
   effectSteps = ComputeSteps(duration);
   distance = dist;
-  maxVelocity = speed * stepPeriod; // convert to mm/step
-  acceleration = accel * stepPeriod * stepPeriod; // convert to mm/step/step
+  maxVelocity = speed * ctx->stepPeriod; // convert to mm/step
+  acceleration = accel * ctx->stepPeriod * ctx->stepPeriod; // convert to mm/step/step
   nomLength = len;
   nomDelay = delay;
   for (uint8_t w = 0; w < WAVELETS_MAX_NUM; w++) {
@@ -67,7 +68,7 @@ void waveletClass::step() {
     else {    // if it's time to launch a new wavelet
       launch();
         // compute # of steps until next launch
-      launchCounter = (uint16_t) (randomVar(nomDelay, delayVar) / stepPeriod);
+      launchCounter = (uint16_t) (randomVar(nomDelay, delayVar) / ctx->stepPeriod);
     } 
     if (effectSteps > 0) {    // if finite effect duration
       stepNum++;
@@ -86,6 +87,7 @@ void waveletClass::step() {
   Returns: None
 */
 void waveletClass::launch() {
+  TRACE_BEGIN(TRACE_LAUNCH, traceLibId);
   if (!wvl[nextWvl].active) {   // if wavelet is available to be launched
     wvl[nextWvl].length = randomVar(nomLength, lengthVar);  // apply randonm length variation
     wvl[nextWvl].velocity = maxVelocity * WAVELET_START_VELOCITY;  // start wavelet at fraction of target velocity
@@ -94,6 +96,7 @@ void waveletClass::launch() {
     lastWvl = nextWvl;  // this new wavelet now becomes the last one launched
     nextWvl = (nextWvl + 1) % WAVELETS_MAX_NUM; // move to next member of array, with wrap-around
   }
+  TRACE_END(TRACE_LAUNCH, traceLibId);
 }
 
 
@@ -113,7 +116,7 @@ float waveletClass::randomVar(float nomVal, float maxVar) {
 
   maxVarI = maxVar * 100; // convert fraction to integer in range 0 - 100, exclusive
     // double the range, randomize, and then re-normalize
-  randVar = ((float) random((maxVarI * 2) + 1) / 100) - maxVar;
+  randVar = ((float) ctx->random((maxVarI * 2) + 1) / 100) - maxVar;
   return (nomVal * (1.0 + randVar));
 }
 
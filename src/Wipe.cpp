@@ -14,6 +14,7 @@
 #include <Arduino.h>
 #include "EffectUtils.h"
 #include "Wipe.h"
+#include "Trace.h"
 
 
 /* wipeClass::start()
@@ -31,12 +32,35 @@ void wipeClass::start(float duration, coordStruct refPos, float angle, float dis
   deltaDist = distance / (float) effectSteps;   // compute "speed" of wipe leading edge (mm/step)
   rampWidth = constrain(rampLen, 1, distance);    // ramp width must be > 0 and <= distance
   line.init(refPos, angle);   // initialize the wipe line
+  plane.init({refPos.x, refPos.y, 0}, angle + 90, 0);   // equivalent vertical plane, for the 3D functions
+  volume = false;
   completedFlag = false;
   stepNum = 0;
+  lastActive = false;   // report the full span as changed after a (re)start
   active = true;
 }
 
 
+/* wipeClass::start() [Overload]
+    Starts a volumetric wipe, in which the leading edge is a plane that moves in the direction of its normal. The 2D functions
+    (value(coordStruct) and render(out, x, y, ...)) then evaluate the plane at z = 0.
+  Parameters:
+    float duration: Total duration of the wipe effect
+    coord3Struct refPos: Coordinates of a point on the wipe plane
+    float azimuth: Direction of travel (degrees) in the x-y plane, measured from the x axis. For a vertical plane, this is the
+                    2D wipe angle + 90
+    float elevation: Direction of travel (degrees) above the x-y plane; 90 wipes upward in z
+    float distance: Total distance (in mm) that the leading edge of the wipe ramp will move in the specified duration
+    float rampLen: Length of the linear ramp (in mm) that starts at/behind the wipe plane
+  Returns: None
+*/
+void wipeClass::start(float duration, coord3Struct refPos, float azimuth, float elevation, float distance, float rampLen) {
+  start(duration, {refPos.x, refPos.y}, azimuth - 90, distance, rampLen);
+  plane.init(refPos, azimuth, elevation);
+  volume = true;
+}
+
+
 /* wipeClass::step()
     Called once per step period (frame) to update wipe effect, if active
   Parameters: None
@@ -45,6 +69,7 @@ void wipeClass::start(float duration, coordStruct refPos, float angle, float dis
 void wipeClass::step() {
   if (active) {
     line.step(deltaDist);   // move the line based on the wipe distance / duration
+    plane.step(deltaDist);
     stepNum++;
     if (stepNum >= effectSteps) {  // if wipe is done
       completedFlag = true;
@@ -74,7 +99,7 @@ float wipeClass::value(coordStruct pos) {
 
   if (!active)
     return (0.0f);
-  distFromLine = line.distance(pos);
+  distFromLine = volume ? plane.distance({pos.x, pos.y, 0}) : line.distance(pos);
   if (distFromLine >= 0)   // line hasn't yet crossed the point
     return (0.0f);
   else {  // line has crossed point, so distance is negative
@@ -100,4 +125,121 @@ bool wipeClass::completed() {
   retVal = completedFlag;
   completedFlag = false;
   return retVal;
-}
\ No newline at end of file
+}
+
+
+/* wipeClass::changed()
+    Reports the span where value() may have changed since the previous call (see effect::changed()). The span is expressed as a
+    signed distance (mm) from the current wipe line, where negative distances are behind the line: only the ramp region (plus the
+    distance moved in the last step) changes.
+  Parameters:
+    float *spanStart: Set to the start of the changed span (signed distance from wipe line, mm)
+    float *spanEnd: Set to the end of the changed span (signed distance from wipe line, mm)
+  Returns:
+    spanKindEnum: SPAN_LINE_DIST, or the result of effect::changed() (entire span or SPAN_NONE) when the wipe starts or ends
+*/
+spanKindEnum wipeClass::changed(float *spanStart, float *spanEnd) {
+  if (active && lastActive) {
+    *spanStart = -(rampWidth + deltaDist);
+    *spanEnd = 0;
+    return (SPAN_LINE_DIST);
+  }
+  return (effect::changed(spanStart, spanEnd));
+}
+
+
+/* wipeClass::render()
+    Batch version of value() for a range of pixels, with pixel coordinates supplied as separate x and y arrays. Only reads the wipe
+    state, so disjoint pixel ranges may be rendered concurrently (e.g. by spanPoolClass).
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void wipeClass::render(float *out, const float *x, const float *y, uint32_t first, uint32_t count) {
+  float distBehind;   // distance behind the wipe line (negative if in front)
+  float invRampWidth;
+
+  if (!active) {
+    memset(&out[first], 0, count * sizeof(float));
+    return;
+  }
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  invRampWidth = 1.0 / rampWidth;
+  for (uint32_t p = first; p < (first + count); p++) {
+    distBehind = volume ? -plane.distance({x[p], y[p], 0}) : -line.distance({x[p], y[p]});
+    if (distBehind <= 0)    // line hasn't yet crossed the point
+      out[p] = 0.0f;
+    else if (distBehind > rampWidth)  // back end of ramp has already crossed the point
+      out[p] = 1.0f;
+    else
+      out[p] = distBehind * invRampWidth;
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+/* wipeClass::value3D()
+    Returns the ramp function value at a point in 3 dimensions (see the 2D version above), based on the distance from the wipe plane
+  Parameters:
+    coord3Struct pos: 3D coordinates (in mm) of a point in the global coordinate system
+  Returns:
+    float: Value in range 0.0 - 1.0
+*/
+float wipeClass::value3D(coord3Struct pos) {
+  float distBehind;
+
+  if (!active)
+    return (0.0f);
+  distBehind = -plane.distance(pos);
+  if (distBehind <= 0)    // plane hasn't yet crossed the point
+    return (0.0f);
+  return ((distBehind > rampWidth) ? 1.0f : (distBehind / rampWidth));
+}
+
+
+/* wipeClass::render() [Overload]
+    3D version of render(), with pixel coordinates supplied as separate x, y and z arrays
+  Parameters:
+    float *out: Output array; out[p] is set for p = first to (first + count - 1)
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    const float *z: Array of pixel z coordinates (mm)
+    uint32_t first: First pixel to render
+    uint32_t count: Number of pixels to render
+  Returns: None
+*/
+void wipeClass::render(float *out, const float *x, const float *y, const float *z, uint32_t first, uint32_t count) {
+  float invRampWidth;
+  float v;
+
+  if (!active) {
+    memset(&out[first], 0, count * sizeof(float));
+    return;
+  }
+  TRACE_BEGIN(TRACE_RENDER, traceLibId);
+  invRampWidth = 1.0 / rampWidth;
+  plane.distance(out, x, y, z, first, count);   // signed distance from the plane
+  for (uint32_t p = first; p < (first + count); p++) {
+    v = -out[p] * invRampWidth;
+    out[p] = (v < 0) ? 0.0f : ((v > 1) ? 1.0f : v);
+  }
+  TRACE_END(TRACE_RENDER, traceLibId);
+}
+
+
+/* wipeClass::render() [Overload]
+    Masked version of render(): renders only the pixels in a mask, one run at a time (see PixelMask.cpp). Pixels outside the mask
+    are neither computed nor written.
+  Parameters:
+    float *out: Output array, indexed by pixel number
+    const float *x: Array of pixel x coordinates (mm)
+    const float *y: Array of pixel y coordinates (mm)
+    pixelMaskClass &mask: Pixels to render
+  Returns: None
+*/
+void wipeClass::render(float *out, const float *x, const float *y, pixelMaskClass &mask) {
+  mask.forEachRun([&](uint32_t first, uint32_t count) { render(out, x, y, first, count); });
+}
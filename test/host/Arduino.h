@@ -0,0 +1,75 @@
+/* ARDUINO.H (host shim)
+    Minimal subset of the Arduino/Teensyduino API used by the EffectUtils library, so that the library and the harnesses in this
+    directory can be compiled and run on a host computer. Only used by host builds (see README.md); never by the PlatformIO build.
+*/
+#ifndef _HOST_ARDUINO_SHIM
+#define _HOST_ARDUINO_SHIM
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#define PI 3.1415926535897932384626433832795
+#define TWO_PI 6.283185307179586476925286766559
+#define PROGMEM
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+
+int32_t random(int32_t howBig);
+int32_t random(int32_t howSmall, int32_t howBig);
+void randomSeed(uint32_t newSeed);
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size) {
+    size_t n = 0;
+    while (size--)
+      n += write(*buf++);
+    return (n);
+  }
+  size_t print(const char *s) { return (write((const uint8_t *) s, strlen(s))); }
+  size_t println(const char *s = "") { return (print(s) + print("\n")); }
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(uint8_t *buf, size_t length) {
+    size_t n = 0;
+    int c;
+    while ((n < length) && ((c = read()) >= 0))
+      buf[n++] = (uint8_t) c;
+    return (n);
+  }
+  size_t readBytes(char *buf, size_t length) { return (readBytes((uint8_t *) buf, length)); }
+};
+
+class fileStreamClass : public Stream {   // Stream over a stdio FILE (host only)
+  FILE *f;
+public:
+  fileStreamClass(FILE *file) { f = file; }
+  size_t write(uint8_t b) { return ((fputc(b, f) == EOF) ? 0 : 1); }
+  size_t write(const uint8_t *buf, size_t size) { return (fwrite(buf, 1, size, f)); }
+  int available() { return (feof(f) ? 0 : 1); }
+  int read() { return (fgetc(f)); }
+  int peek() { int c = fgetc(f); if (c != EOF) ungetc(c, f); return (c); }
+};
+
+extern fileStreamClass Serial;    // writes to stdout
+
+#endif  // _HOST_ARDUINO_SHIM
@@ -0,0 +1,18 @@
+/* COLORUTILSHSI.H (host shim)
+    Host stand-in for the parts of the external ColorUtilsHsi library used by EffectUtils (see README.md)
+*/
+#include <Arduino.h>
+
+#ifndef _HOST_COLOR_UTILS_HSI_SHIM
+#define _HOST_COLOR_UTILS_HSI_SHIM
+
+struct hsiF {
+  float h;    // hue (0 - 1)
+  float s;    // saturation (0 - 1)
+  float i;    // intensity (0 - 1)
+};
+
+float HueDistance(float startHue, float endHue, bool useShortestDist, bool positiveDir);
+hsiF InterpHsi(hsiF startColor, hsiF endColor, float frac);
+
+#endif  // _HOST_COLOR_UTILS_HSI_SHIM
@@ -0,0 +1,85 @@
+/* HOSTARDUINO.CPP (host shim)
+    Implements the host stand-ins declared in Arduino.h and ColorUtilsHsi.h in this directory
+*/
+#include <random>
+#include <chrono>
+#include <thread>
+#include "Arduino.h"
+#include "ColorUtilsHsi.h"
+
+fileStreamClass Serial(stdout);
+
+static std::mt19937 hostRng;
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+
+
+int Print::printf(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  int len;
+
+  va_start(args, format);
+  len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  write((const uint8_t *) buf, min(len, (int) sizeof(buf) - 1));
+  return (len);
+}
+
+
+int32_t random(int32_t howBig) {
+  return ((howBig <= 0) ? 0 : (int32_t) (hostRng() % (uint32_t) howBig));
+}
+
+
+int32_t random(int32_t howSmall, int32_t howBig) {
+  return ((howSmall >= howBig) ? howSmall : (howSmall + random(howBig - howSmall)));
+}
+
+
+void randomSeed(uint32_t newSeed) {
+  hostRng.seed(newSeed);
+}
+
+
+uint32_t micros() {
+  return ((uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count());
+}
+
+
+uint32_t millis() {
+  return (micros() / 1000);
+}
+
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+
+float HueDistance(float startHue, float endHue, bool useShortestDist, bool positiveDir) {
+  float dist;
+
+  dist = endHue - startHue;   // -1 to +1
+  if (useShortestDist) {
+    if (dist > 0.5)
+      dist -= 1.0;
+    else if (dist < -0.5)
+      dist += 1.0;
+  }
+  else if (positiveDir && (dist < 0))
+    dist += 1.0;
+  else if (!positiveDir && (dist > 0))
+    dist -= 1.0;
+  return (dist);
+}
+
+
+hsiF InterpHsi(hsiF startColor, hsiF endColor, float frac) {
+  hsiF color;
+
+  color.h = startColor.h + (HueDistance(startColor.h, endColor.h, true, true) * frac);
+  color.h -= floorf(color.h);
+  color.s = startColor.s + ((endColor.s - startColor.s) * frac);
+  color.i = startColor.i + ((endColor.i - startColor.i) * frac);
+  return (color);
+}
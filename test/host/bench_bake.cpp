@@ -0,0 +1,158 @@
+/* BENCH_BAKE.CPP (host harness)
+    Renders a deterministic scene offline (a wave, a flow and a pop on a strip, as RGB bytes, and the same scene without the wave,
+    which leaves most pixels unchanged from frame to frame), bakes it with bakeWriterClass (see
+    Bake.cpp), and plays it back with bakePlayerClass from memory. Reports the stream size in bytes per frame (against the raw frame
+    size), and the decode time per pixel against the time to render and quantize the same frames live. Every played frame is
+    checked against the rendered frame. If an output file is named, the baked stream of the full scene is also written to it (e.g. to be converted
+    to a PROGMEM array, or loaded with bakePlayerClass::load() on a host build with EFFECT_HOST_MMAP).
+
+    Usage:
+      bench_bake [numPixels] [numFrames] [keyInterval] [outFile]     (defaults 1000, 600 and 60)
+*/
+#include <Arduino.h>
+#include "Bake.h"
+#include "Wave.h"
+#include "Flow.h"
+#include "Pop.h"
+
+const float pixelSpacing = 10.0;    // mm
+const uint8_t bytesPerPixel = 3;
+const uint16_t playbackLoops = 5;   // the stream is played this many times for the decode timing
+
+class memPrintClass : public Print {    // Print that collects the baked stream in memory
+public:
+  uint8_t *buf;
+  uint32_t size;
+  uint32_t capacity;
+  memPrintClass() { buf = NULL; size = 0; capacity = 0; }
+  ~memPrintClass() { free(buf); }
+  size_t write(uint8_t b) { return (write(&b, 1)); }
+  size_t write(const uint8_t *data, size_t len) {
+    if ((size + len) > capacity) {
+      capacity = max(capacity * 2, size + (uint32_t) len);
+      buf = (uint8_t *) realloc(buf, capacity);
+    }
+    memcpy(buf + size, data, len);
+    size += len;
+    return (len);
+  }
+};
+
+float *pos, *level;
+uint8_t *frames;    // all rendered frames (the reference for playback)
+uint8_t *out;       // played frame
+waveClass wave;
+flowClass flow;
+popClass pop;
+
+
+  // Renders frame f of the scene into frame (RGB: red from the wave, green from the flow, blue from the pop)
+void renderFrame(uint32_t f, uint32_t numPixels, uint8_t *frame, bool withWave) {
+  float span = numPixels * pixelSpacing;
+
+  if ((f % 300) == 0) {   // restart the scene every 3 seconds (at the default 10 ms step period)
+    wave.active = false;
+    wave.start(3.0, 400, 600, 1.0);
+    flow.start(2.0, span, 200);
+  }
+  if ((f % 100) == 50)
+    pop.start(0.8, {span * ((f / 100) % 4 + 1) / 5, 0}, 800, 60, 300, 0.1, -200);
+  wave.step();
+  flow.step();
+  pop.step();
+  if (withWave)
+    wave.render(level, pos, 0, numPixels);
+  else
+    memset(level, 0, numPixels * sizeof(float));
+  for (uint32_t p = 0; p < numPixels; p++)
+    frame[p * bytesPerPixel] = (uint8_t) ((level[p] + 1) * 127.5);
+  flow.render(level, pos, 0, numPixels);
+  for (uint32_t p = 0; p < numPixels; p++)
+    frame[(p * bytesPerPixel) + 1] = (uint8_t) (level[p] * 255);
+  for (uint32_t p = 0; p < numPixels; p++)
+    frame[(p * bytesPerPixel) + 2] = (uint8_t) (pop.value({pos[p], 0}) * 255);
+}
+
+
+  // Renders, bakes and plays back one scene, printing the results; returns false if playback failed or differed
+bool runScene(bool withWave, uint32_t numPixels, uint32_t numFrames, uint32_t keyInterval, const char *path) {
+  uint32_t frameSize, t, renderUs, decodeUs;
+  memPrintClass stream;
+  bakeWriterClass writer;
+  bakePlayerClass player;
+  FILE *file;
+
+  frameSize = numPixels * bytesPerPixel;
+  t = micros();   // live: render every frame of the scene
+  for (uint32_t f = 0; f < numFrames; f++)
+    renderFrame(f, numPixels, &frames[f * frameSize], withWave);
+  renderUs = micros() - t;
+
+  if (!writer.begin(&stream, numPixels, bytesPerPixel, numFrames, 0, numFrames - 1, keyInterval)) {
+    Serial.printf("bakeWriterClass::begin() failed\n");
+    return (false);
+  }
+  for (uint32_t f = 0; f < numFrames; f++)
+    writer.addFrame(&frames[f * frameSize]);
+  if (!writer.finish() || !player.init(stream.buf, stream.size, out)) {
+    Serial.printf("baked stream rejected\n");
+    return (false);
+  }
+
+  decodeUs = 0;
+  for (uint32_t f = 0; f < (numFrames * playbackLoops); f++) {
+    t = micros();
+    if (!player.step()) {
+      Serial.printf("step() failed at frame %u\n", f % numFrames);
+      return (false);
+    }
+    decodeUs += micros() - t;
+    if (memcmp(out, &frames[(f % numFrames) * frameSize], frameSize) != 0) {
+      Serial.printf("frame %u differs from the rendered frame\n", f % numFrames);
+      return (false);
+    }
+  }
+
+  Serial.printf("%s\n", withWave ? "wave + flow + pop" : "flow + pop");
+  Serial.printf("  stream        %9u bytes  %9.1f bytes/frame (raw %u, %.1f%%)\n", stream.size, player.bytesPerFrame(), frameSize,
+      player.bytesPerFrame() * 100 / frameSize);
+  Serial.printf("  live render   %9.1f us/frame  %6.2f ns/pixel\n", (float) renderUs / numFrames,
+      renderUs * 1000.0 / numFrames / numPixels);
+  Serial.printf("  baked decode  %9.1f us/frame  %6.2f ns/pixel  (all frames identical)\n",
+      (float) decodeUs / numFrames / playbackLoops, decodeUs * 1000.0 / numFrames / playbackLoops / numPixels);
+  if (path != NULL) {
+    file = fopen(path, "wb");
+    if ((file == NULL) || (fwrite(stream.buf, 1, stream.size, file) != stream.size)) {
+      Serial.printf("can't write %s\n", path);
+      return (false);
+    }
+    fclose(file);
+    Serial.printf("  written to %s\n", path);
+  }
+  return (true);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t numPixels, numFrames, keyInterval;
+
+  numPixels = (argc > 1) ? atoi(argv[1]) : 1000;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 600;
+  keyInterval = (argc > 3) ? atoi(argv[3]) : 60;
+  if ((numPixels == 0) || (numFrames == 0) || (keyInterval == 0) || (keyInterval > 255)) {
+    Serial.printf("numPixels and numFrames must be > 0, keyInterval 1 - 255\n");
+    return (1);
+  }
+  pos = new float[numPixels];
+  level = new float[numPixels];
+  frames = new uint8_t[numFrames * numPixels * bytesPerPixel];
+  out = new uint8_t[numPixels * bytesPerPixel];
+  for (uint32_t p = 0; p < numPixels; p++)
+    pos[p] = p * pixelSpacing;
+  Serial.printf("%u pixels x %u bytes, %u frames, key interval %u\n", numPixels, bytesPerPixel, numFrames, keyInterval);
+  if (!runScene(true, numPixels, numFrames, keyInterval, (argc > 4) ? argv[4] : NULL))
+    return (1);
+  if (!runScene(false, numPixels, numFrames, keyInterval, NULL))
+    return (1);
+  return (0);
+}
@@ -0,0 +1,94 @@
+/* BENCH_CUBE.CPP (host harness)
+    Times the 3D batch kernels on a 16 x 16 x 16 LED cube built with pixelMapClass::addGrid(): a spherical pop (popClass::
+    startSphere()) expanding from the center, and a plane wipe (the 3D wipeClass::start() overload) crossing the cube diagonally.
+    Each effect is rendered per frame with its structure-of-arrays render() overload, and with value3D() called per pixel from an
+    array of coord3Struct (the array-of-structures alternative); the outputs must match. Times are reported per frame, and as a
+    fraction of the 10 ms frame period at 100 fps.
+
+    Usage:
+      bench_cube [side] [numFrames]     (defaults 16 and 1000)
+*/
+#include <Arduino.h>
+#include "PixelMap.h"
+#include "Pop.h"
+#include "Wipe.h"
+
+const float pixelSpacing = 30.0;    // mm
+const float framePeriodUs = 10000;  // 100 fps
+
+pixelMapClass cube;
+coord3Struct *coords;   // the same pixels as an array of structures
+float *outA, *outB;
+popClass pop;
+wipeClass wipe;
+
+
+void report(const char *name, uint32_t batchUs, uint32_t aosUs, uint32_t numFrames, float maxDiff) {
+  float batch = (float) batchUs / numFrames;
+  float aos = (float) aosUs / numFrames;
+
+  Serial.printf("  %-12s render() %7.1f us/frame (%4.1f%% of 100 fps)  value3D() %7.1f us/frame (%4.1f%%)  max diff %.2e\n", name,
+      batch, batch * 100 / framePeriodUs, aos, aos * 100 / framePeriodUs, maxDiff);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t side, numFrames, numPixels, t, batchUs, aosUs;
+  float size, maxDiff;
+
+  side = (argc > 1) ? atoi(argv[1]) : 16;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 1000;
+  if ((side == 0) || ((side * side * side) > 0xFFFF) || (numFrames == 0)) {
+    Serial.printf("side must be 1 - 40, numFrames > 0\n");
+    return (1);
+  }
+  numPixels = side * side * side;
+  if (!cube.init(numPixels) || !cube.addGrid({0, 0, 0}, side, side, side, pixelSpacing)) {
+    Serial.printf("pixelMapClass allocation failed\n");
+    return (1);
+  }
+  coords = new coord3Struct[numPixels];
+  outA = new float[numPixels];
+  outB = new float[numPixels];
+  for (uint32_t p = 0; p < numPixels; p++)
+    coords[p] = {cube.x()[p], cube.y()[p], cube.z()[p]};
+  size = (side - 1) * pixelSpacing;
+  Serial.printf("%u x %u x %u cube (%u pixels), %u frames\n", side, side, side, numPixels, numFrames);
+
+  batchUs = aosUs = 0;
+  maxDiff = 0;
+  for (uint32_t f = 0; f < numFrames; f++) {
+    if (!pop.active)
+      pop.startSphere(1.0, {size / 2, size / 2, size / 2}, size, 90);
+    pop.step();
+    t = micros();
+    pop.render(outA, cube.x(), cube.y(), cube.z(), 0, numPixels);
+    batchUs += micros() - t;
+    t = micros();
+    for (uint32_t p = 0; p < numPixels; p++)
+      outB[p] = pop.value3D(coords[p]);
+    aosUs += micros() - t;
+    for (uint32_t p = 0; p < numPixels; p++)
+      maxDiff = max(maxDiff, fabsf(outA[p] - outB[p]));
+  }
+  report("sphere pop", batchUs, aosUs, numFrames, maxDiff);
+
+  batchUs = aosUs = 0;
+  maxDiff = 0;
+  for (uint32_t f = 0; f < numFrames; f++) {
+    if (!wipe.active)
+      wipe.start(1.5, {0, 0, 0}, 45, 35, size * 1.8, 120);
+    wipe.step();
+    t = micros();
+    wipe.render(outA, cube.x(), cube.y(), cube.z(), 0, numPixels);
+    batchUs += micros() - t;
+    t = micros();
+    for (uint32_t p = 0; p < numPixels; p++)
+      outB[p] = wipe.value3D(coords[p]);
+    aosUs += micros() - t;
+    for (uint32_t p = 0; p < numPixels; p++)
+      maxDiff = max(maxDiff, fabsf(outA[p] - outB[p]));
+  }
+  report("plane wipe", batchUs, aosUs, numFrames, maxDiff);
+  return (0);
+}
@@ -0,0 +1,100 @@
+/* BENCH_FADEBANK.CPP (host harness)
+    Times fadeBankClass::step() (see FadeBank.cpp) for a dense scene, where every pixel fades with a stagger, and a sparse "twinkle"
+    scene, where a new single-pixel fade starts every frame, so that only a few percent of the pixels are fading at any time. Each
+    scene is also run with an array of fadeClass objects (one per pixel, each stepped every frame), the per-pixel approach that
+    fadeBankClass replaces, with the same pixels and fades; fadeClass has no delay, so the staggered fades of the dense scene are
+    started by the loop in the frame in which the bank would start them. A checksum of the final colors is printed, so that builds
+    of the library can be compared for identical output, and the two approaches for matching output (within float rounding, since
+    fadeClass accumulates a delta per step).
+
+    Usage:
+      bench_fadebank [numPixels] [numFrames]     (defaults 3000 and 500)
+*/
+#include <Arduino.h>
+#include "FadeBank.h"
+#include "Fade.h"
+
+hsiF *colors;
+fadeBankClass bank;
+fadeClass *fades;   // one per pixel
+
+
+  // Sums the final colors, weighted by position, so that any difference in output changes the result
+double checksum(uint16_t numPixels) {
+  double sum = 0;
+
+  for (uint16_t p = 0; p < numPixels; p++)
+    sum += (colors[p].h + (2 * colors[p].s) + (3 * colors[p].i)) * (p + 1);
+  return (sum);
+}
+
+
+  // Runs a scene for numFrames with the fade bank, or with the fadeClass array, returning the mean time per frame of the stepping (us)
+float runScene(bool dense, bool useBank, uint16_t numPixels, uint32_t numFrames) {
+  const hsiF denseColor = {0.2, 0.8, 1.0};
+  const float denseDuration = 2.0, denseStagger = 2.0;
+  uint32_t t, elapsed = 0;
+  float delayPerPixel;
+  uint16_t pixel;
+  hsiF target;
+
+  for (uint16_t p = 0; p < numPixels; p++) {
+    colors[p] = {0.9, 1.0, 0.5};
+    fades[p].init();
+  }
+  bank.init(numPixels, colors);
+  randomSeed(1);
+  if (dense && useBank)
+    bank.startAll(denseDuration, denseColor, denseStagger);
+  delayPerPixel = (numPixels > 1) ? (denseStagger / (numPixels - 1)) : 0;
+  for (uint32_t f = 0; f < numFrames; f++) {
+    if (!dense) {   // twinkle: one new 0.5 second fade per frame, to a random hue (~50 pixels fading at a time)
+      pixel = random(numPixels);
+      target = {random(1000) / 1000.0f, 1.0, random(2) ? 1.0f : 0.0f};
+      if (useBank)
+        bank.start(pixel, 0.5, target, 0);
+      else
+        fades[pixel].start(0.5, &colors[pixel], target);
+    }
+    else if (!useBank) {   // start the fades whose stagger delay ends in this frame, as startAll() does in the bank
+      for (uint16_t p = 0; p < numPixels; p++) {
+        if (bank.ComputeSteps(delayPerPixel * p) == f)
+          fades[p].start(denseDuration, &colors[p], denseColor);
+      }
+    }
+    t = micros();
+    if (useBank)
+      bank.step();
+    else {
+      for (uint16_t p = 0; p < numPixels; p++)
+        fades[p].step();
+    }
+    elapsed += micros() - t;
+  }
+  return ((float) elapsed / numFrames);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t numPixels, numFrames;
+  float us;
+
+  numPixels = (argc > 1) ? atoi(argv[1]) : 3000;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 500;
+  if ((numPixels == 0) || (numPixels >= 0xFFFF) || (numFrames == 0)) {
+    Serial.printf("numPixels must be 1 - 65534, numFrames > 0\n");
+    return (1);
+  }
+  colors = new hsiF[numPixels];
+  fades = new fadeClass[numPixels];
+  Serial.printf("%u pixels, %u frames\n", numPixels, numFrames);
+  us = runScene(true, true, numPixels, numFrames);
+  Serial.printf("  dense   (startAll, 2 s stagger)   fadeBankClass %8.2f us/step  checksum %.6f\n", us, checksum(numPixels));
+  us = runScene(true, false, numPixels, numFrames);
+  Serial.printf("                                    fadeClass[]   %8.2f us/step  checksum %.6f\n", us, checksum(numPixels));
+  us = runScene(false, true, numPixels, numFrames);
+  Serial.printf("  sparse  (one new fade per frame)  fadeBankClass %8.2f us/step  checksum %.6f\n", us, checksum(numPixels));
+  us = runScene(false, false, numPixels, numFrames);
+  Serial.printf("                                    fadeClass[]   %8.2f us/step  checksum %.6f\n", us, checksum(numPixels));
+  return (0);
+}
@@ -0,0 +1,91 @@
+/* BENCH_INSTANCE.CPP (host harness)
+    Measures instanceMapClass on a rig of 24 identical strips, wired in serpentine order (odd strips reversed). A wave and a flow
+    run along each strip (the position of a pixel is its distance from the start of its own strip), and each frame is produced
+    two ways:
+      full:     render() over every pixel of the rig
+      instance: render() over the pixels of the mask built by addSources() (strip 0 only), then apply() to copy strip 0 into the
+                other 23 strips
+    The outputs of the two variants must be identical; the maximum difference is reported alongside the time per frame.
+
+    Usage:
+      bench_instance [stripLen] [numFrames]     (defaults 300 and 1000)
+*/
+#include <Arduino.h>
+#include "Instance.h"
+#include "PixelMask.h"
+#include "Wave.h"
+#include "Flow.h"
+
+const uint8_t numStrips = 24;
+const float pixelSpacing = 16.6;    // mm (60 pixels/m)
+
+float *pos, *outA, *outB;   // pos = distance of each pixel from the start of its strip
+uint32_t stripLen, numPixels;
+instanceMapClass inst;
+pixelMaskClass mask;
+waveClass wave;
+flowClass flow;
+
+
+void startWave() { wave.start(0, 500, 1000, 1.0); }    // runs until stopped
+void startFlow() { flow.start(5, stripLen * pixelSpacing, 200); }
+
+
+  // times the full and instance variants of one effect, restarting it whenever it finishes
+template <class E> void bench(const char *name, E &effect, void (*restart)(), uint32_t numFrames) {
+  uint32_t t, fullUs, instUs;
+  float maxDiff;
+
+  fullUs = instUs = 0;
+  maxDiff = 0;
+  for (uint32_t f = 0; f < numFrames; f++) {
+    if (!effect.active)
+      restart();
+    effect.step();
+    t = micros();
+    effect.render(outA, pos, 0, numPixels);
+    fullUs += micros() - t;
+    t = micros();
+    effect.render(outB, pos, mask);
+    inst.apply(outB);
+    instUs += micros() - t;
+    for (uint32_t p = 0; p < numPixels; p++)
+      maxDiff = max(maxDiff, fabsf(outA[p] - outB[p]));
+  }
+  Serial.printf("  %-6s full %8.1f us/frame  instance %8.1f us/frame  (%5.1fx)  max diff %.2e\n", name,
+      (float) fullUs / numFrames, (float) instUs / numFrames, (float) fullUs / max(instUs, 1U), maxDiff);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t numFrames, i;
+
+  stripLen = (argc > 1) ? atoi(argv[1]) : 300;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 1000;
+  if ((stripLen == 0) || (numFrames == 0)) {
+    Serial.printf("stripLen and numFrames must be > 0\n");
+    return (1);
+  }
+  numPixels = stripLen * numStrips;
+  pos = new float[numPixels];
+  outA = new float[numPixels];
+  outB = new float[numPixels];
+  for (uint32_t p = 0; p < numPixels; p++) {
+    i = p % stripLen;
+    if (((p / stripLen) & 1) != 0)    // odd strips are wired from the far end
+      i = stripLen - 1 - i;
+    pos[p] = i * pixelSpacing;
+  }
+  if (!mask.init(numPixels) || !inst.addStrips(0, stripLen, numStrips, stripLen, true)) {
+    Serial.printf("mask or instance map setup failed\n");
+    return (1);
+  }
+  mask.setAll();
+  inst.addSources(mask);
+  Serial.printf("%u strips x %u pixels (%u pixels), %u copies, %u rendered pixels, %u frames\n", numStrips, stripLen, numPixels,
+      inst.copyCount(), mask.count(), numFrames);
+
+  bench("wave", wave, startWave, numFrames);
+  bench("flow", flow, startFlow, numFrames);
+  return (0);
+}
@@ -0,0 +1,120 @@
+/* BENCH_PARTICLES.CPP (host harness)
+    Times particlePoolClass (see Particles.cpp) step() and render() with 10, 100 and 1,000 live particles on a strip (half
+    droplets, half pops, re-emitted as they finish so that the live count stays constant), against the object-per-particle approach
+    it replaces: arrays of dropletClass and popClass objects, each stepped, and every pixel evaluated against every object.
+
+    Usage:
+      bench_particles [numPixels] [numFrames]     (defaults 3000 and 200)
+*/
+#include <Arduino.h>
+#include "Particles.h"
+#include "Droplet.h"
+#include "Pop.h"
+
+const float pixelSpacing = 10.0;    // mm
+const uint16_t liveCounts[] = {10, 100, 1000};
+const uint16_t maxLive = 1000;
+
+dropletConfigStruct dropletConfig = {50, 400, 30, 2000, 3000, 20};
+particlePoolClass pool;
+dropletClass droplet[maxLive / 2];
+popClass pop[maxLive / 2];
+float *pos, *out;
+uint32_t numPixels;
+
+
+  // Starts a droplet or pop at a random position on the strip
+void emit(bool isPop, uint16_t n, bool objects) {
+  float start = random(numPixels * pixelSpacing);
+
+  if (!isPop) {
+    if (objects)
+      droplet[n].start(min(1000.0f, (numPixels * pixelSpacing) - start) + 1);
+    else
+      pool.emitDroplet(&dropletConfig, start, min(1000.0f, (numPixels * pixelSpacing) - start) + 1);
+  }
+  else {
+    if (objects)
+      pop[n].start(1.0, {start, 0}, 300, 60);
+    else
+      pool.emitPop(start, 300, 1.0, 60);
+  }
+}
+
+
+  // Pool: tops up the live particles, steps and renders; returns the time (us) of step() + render()
+uint32_t framePool(uint16_t numLive) {
+  uint32_t t;
+
+  while (pool.liveCount() < numLive)
+    emit((pool.liveCount() & 1) != 0, 0, false);
+  t = micros();
+  pool.step();
+  memset(out, 0, numPixels * sizeof(float));
+  pool.render(out, numPixels, pixelSpacing, 0);
+  return (micros() - t);
+}
+
+
+  // Objects: restarts finished objects, steps each, and evaluates every pixel against every object (combined by maximum)
+uint32_t frameObjects(uint16_t numLive) {
+  uint32_t t;
+  float v;
+
+  for (uint16_t n = 0; n < (numLive / 2); n++) {
+    if (!droplet[n].active)
+      emit(false, n, true);
+    if (!pop[n].active)
+      emit(true, n, true);
+  }
+  t = micros();
+  for (uint16_t n = 0; n < (numLive / 2); n++) {
+    droplet[n].step();
+    pop[n].step();
+  }
+  for (uint32_t p = 0; p < numPixels; p++) {
+    v = 0;
+    for (uint16_t n = 0; n < (numLive / 2); n++) {
+      v = max(v, droplet[n].value(pos[p]));
+      v = max(v, pop[n].value({pos[p], 0}));
+    }
+    out[p] = v;
+  }
+  return (micros() - t);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t numFrames, poolUs, objectUs;
+
+  numPixels = (argc > 1) ? atoi(argv[1]) : 3000;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 200;
+  if ((numPixels == 0) || (numPixels > 0xFFFF) || (numFrames == 0)) {   // render() takes a uint16_t pixel count
+    Serial.printf("numPixels must be 1 - 65535, numFrames > 0\n");
+    return (1);
+  }
+  pos = new float[numPixels];
+  out = new float[numPixels];
+  for (uint32_t p = 0; p < numPixels; p++)
+    pos[p] = p * pixelSpacing;
+  for (uint16_t n = 0; n < (maxLive / 2); n++)
+    droplet[n].init(&dropletConfig);
+  if (!pool.init(maxLive)) {
+    Serial.printf("particlePoolClass::init() failed\n");
+    return (1);
+  }
+  randomSeed(1);
+
+  Serial.printf("%u pixels, %u frames\n  particles  pool us/frame  objects us/frame  speedup\n", numPixels, numFrames);
+  for (uint16_t numLive : liveCounts) {
+    pool.clear();
+    poolUs = objectUs = 0;
+    for (uint32_t f = 0; f < numFrames; f++) {
+      poolUs += framePool(numLive);
+      objectUs += frameObjects(numLive);
+    }
+    Serial.printf("  %9u %14.1f %17.1f %8.1f\n", numLive, (float) poolUs / numFrames, (float) objectUs / numFrames,
+        (float) objectUs / poolUs);
+  }
+  return (0);
+}
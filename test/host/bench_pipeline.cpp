@@ -0,0 +1,98 @@
+/* BENCH_PIPELINE.CPP (host harness)
+    Benchmarks pipeline<> (see Pipeline.h) against the hand-written per-pixel loop it replaces, and against the per-effect batch
+    render() functions, for the product of a wave, a flow and a ramp on a strip. Each variant renders the same frames; the maximum
+    difference from the hand-written loop is reported alongside the time per frame.
+
+    Usage:
+      bench_pipeline [numPixels] [numFrames]     (defaults 1000 and 2000)
+*/
+#include <Arduino.h>
+#include "Pipeline.h"
+
+const float pixelSpacing = 10.0;    // mm
+
+float *pos, *ref, *out, *tmp;
+waveClass wave;
+flowClass flow;
+rampClass ramp;
+
+
+  // Restarts the effects, so that every variant renders the same sequence of frames
+void startScene(uint32_t numPixels) {
+  wave.start(0, 400, 600, 1.0);
+  flow.start(0, numPixels * pixelSpacing, 300);
+  ramp.setRamp(0.5);
+  ramp.start(0);
+}
+
+
+void stepScene() {
+  wave.step();
+  flow.step();
+  ramp.step();
+}
+
+
+  // Runs one variant for numFrames, returning the mean time per frame (us) and the max difference from ref[] on the last frame
+float runVariant(int variant, uint32_t numPixels, uint32_t numFrames, float *maxDiff) {
+  pipeline<pipeMultiply, waveClass, flowClass, rampClass> pipe;
+  uint32_t t, elapsed = 0;
+
+  startScene(numPixels);
+  for (uint32_t f = 0; f < numFrames; f++) {
+    stepScene();
+    t = micros();
+    if (variant == 0) {   // hand-written loop: out-of-line value functions per pixel
+      for (uint32_t p = 0; p < numPixels; p++)
+        out[p] = wave.value(pos[p]) * flow.val(pos[p]) * ramp.val;
+    }
+    else if (variant == 1) {  // batch render() of each effect, then combine
+      wave.render(out, pos, 0, numPixels);
+      flow.render(tmp, pos, 0, numPixels);
+      for (uint32_t p = 0; p < numPixels; p++)
+        out[p] = out[p] * tmp[p] * ramp.val;
+    }
+    else {    // fused pipeline
+      pipe.load(wave, flow, ramp);
+      pipe.render(out, pos, numPixels);
+    }
+    elapsed += micros() - t;
+  }
+  *maxDiff = 0;
+  for (uint32_t p = 0; p < numPixels; p++)
+    *maxDiff = max(*maxDiff, fabsf(out[p] - ref[p]));
+  return ((float) elapsed / numFrames);
+}
+
+
+int main(int argc, char **argv) {
+  const char *name[] = {"hand-written loop", "batch render()", "pipeline<>"};
+  uint32_t numPixels, numFrames;
+  float us, diff;
+
+  numPixels = (argc > 1) ? atoi(argv[1]) : 1000;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 2000;
+  if ((numPixels == 0) || (numPixels > 0xFFFF) || (numFrames == 0)) {   // pipeline<>::render() takes a uint16_t count
+    Serial.printf("numPixels must be 1 - 65535, numFrames > 0\n");
+    return (1);
+  }
+  pos = new float[numPixels];
+  ref = new float[numPixels];
+  out = new float[numPixels];
+  tmp = new float[numPixels];
+  for (uint32_t p = 0; p < numPixels; p++)
+    pos[p] = p * pixelSpacing;
+
+  startScene(numPixels);    // reference output of the last frame, from the hand-written loop
+  for (uint32_t f = 0; f < numFrames; f++)
+    stepScene();
+  for (uint32_t p = 0; p < numPixels; p++)
+    ref[p] = wave.value(pos[p]) * flow.val(pos[p]) * ramp.val;
+
+  Serial.printf("%u pixels, %u frames\n", numPixels, numFrames);
+  for (int v = 0; v < 3; v++) {
+    us = runVariant(v, numPixels, numFrames, &diff);
+    Serial.printf("  %-18s %9.1f us/frame  %6.2f ns/pixel  max diff %.2e\n", name[v], us, us * 1000 / numPixels, diff);
+  }
+  return (0);
+}
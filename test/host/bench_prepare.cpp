@@ -0,0 +1,191 @@
+/* BENCH_PREPARE.CPP (host harness)
+    Measures the per-frame caching of effect::prepareFrame() (and waveClass::setWaveLength()) for dropletClass, waveClass, popClass
+    and laserClass. Each frame, every pixel is evaluated three ways:
+      uncached: the cached terms are recomputed before every pixel (prepareFrame(), or setWaveLength() for the wave), then value() -
+                the per-pixel work of the value functions before the cache existed
+      value():  the per-pixel value function, reading the cache
+      render(): the batch render() function (dropletClass has none)
+    The outputs of the three variants must be identical; the maximum difference is reported alongside the time per pixel.
+
+    Usage:
+      bench_prepare [numPixels] [numFrames]     (defaults 1000 and 1000)
+*/
+#include <Arduino.h>
+#include "Droplet.h"
+#include "Wave.h"
+#include "Pop.h"
+#include "Laser.h"
+
+const float pixelSpacing = 10.0;    // mm
+
+float *pos, *posY, *outA, *outB, *outC;    // pixels on a strip along the x axis (posY all 0)
+hsiF *colA, *colB, *colC;
+uint32_t numPixels;
+uint32_t elapsed[3];    // total time of each variant (us)
+float maxDiff;
+
+dropletConfigStruct dropletConfig = {50, 400, 30, 2000, 3000, 20};
+laserConfigStruct laserConfig = {150, {0.0, 1.0, 1.0}, {0.6, 1.0, 0.3}, 0.5, 4, 12};
+dropletClass droplet;
+waveClass wave;
+popClass pop;
+laserClass laser;
+
+
+void timeVariant(int variant, uint32_t start) {
+  elapsed[variant] += micros() - start;
+}
+
+
+void compare(const float *a, const float *b) {
+  for (uint32_t p = 0; p < numPixels; p++)
+    maxDiff = max(maxDiff, fabsf(a[p] - b[p]));
+}
+
+
+void compare(const hsiF *a, const hsiF *b) {
+  for (uint32_t p = 0; p < numPixels; p++)
+    maxDiff = max(maxDiff, max(fabsf(a[p].h - b[p].h), max(fabsf(a[p].s - b[p].s), fabsf(a[p].i - b[p].i))));
+}
+
+
+void frameDroplet() {
+  uint32_t t;
+
+  if (!droplet.active)
+    droplet.start(numPixels * pixelSpacing);
+  droplet.step();
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++) {
+    droplet.prepareFrame();
+    outA[p] = droplet.value(pos[p]);
+  }
+  timeVariant(0, t);
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++)
+    outB[p] = droplet.value(pos[p]);
+  timeVariant(1, t);
+  compare(outA, outB);
+}
+
+
+void frameWave() {
+  uint32_t t;
+
+  if (!wave.active)
+    wave.start(2.0, 400, 600, 1.0);
+  wave.step();
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++) {
+    wave.setWaveLength(wave.waveLength);
+    outA[p] = wave.value(pos[p]);
+  }
+  timeVariant(0, t);
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++)
+    outB[p] = wave.value(pos[p]);
+  timeVariant(1, t);
+  t = micros();
+  wave.render(outC, pos, 0, numPixels);
+  timeVariant(2, t);
+  compare(outA, outB);
+  compare(outA, outC);
+}
+
+
+void framePop() {
+  uint32_t t;
+
+  if (!pop.active)
+    pop.start(1.5, {numPixels * pixelSpacing / 2, 0}, numPixels * pixelSpacing / 2, 300);
+  pop.step();
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++) {
+    pop.prepareFrame();
+    outA[p] = pop.value({pos[p], 0});
+  }
+  timeVariant(0, t);
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++)
+    outB[p] = pop.value({pos[p], 0});
+  timeVariant(1, t);
+  t = micros();
+  pop.render(outC, pos, posY, 0, numPixels);
+  timeVariant(2, t);
+  compare(outA, outB);
+  compare(outA, outC);
+}
+
+
+void frameLaser() {
+  uint32_t t;
+
+  if (!laser.active)
+    laser.start({0.1, 1.0, 1.0}, 0.5, 2.0);
+  laser.step();
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++) {
+    laser.prepareFrame();
+    colA[p] = laser.colorVal(p);
+  }
+  timeVariant(0, t);
+  t = micros();
+  for (uint32_t p = 0; p < numPixels; p++)
+    colB[p] = laser.colorVal(p);
+  timeVariant(1, t);
+  t = micros();
+  laser.render(colC, 0, numPixels);
+  timeVariant(2, t);
+  compare(colA, colB);
+  compare(colA, colC);
+}
+
+
+void runBench(const char *name, void (*frame)(), uint32_t numFrames, bool hasRender) {
+  const char *variant[] = {"uncached", "value()", "render()"};
+
+  elapsed[0] = elapsed[1] = elapsed[2] = 0;
+  maxDiff = 0;
+  for (uint32_t f = 0; f < numFrames; f++)
+    frame();
+  Serial.printf("  %-8s", name);
+  for (int v = 0; v < 3; v++) {
+    if ((v < 2) || hasRender)
+      Serial.printf("  %s %6.2f ns/px", variant[v], elapsed[v] * 1000.0 / numFrames / numPixels);
+    else
+      Serial.printf("  %s %6s      ", variant[v], "-");
+  }
+  Serial.printf("  max diff %.2e\n", maxDiff);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t numFrames;
+
+  numPixels = (argc > 1) ? atoi(argv[1]) : 1000;
+  numFrames = (argc > 2) ? atoi(argv[2]) : 1000;
+  if ((numPixels == 0) || (numPixels > 0xFFFF) || (numFrames == 0)) {   // laserClass takes a uint16_t pixel count
+    Serial.printf("numPixels must be 1 - 65535, numFrames > 0\n");
+    return (1);
+  }
+  pos = new float[numPixels];
+  posY = new float[numPixels]();
+  outA = new float[numPixels];
+  outB = new float[numPixels];
+  outC = new float[numPixels];
+  colA = new hsiF[numPixels];
+  colB = new hsiF[numPixels];
+  colC = new hsiF[numPixels];
+  for (uint32_t p = 0; p < numPixels; p++)
+    pos[p] = p * pixelSpacing;
+  droplet.init(&dropletConfig);
+  laser.init(numPixels, numPixels * pixelSpacing, &laserConfig);
+  randomSeed(1);
+
+  Serial.printf("%u pixels, %u frames\n", numPixels, numFrames);
+  runBench("droplet", frameDroplet, numFrames, false);
+  runBench("wave", frameWave, numFrames, true);
+  runBench("pop", framePop, numFrames, true);
+  runBench("laser", frameLaser, numFrames, true);
+  return (0);
+}
@@ -0,0 +1,107 @@
+/* BENCH_SPANPOOL.CPP (host harness)
+    Measures how spanPoolClass (see SpanPool.cpp) scales with the number of threads, rendering the sum of a wave and a pop over a 2D
+    pixel grid at 50,000 and 500,000 pixels. Each thread count is checked against the single-threaded output, and the pool is
+    re-initialized for every thread count, so that a worker missing or repeating a run() would show up as a hang or a mismatch.
+
+    Build with -DEFFECT_HOST_THREADS -pthread added to the command in README.md.
+    Usage:
+      bench_spanpool [maxThreads] [numFrames]     (defaults: number of CPU cores, and 50)
+*/
+#include "SpanPool.h"    // included first, so that its standard headers precede Arduino.h
+#include <Arduino.h>
+#include "Wave.h"
+#include "Pop.h"
+
+#ifndef EFFECT_HOST_THREADS
+#error "bench_spanpool requires -DEFFECT_HOST_THREADS -pthread"
+#endif
+
+const float pixelSpacing = 10.0;    // mm
+const uint32_t gridSizes[] = {50000, 500000};
+
+struct sceneStruct {    // arguments of renderSpan()
+  float *x, *y;         // pixel coordinates (mm)
+  float *out;           // rendered frame
+  float *tmp;           // pop output, combined into out
+};
+
+waveClass wave;
+popClass pop;
+spanPoolClass pool;
+
+
+  // Span render function: wave + pop for pixels first to (first + count - 1)
+void renderSpan(void *arg, uint32_t first, uint32_t count) {
+  sceneStruct *scene = (sceneStruct *) arg;
+
+  wave.render(scene->out, scene->x, first, count);
+  pop.render(scene->tmp, scene->x, scene->y, first, count);
+  for (uint32_t p = first; p < (first + count); p++)
+    scene->out[p] += scene->tmp[p];
+}
+
+
+  // Renders numFrames with the current pool, returning the mean time per frame (us); out holds the last frame
+float runFrames(sceneStruct *scene, uint32_t numPixels, uint32_t numFrames) {
+  uint32_t t, elapsed = 0;
+
+  wave.active = false;    // so that start() resets the phase, and every thread count renders the same frames
+  wave.start(0, 400, 600, 0.5);
+  pop.start(10.0, {500, 500}, 10000, 300);
+  for (uint32_t f = 0; f < numFrames; f++) {
+    wave.step();
+    pop.step();
+    t = micros();
+    pool.run(renderSpan, scene, numPixels);
+    elapsed += micros() - t;
+  }
+  return ((float) elapsed / numFrames);
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t maxThreads, numFrames, numPixels, side;
+  sceneStruct scene;
+  float *ref;
+  float us, us1;
+  bool same;
+
+  maxThreads = (argc > 1) ? atoi(argv[1]) : max(std::thread::hardware_concurrency(), 1);
+  maxThreads = constrain(maxThreads, 1, spanMaxThreads);
+  numFrames = (argc > 2) ? max(atoi(argv[2]), 1) : 50;
+  Serial.printf("%u frames, up to %u threads (%u cores)\n", numFrames, maxThreads, std::thread::hardware_concurrency());
+  for (uint32_t size : gridSizes) {
+    numPixels = size;
+    side = (uint32_t) ceil(sqrt((float) numPixels));
+    scene.x = new float[numPixels];
+    scene.y = new float[numPixels];
+    scene.out = new float[numPixels];
+    scene.tmp = new float[numPixels];
+    ref = new float[numPixels];
+    for (uint32_t p = 0; p < numPixels; p++) {
+      scene.x[p] = (p % side) * pixelSpacing;
+      scene.y[p] = (p / side) * pixelSpacing;
+    }
+    Serial.printf("%u pixels\n  threads  us/frame  speedup  output\n", numPixels);
+    us1 = 0;
+    for (uint32_t threads = 1; threads <= maxThreads; threads++) {
+      pool.init(threads);
+      us = runFrames(&scene, numPixels, numFrames);
+      if (threads == 1) {
+        us1 = us;
+        memcpy(ref, scene.out, numPixels * sizeof(float));
+      }
+      same = (memcmp(ref, scene.out, numPixels * sizeof(float)) == 0);
+      Serial.printf("  %7u %9.0f %8.2f  %s\n", threads, us, us1 / us, same ? "identical" : "DIFFERENT");
+      if (!same)
+        return (1);
+    }
+    delete[] scene.x;
+    delete[] scene.y;
+    delete[] scene.out;
+    delete[] scene.tmp;
+    delete[] ref;
+  }
+  pool.end();
+  return (0);
+}
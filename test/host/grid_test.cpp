@@ -0,0 +1,122 @@
+/* GRID_TEST.CPP (host harness)
+    Checks pixelGridClass (see PixelGrid.cpp) against a brute-force search: every pixel is found by a query at its own position, and
+    disc, annulus and rectangle queries return exactly the pixels a linear scan finds. The maps include regular grids whose pitch
+    equals the cell size (e.g. 14 x 14 pixels at 3.3 mm), where the pixels on the far edge lie exactly on a cell boundary. Build with
+    -fsanitize=address added to the command in README.md to also catch writes outside the grid arrays. The exit status is 0 if every
+    check passed.
+*/
+#include <Arduino.h>
+#include "PixelGrid.h"
+
+const uint16_t maxPixels = 2000;
+
+float x[maxPixels], y[maxPixels];
+bool found[maxPixels];
+pixelGridClass grid;
+uint16_t numFails = 0;
+
+
+void check(bool ok, const char *what) {
+  Serial.printf("%s: %s\n", ok ? "pass" : "FAIL", what);
+  if (!ok)
+    numFails++;
+}
+
+
+  // Returns true if the last query found exactly the pixels for which inside() is true, each once
+bool matches(uint16_t numPixels, bool (*inside)(float px, float py, const float *q), const float *q) {
+  const uint16_t *res = grid.results();
+
+  memset(found, 0, sizeof(found));
+  for (uint16_t i = 0; i < grid.resultCount(); i++) {
+    if (found[res[i]])
+      return (false);
+    found[res[i]] = true;
+  }
+  for (uint16_t p = 0; p < numPixels; p++) {
+    if (found[p] != inside(x[p], y[p], q))
+      return (false);
+  }
+  return (true);
+}
+
+
+bool inAnnulus(float px, float py, const float *q) {    // q: cx, cy, rIn, rOut
+  float distSq = ((px - q[0]) * (px - q[0])) + ((py - q[1]) * (py - q[1]));
+  return ((distSq >= ((q[2] < 0) ? -1 : (q[2] * q[2]))) && (distSq <= (q[3] * q[3])));
+}
+
+
+bool inRect(float px, float py, const float *q) {       // q: x0, y0, x1, y1
+  return ((px >= q[0]) && (px <= q[2]) && (py >= q[1]) && (py <= q[3]));
+}
+
+
+  // Builds the grid for the current map, and checks point, disc, annulus and rectangle queries against a linear scan
+bool checkMap(uint16_t numPixels, float cell) {
+  float q[4];
+
+  if (!grid.init(x, y, numPixels, cell))
+    return (false);
+  for (uint16_t p = 0; p < numPixels; p++) {
+    q[0] = q[2] = x[p];
+    q[1] = q[3] = y[p];
+    grid.queryRect(x[p], y[p], x[p], y[p]);
+    if (!matches(numPixels, inRect, q))
+      return (false);
+  }
+  randomSeed(numPixels);
+  for (uint16_t n = 0; n < 200; n++) {
+    q[0] = x[random(numPixels)] + (random(-100, 100) / 10.0);
+    q[1] = y[random(numPixels)] + (random(-100, 100) / 10.0);
+    q[2] = random(-1, 20);
+    q[3] = q[2] + random(1, 30);
+    grid.queryAnnulus(q[0], q[1], q[2], q[3]);
+    if (!matches(numPixels, inAnnulus, q))
+      return (false);
+    q[2] = q[0] + random(0, 30);
+    q[3] = q[1] + random(0, 30);
+    grid.queryRect(q[0], q[1], q[2], q[3]);
+    if (!matches(numPixels, inRect, q))
+      return (false);
+  }
+  return (true);
+}
+
+
+  // Regular side x side grid with the specified pitch
+uint16_t regularMap(uint16_t side, float pitch) {
+  for (uint16_t p = 0; p < (side * side); p++) {
+    x[p] = (p % side) * pitch;
+    y[p] = (p / side) * pitch;
+  }
+  return (side * side);
+}
+
+
+int main() {
+  uint16_t numPixels;
+  char what[80];
+  const float pitch[] = {3.3, 0.1, 1.7, 10.0, 7.77};
+  const uint16_t sides[] = {14, 31, 44};
+
+  for (float pt : pitch) {
+    for (uint16_t side : sides) {
+      numPixels = regularMap(side, pt);
+      snprintf(what, sizeof(what), "%u x %u at %.2f mm, cell = pitch", side, side, pt);
+      check(checkMap(numPixels, pt), what);
+    }
+  }
+  numPixels = regularMap(14, 3.3);
+  check(checkMap(numPixels, 0), "14 x 14 at 3.3 mm, default cell");
+  randomSeed(7);
+  for (uint16_t p = 0; p < maxPixels; p++) {
+    x[p] = random(0, 100000) / 100.0;
+    y[p] = random(0, 50000) / 100.0;
+  }
+  check(checkMap(maxPixels, 0), "random map, default cell");
+  check(checkMap(maxPixels, 0.05), "random map, cell enlarged to the cell limit");
+
+  Serial.printf("%s\n", (numFails == 0) ? "PASS" : "FAIL");
+  return ((numFails == 0) ? 0 : 1);
+}
@@ -0,0 +1,186 @@
+/* SCRIPT_TEST.CPP (host harness)
+    Checks the coroutine awaiters of scriptRunnerClass (see Script.cpp) against a schedulerClass: the step on which a script resumes
+    after untilDone() and allDone(), the retry path when the scheduler's step set is full, and the false result of untilDone(), allDone()
+    and waitFor() (with nothing left in the step set) when no cue can be scheduled either, and that cues and scripts started from a completion function run on the
+    next step. Requires C++20 coroutines; build with -fcoroutines if the compiler needs it.
+    The exit status is 0 if every check passed.
+*/
+#include <Arduino.h>
+#include "Scheduler.h"
+#include "Script.h"
+
+#ifndef EFFECT_SCRIPTS
+#error "script_test requires C++20 coroutine support (e.g. -std=gnu++20 -fcoroutines)"
+#endif
+
+class countClass : public effect {    // effect that completes after a fixed number of steps
+public:
+  void start(uint16_t steps) { effectSteps = steps; stepNum = 0; active = true; }
+  void step() { if (active && (++stepNum >= effectSteps)) active = false; }
+};
+
+schedulerClass sched;
+scriptRunnerClass run;
+countClass fxA, fxB, fxC;
+countClass filler[schedMaxRunning];
+uint32_t resumeStep[4];   // step count at which each await returned
+bool result[4];           // value returned by each await
+uint16_t numFails = 0;
+
+
+void check(bool ok, const char *what) {
+  Serial.printf("%s: %s\n", ok ? "pass" : "FAIL", what);
+  if (!ok)
+    numFails++;
+}
+
+
+  // Fills the step set with effects that complete after the specified number of steps, leaving numFree entries free
+void fillStepSet(uint8_t numFree, uint16_t steps) {
+  for (uint8_t f = 0; f < schedMaxRunning - numFree; f++) {
+    filler[f].start(steps);
+    sched.run(&filler[f], NULL, NULL);
+  }
+}
+
+
+void noCue(void *) {}
+
+
+  // Uses every free cue (for steps far in the future), so that no awaiter retry can be scheduled
+void fillCues() {
+  while (sched.at(sched.stepCount() + 1000, noCue, NULL))
+    ;
+}
+
+
+void recordCue(void *arg) {
+  *(uint32_t *) arg = sched.stepCount();
+}
+
+
+  // Completion function that schedules cues for the current step, as show logic started from a completion would
+void cueNow(void *) {
+  sched.at(sched.stepCount(), recordCue, &resumeStep[0]);
+  sched.after(0, recordCue, &resumeStep[1]);
+}
+
+
+scriptClass startedScript(scriptRunnerClass &) {
+  resumeStep[2] = sched.stepCount();
+  co_return;
+}
+
+
+void startScript(void *) {
+  result[2] = run.start(startedScript(run));
+}
+
+
+void runSteps(uint16_t steps) {
+  for (uint16_t s = 0; s < steps; s++)
+    sched.step();
+}
+
+
+scriptClass orderScript(scriptRunnerClass &run) {
+  fxA.start(5);
+  fxB.start(12);
+  result[0] = co_await run.untilDone(fxA);
+  resumeStep[0] = sched.stepCount();
+  fxA.start(3);
+  result[1] = co_await run.allDone(fxA, fxB, fxC);  // fxC is inactive, so isn't waited for
+  resumeStep[1] = sched.stepCount();
+}
+
+
+scriptClass fullScript(scriptRunnerClass &run) {
+  fillStepSet(0, 20);
+  fxA.start(3);
+  result[0] = co_await run.untilDone(fxA);
+  resumeStep[0] = sched.stepCount();
+  fillStepSet(1, 20);
+  fxA.start(3);
+  fxB.start(5);
+  result[1] = co_await run.allDone(fxA, fxB);
+  resumeStep[1] = sched.stepCount();
+}
+
+
+scriptClass failScript(scriptRunnerClass &run) {
+  fillStepSet(0, 20);
+  fillCues();
+  fxA.start(3);
+  result[0] = co_await run.untilDone(fxA);
+  resumeStep[0] = sched.stepCount();
+  sched.init();
+  fillStepSet(1, 20);
+  fillCues();
+  fxA.start(3);
+  fxB.start(5);
+  result[1] = co_await run.allDone(fxA, fxB);
+  resumeStep[1] = sched.stepCount();
+}
+
+
+scriptClass failWaitScript(scriptRunnerClass &run) {
+  fillCues();
+  result[2] = co_await run.waitFor(0.5);
+  resumeStep[2] = sched.stepCount();
+}
+
+
+void reset() {
+  sched.init();
+  run.init(&sched);
+  for (uint8_t r = 0; r < 4; r++) {
+    resumeStep[r] = 0xFFFFFFFF;
+    result[r] = false;
+  }
+  fxA.active = false;
+  fxB.active = false;
+  fxC.active = false;
+}
+
+
+int main() {
+    // completion ordering: each await resumes on the step where its (last) effect completes
+  reset();
+  check(run.start(orderScript(run)), "order: script started");
+  runSteps(20);
+  check(result[0] && (resumeStep[0] == 4), "order: untilDone() resumes on the completing step");
+  check(result[1] && (resumeStep[1] == 15), "order: allDone() resumes when the last active effect completes");
+
+    // full step set: untilDone() adds fxA once the fillers complete at step 19 (fxA completes at 22); allDone() adds fxA, then fxB on
+    // the step after fxA frees its entry (fxB completes at 29, not when fxA completes at 24)
+  reset();
+  check(run.start(fullScript(run)), "full: script started");
+  runSteps(60);
+  check(result[0] && (resumeStep[0] == 22) && (fxA.stepNum == 3), "full: untilDone() waits for a free entry");
+  check(result[1] && (resumeStep[1] == 29) && (fxB.stepNum == 5), "full: allDone() doesn't resume on partial completion");
+
+    // no free cues either: the awaits return false at once, and leave nothing in the step set
+  reset();
+  check(run.start(failScript(run)), "fail: script started");
+  runSteps(1);
+  check(!result[0] && (resumeStep[0] == 0) && (fxA.stepNum == 0), "fail: untilDone() returns false");
+  check(!result[1] && (resumeStep[1] == 0), "fail: allDone() returns false");
+  check(!sched.remove(&fxA) && !sched.remove(&fxB), "fail: allDone() leaves nothing in the step set");
+  reset();
+  check(run.start(failWaitScript(run)), "fail: waitFor() script started");
+  runSteps(1);
+  check(!result[2] && (resumeStep[2] == 0), "fail: waitFor() returns false");
+
+    // cues for the current step scheduled from a completion function (after the step's cues have fired) fire on the next step
+  reset();
+  fxA.start(5);
+  sched.run(&fxA, cueNow, NULL);
+  fxB.start(8);
+  sched.run(&fxB, startScript, NULL);
+  runSteps(20);
+  check((resumeStep[0] == 5) && (resumeStep[1] == 5), "completion: at(stepCount()) and after(0) fire on the next step");
+  check(result[2] && (resumeStep[2] == 8), "completion: a script started from a completion runs on the next step");
+
+  Serial.printf("%s\n", (numFails == 0) ? "PASS" : "FAIL");
+  return ((numFails == 0) ? 0 : 1);
+}
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""CUE_COMPILE.PY
+    Host tool that compiles a text show description into the binary cue image played by cuePlayerClass (see src/Cue.cpp).
+
+    The description has one statement per line; '#' starts a comment:
+      period <ms>                       Step period used to convert times to step numbers (default 10)
+      slot <n> <class>                  Declares effect slot n (0 - 31) to hold an effect of the given class
+      <when> <op> <slot> [params...]    Cue: starts the effect in a slot with literal start() parameters
+
+    <when> is a step number (e.g. 150) or a time in seconds (e.g. 1.5s). Cues may appear in any order; cues for the same step are
+    executed in the order written. The ops (and classes) and their start() parameters are:
+      ramp      duration [rampUpDur [rampDownDur]]
+      flow      duration distance rampLen
+      wave      duration frequency ampl   |   duration wavelen speed ampl
+      wavelet   duration dist speed accel len delay
+      droplet   dist
+      pop       duration x y distance rampLen
+      wipe      duration x y angle distance rampLen
+      flicker   duration frequency filter minVal
+      wait      duration
+      stop      (no parameters; stops the effect in the slot, of any class)
+
+    The output format is selected by the file extension:
+      .bin  Raw image, e.g. for cuePlayerClass::load() on a host build or for reading from an SD card
+      .h    C header defining the image as a const PROGMEM uint32_t array (placed in flash on the device)
+
+    Usage: cue_compile.py <input.txt> <output.bin | output.h> [--name <array name>]
+"""
+import argparse
+import struct
+import sys
+
+from image_output import write_image
+
+CUE_MAGIC = 0x31455543    # "CUE1"
+CUE_VERSION = 1
+CUE_MAX_SLOTS = 32
+CUE_MAX_PARAMS = 6
+HEADER_FORMAT = "<IHHIIIIfI"    # must match cueHeaderStruct
+CUE_FORMAT = "<IBBBB6f"         # must match cueStruct
+
+  # op name: (cueOpEnum value, allowed parameter counts)
+OPS = {
+    "ramp": (0, (1, 2, 3)),
+    "flow": (1, (3,)),
+    "wave": (2, (3, 4)),
+    "wavelet": (3, (6,)),
+    "droplet": (4, (1,)),
+    "pop": (5, (5,)),
+    "wipe": (6, (6,)),
+    "flicker": (7, (4,)),
+    "wait": (8, (1,)),
+    "stop": (9, (0,)),
+}
+CUE_STOP = OPS["stop"][0]
+
+
+def fail(path, lineNum, msg):
+    sys.exit("%s:%d: %s" % (path, lineNum, msg))
+
+
+def parse(path):
+    periodMs = 10.0
+    slots = {}
+    cues = []   # (step, order, op, slot, params)
+    with open(path) as f:
+        for lineNum, line in enumerate(f, 1):
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            if words[0] == "period":
+                if len(words) != 2:
+                    fail(path, lineNum, "expected: period <ms>")
+                periodMs = float(words[1][:-2] if words[1].endswith("ms") else words[1])
+                if periodMs <= 0:
+                    fail(path, lineNum, "period must be > 0")
+                continue
+            if words[0] == "slot":
+                if (len(words) != 3) or (words[2] not in OPS) or (words[2] == "stop"):
+                    fail(path, lineNum, "expected: slot <n> <class>")
+                n = int(words[1])
+                if not (0 <= n < CUE_MAX_SLOTS):
+                    fail(path, lineNum, "slot must be 0 - %d" % (CUE_MAX_SLOTS - 1))
+                slots[n] = OPS[words[2]][0]
+                continue
+            if len(words) < 3:
+                fail(path, lineNum, "expected: <when> <op> <slot> [params...]")
+            when, opName, slot = words[0], words[1], int(words[2])
+            if opName not in OPS:
+                fail(path, lineNum, "unknown op '%s'" % opName)
+            op, counts = OPS[opName]
+            params = [float(w) for w in words[3:]]
+            if len(params) not in counts:
+                fail(path, lineNum, "%s takes %s parameters" % (opName, " or ".join(str(c) for c in counts)))
+            if slot not in slots:
+                fail(path, lineNum, "slot %d not declared" % slot)
+            if (op != CUE_STOP) and (slots[slot] != op):
+                fail(path, lineNum, "slot %d doesn't hold a %s effect" % (slot, opName))
+            if when.endswith("s"):
+                step = int(round((float(when[:-1]) * 1000) / periodMs))
+            else:
+                step = int(when)
+            if step < 0:
+                fail(path, lineNum, "negative step")
+            cues.append((step, len(cues), op, slot, params))
+    cues.sort()
+    return periodMs, slots, cues
+
+
+def build_image(periodMs, slots, cues):
+    numSlots = (max(slots) + 1) if slots else 0
+    headerSize = struct.calcsize(HEADER_FORMAT)
+    slotOffset = headerSize
+    cueOffset = (slotOffset + numSlots + 3) & ~3
+    imageSize = cueOffset + (len(cues) * struct.calcsize(CUE_FORMAT))
+    image = struct.pack(HEADER_FORMAT, CUE_MAGIC, CUE_VERSION, numSlots, len(cues), slotOffset, cueOffset, imageSize,
+                        periodMs / 1000, 0)
+    image += bytes(slots.get(s, 0xFF) for s in range(numSlots))   # undeclared slots can't match any class
+    image += bytes(cueOffset - len(image))
+    for step, order, op, slot, params in cues:
+        image += struct.pack(CUE_FORMAT, step, op, slot, len(params), 0, *(params + [0.0] * (CUE_MAX_PARAMS - len(params))))
+    return image
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile a text show description to a binary cue image")
+    parser.add_argument("input", help="show description")
+    parser.add_argument("output", help="output file (.bin or .h)")
+    parser.add_argument("--name", help="array name for .h output (default: output file name)")
+    args = parser.parse_args()
+
+    periodMs, slots, cues = parse(args.input)
+    image = build_image(periodMs, slots, cues)
+    write_image(args.output, image, args.name, "Generated by cue_compile.py: %d cues. Pass to cuePlayerClass::attach()." % len(cues))
+    print("%s: %d slots, %d cues, %d bytes" % (args.output, len(slots), len(cues), len(image)))
+
+
+if __name__ == "__main__":
+    main()
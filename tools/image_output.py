@@ -0,0 +1,33 @@
+"""IMAGE_OUTPUT.PY
+    Output functions shared by the host tools that generate binary images used in place by the library (pixmap_convert.py and
+    cue_compile.py). An image is written either raw (.bin), or as a C header defining it as a const PROGMEM uint32_t array, so that
+    it is placed in flash on the device and 4-byte aligned as attach() requires.
+"""
+import os
+import struct
+
+
+def array_name(path):
+    """Default C array name for a .h output file: the file name without its extension, made a valid identifier"""
+    return os.path.splitext(os.path.basename(path))[0].replace("-", "_").replace(".", "_")
+
+
+def write_progmem_header(path, name, image, comment):
+    """Writes image (a multiple of 4 bytes) as 'const uint32_t <name>[] PROGMEM', preceded by a one-line comment"""
+    words = struct.unpack("<%dI" % (len(image) // 4), image)
+    with open(path, "w") as f:
+        f.write("// %s\n" % comment)
+        f.write("#include <Arduino.h>\n\n")
+        f.write("const uint32_t %s[%d] PROGMEM = {\n" % (name, len(words)))
+        for i in range(0, len(words), 8):
+            f.write("  " + ", ".join("0x%08X" % w for w in words[i:i + 8]) + ",\n")
+        f.write("};\n")
+
+
+def write_image(path, image, name, comment):
+    """Writes image to path: a PROGMEM header if path ends with .h (array name defaults to array_name(path)), otherwise raw bytes"""
+    if path.endswith(".h"):
+        write_progmem_header(path, name or array_name(path), image, comment)
+    else:
+        with open(path, "wb") as f:
+            f.write(image)
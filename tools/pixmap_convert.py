@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""PIXMAP_CONVERT.PY
+    Host tool that converts a CSV pixel map into the binary pixel map image used by pixelMapClass::attach() and
+    pixelMapClass::load() (see src/PixelMap.cpp).
+
+    The CSV file has one line per pixel, in the order in which the pixels are driven, with 2 (x, y) or 3 (x, y, z) coordinates in mm.
+    Blank lines, lines starting with '#' and a non-numeric header line are ignored. All lines must have the same number of
+    coordinates.
+
+    The output format is selected by the file extension:
+      .bin  Raw image, e.g. for load() on a host build or for reading from an SD card
+      .h    C header defining the image as a const PROGMEM uint32_t array (placed in flash on the device), e.g.
+              #include "install_map.h"
+              pixMap.attach(install_map, sizeof(install_map));
+
+    Usage: pixmap_convert.py <input.csv> <output.bin | output.h> [--name <array name>]
+"""
+import argparse
+import csv
+import struct
+import sys
+
+from image_output import write_image
+
+PIXMAP_MAGIC = 0x314D5850   # "PXM1"
+PIXMAP_VERSION = 1
+HEADER_FORMAT = "<IHHIIIIII"    # must match pixmapHeaderStruct
+MAX_PIXELS = 65535
+
+
+def read_csv(path):
+    coords = []
+    dims = None
+    with open(path, newline="") as f:
+        for lineNum, row in enumerate(csv.reader(f), 1):
+            fields = [c.strip() for c in row if c.strip() != ""]
+            if not fields or fields[0].startswith("#"):
+                continue
+            try:
+                values = [float(c) for c in fields]
+            except ValueError:
+                if not coords:  # header line
+                    continue
+                sys.exit("%s:%d: non-numeric coordinate" % (path, lineNum))
+            if len(values) not in (2, 3):
+                sys.exit("%s:%d: expected 2 or 3 coordinates" % (path, lineNum))
+            if dims is None:
+                dims = len(values)
+            elif len(values) != dims:
+                sys.exit("%s:%d: expected %d coordinates" % (path, lineNum, dims))
+            coords.append(values)
+    if not coords:
+        sys.exit("%s: no pixels" % path)
+    if len(coords) > MAX_PIXELS:
+        sys.exit("%s: too many pixels (max %d)" % (path, MAX_PIXELS))
+    return coords, dims
+
+
+def build_image(coords, dims):
+    numPixels = len(coords)
+    headerSize = struct.calcsize(HEADER_FORMAT)
+    arraySize = numPixels * 4
+    xOffset = headerSize
+    yOffset = xOffset + arraySize
+    zOffset = (yOffset + arraySize) if dims == 3 else 0
+    imageSize = headerSize + (arraySize * dims)
+    image = struct.pack(HEADER_FORMAT, PIXMAP_MAGIC, PIXMAP_VERSION, dims, numPixels, xOffset, yOffset, zOffset, imageSize, 0)
+    for axis in range(dims):
+        image += struct.pack("<%df" % numPixels, *[c[axis] for c in coords])
+    return image
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a CSV pixel map to a binary pixel map image")
+    parser.add_argument("input", help="CSV file with x,y[,z] per pixel (mm)")
+    parser.add_argument("output", help="output file (.bin or .h)")
+    parser.add_argument("--name", help="array name for .h output (default: output file name)")
+    args = parser.parse_args()
+
+    coords, dims = read_csv(args.input)
+    image = build_image(coords, dims)
+    write_image(args.output, image, args.name,
+                "Generated by pixmap_convert.py: %d pixels, %dD. Pass to pixelMapClass::attach()." % (len(coords), dims))
+    print("%s: %d pixels, %dD, %d bytes" % (args.output, len(coords), dims, len(image)))
+
+
+if __name__ == "__main__":
+    main()